@@ -0,0 +1,129 @@
+# Copyright © 2025 Cory Petkovsek, Roope Palmroos, and Contributors.
+# Benchmark Terrain3D Collision
+#
+# This script compares a full collision rebuild with the incremental update of edited areas, and
+# reports the memory used by the collision shapes. To use it:
+#
+# 1. Select your Terrain3D node with some regions loaded, eg 16x16 regions for a large world.
+# 1. In the editor, set collision_mode to Full / Editor or Dynamic / Editor, or run the scene.
+# 1. In the inspector, click Script (very bottom) and Quick Load benchmark_collision.gd.
+# 1. Set the edit count and size, then click run_benchmark. Results are printed to the output window.
+# 1. Clear the script from your Terrain3D node before saving your scene.
+#
+# To compare two builds of the extension, eg before and after a change, enable save_as_baseline on
+# the first build, then run again on the second build with it disabled. See benchmark_data.gd.
+#
+# The full rebuild toggles collision_enabled off and on. Each incremental edit marks a random square
+# area within the active regions as edited, with a fixed seed so runs are comparable, then applies
+# it with update_collision() rather than waiting for the next physics frame. No map data is changed.
+
+@tool
+extends Terrain3D
+
+@export var edits: int = 100
+@export var edit_size: float = 16.0
+@export var repeats: int = 3
+@export var save_as_baseline: bool = false
+@export var baseline_file: String = "user://terrain3d_benchmark_collision.cfg"
+@export var run_benchmark: bool = false : set = benchmark
+
+
+func benchmark(value: bool) -> void:
+	if not data or data.get_region_count() == 0:
+		push_error("No regions loaded")
+		return
+	if Engine.is_editor_hint() and collision_mode not in [ CollisionMode.FULL_EDITOR, CollisionMode.DYNAMIC_EDITOR ]:
+		push_error("Collision is only built in the editor in the Editor collision modes")
+		return
+	if not has_method("update_collision"):
+		push_error("This build has no update_collision(), so edits can't be timed")
+		return
+
+	var locations: Array[Vector2i] = data.get_region_locations()
+	var region_width: float = region_size * vertex_spacing
+	var scene: Dictionary = {
+		"regions": locations.size(),
+		"region_size": region_size,
+		"vertex_spacing": vertex_spacing,
+		"collision_mode": collision_mode,
+		"collision_shape_size": collision_shape_size,
+		"edits": edits,
+		"edit_size": edit_size,
+	}
+	print("Terrain3D collision benchmark, Terrain3D %s, %d regions of %d, vertex spacing %.2f, mode %s, shape size %d" % [
+		get_version(), locations.size(), region_size, vertex_spacing,
+		CollisionMode.keys()[collision_mode], collision_shape_size ])
+
+	var was_enabled: bool = collision_enabled
+	var results: Dictionary = {}
+
+	# Full rebuild, and the memory held while collision is enabled
+	collision_enabled = false
+	var memory: int = int(Performance.get_monitor(Performance.MEMORY_STATIC))
+	results["full_rebuild"] = _time(func():
+		collision_enabled = false
+		collision_enabled = true)
+	results["memory"] = int(Performance.get_monitor(Performance.MEMORY_STATIC)) - memory
+
+	# Incremental edits
+	var areas: Array[AABB] = []
+	var rng := RandomNumberGenerator.new()
+	rng.seed = 12345
+	for i in edits:
+		var loc: Vector2i = locations[rng.randi() % locations.size()]
+		var center := Vector3(loc.x + rng.randf(), 0., loc.y + rng.randf()) * region_width
+		areas.append(AABB(center - Vector3(edit_size, 0., edit_size) * .5, Vector3(edit_size, 0., edit_size)))
+	update_collision()
+	results["edits"] = _time(func():
+		for area in areas:
+			data.add_edited_area(area)
+			update_collision())
+
+	collision_enabled = was_enabled
+
+	if save_as_baseline:
+		_print_results(results)
+		var baseline := ConfigFile.new()
+		baseline.set_value("baseline", "version", get_version())
+		baseline.set_value("baseline", "scene", scene)
+		baseline.set_value("baseline", "results", results)
+		baseline.save(baseline_file)
+		print("Saved as baseline to: ", baseline_file)
+		return
+
+	var cfg := ConfigFile.new()
+	if cfg.load(baseline_file) != OK:
+		_print_results(results)
+		print("No baseline found at: %s. Run with save_as_baseline on another build to compare." % baseline_file)
+		return
+	var baseline_scene: Dictionary = cfg.get_value("baseline", "scene", {})
+	if baseline_scene != scene:
+		push_warning("Scene parameters differ from the baseline run: %s vs %s" % [ baseline_scene, scene ])
+	_print_results(results, cfg.get_value("baseline", "results", {}), cfg.get_value("baseline", "version", "?"))
+
+
+# Returns the fastest of the repeated runs in microseconds
+func _time(p_callable: Callable) -> int:
+	var best: int = 9223372036854775807
+	for i in maxi(repeats, 1):
+		var time: int = Time.get_ticks_usec()
+		p_callable.call()
+		best = mini(best, Time.get_ticks_usec() - time)
+	return best
+
+
+func _print_results(p_results: Dictionary, p_baseline: Dictionary = {}, p_baseline_version: String = "") -> void:
+	var rows: Array = [
+		[ "Full rebuild (ms)", p_results["full_rebuild"] / 1000., p_baseline.get("full_rebuild", -1) / 1000. ],
+		[ "Edit update (ms/edit)", p_results["edits"] / 1000. / maxi(edits, 1), p_baseline.get("edits", -1) / 1000. / maxi(edits, 1) ],
+		[ "Collision memory (MiB)", p_results["memory"] / 1048576., p_baseline.get("memory", -1) / 1048576. ],
+	]
+	if p_baseline.is_empty():
+		for row in rows:
+			print("  %-26s %10.3f" % [ row[0], row[1] ])
+	else:
+		print("  %-26s %14s %14s" % [ "", "baseline " + p_baseline_version, "current" ])
+		for row in rows:
+			print("  %-26s %14.3f %14.3f" % [ row[0], row[2], row[1] ])
+	var per_edit: float = p_results["edits"] / float(maxi(edits, 1))
+	print("  A full rebuild costs as much as %.1f edits of %.1f m" % [ p_results["full_rebuild"] / maxf(per_edit, 0.001), edit_size ])
@@ -0,0 +1,129 @@
+# Copyright © 2025 Cory Petkovsek, Roope Palmroos, and Contributors.
+# Benchmark Terrain3DData Lookups
+#
+# This script measures the per call cost of the Terrain3DData pixel and height lookups. To use it:
+#
+# 1. Select your Terrain3D node with some regions loaded.
+# 1. In the inspector, click Script (very bottom) and Quick Load benchmark_data.gd.
+# 1. Set the sample count, then click run_benchmark. Results are printed to the output window.
+# 1. Clear the script from your Terrain3D node before saving your scene.
+#
+# To compare two builds of the extension, eg before and after a change:
+#
+# 1. On the first build, enable save_as_baseline and click run_benchmark. The results are saved to
+#    baseline_file along with the scene parameters.
+# 1. Switch to the second build, disable save_as_baseline and click run_benchmark again on the same
+#    scene. Each lookup is printed with the baseline time, the new time and the speedup. A warning is
+#    printed if the scene parameters differ from the baseline run.
+#
+# Positions are randomly chosen within the active regions with a fixed seed, so runs are comparable.
+# Each lookup is timed several times and the fastest run is kept, to reduce noise.
+
+@tool
+extends Terrain3D
+
+@export var samples: int = 200000
+@export var repeats: int = 3
+@export var save_as_baseline: bool = false
+@export var baseline_file: String = "user://terrain3d_benchmark_data.cfg"
+@export var run_benchmark: bool = false : set = benchmark
+
+
+func benchmark(value: bool) -> void:
+	if not data or data.get_region_count() == 0:
+		push_error("No regions loaded")
+		return
+
+	var positions := PackedVector3Array()
+	positions.resize(samples)
+	var locations: Array[Vector2i] = data.get_region_locations()
+	var region_width: float = region_size * vertex_spacing
+	var rng := RandomNumberGenerator.new()
+	rng.seed = 12345
+	for i in samples:
+		var loc: Vector2i = locations[rng.randi() % locations.size()]
+		positions[i] = Vector3(loc.x + rng.randf(), 0., loc.y + rng.randf()) * region_width
+
+	var scene: Dictionary = {
+		"samples": samples,
+		"regions": locations.size(),
+		"region_size": region_size,
+		"vertex_spacing": vertex_spacing,
+	}
+	print("Terrain3DData lookup benchmark, Terrain3D %s, %d samples over %d regions of %d, vertex spacing %.2f" % [
+		get_version(), samples, locations.size(), region_size, vertex_spacing ])
+
+	var results: Dictionary = {}
+	results["get_pixel(TYPE_HEIGHT)"] = _time(func():
+		for p in positions:
+			data.get_pixel(Terrain3DRegion.TYPE_HEIGHT, p))
+	results["get_pixel(TYPE_COLOR)"] = _time(func():
+		for p in positions:
+			data.get_pixel(Terrain3DRegion.TYPE_COLOR, p))
+	results["get_control"] = _time(func():
+		for p in positions:
+			data.get_control(p))
+	results["get_height"] = _time(func():
+		for p in positions:
+			data.get_height(p))
+	results["get_normal"] = _time(func():
+		for p in positions:
+			data.get_normal(p))
+	results["get_texture_id"] = _time(func():
+		for p in positions:
+			data.get_texture_id(p))
+	# Batch queries may not exist on older builds
+	for method in [ "get_heights", "get_normals", "get_heights_and_normals", "get_surface_samples" ]:
+		if data.has_method(method):
+			results[method + " (batch)"] = _time(func():
+				data.call(method, positions))
+	results["GDScript loop overhead"] = _time(func():
+		for p in positions:
+			pass)
+
+	if save_as_baseline:
+		_print_results(results)
+		var baseline := ConfigFile.new()
+		baseline.set_value("baseline", "version", get_version())
+		baseline.set_value("baseline", "scene", scene)
+		baseline.set_value("baseline", "results", results)
+		baseline.save(baseline_file)
+		print("Saved as baseline to: ", baseline_file)
+		return
+
+	var cfg := ConfigFile.new()
+	if cfg.load(baseline_file) != OK:
+		_print_results(results)
+		print("No baseline found at: %s. Run with save_as_baseline on another build to compare." % baseline_file)
+		return
+	var baseline_scene: Dictionary = cfg.get_value("baseline", "scene", {})
+	if baseline_scene != scene:
+		push_warning("Scene parameters differ from the baseline run: %s vs %s" % [ baseline_scene, scene ])
+	_print_comparison(cfg.get_value("baseline", "version", "?"), cfg.get_value("baseline", "results", {}), results)
+
+
+# Returns the fastest of the repeated runs in microseconds
+func _time(p_callable: Callable) -> int:
+	var best: int = 9223372036854775807
+	for i in maxi(repeats, 1):
+		var time: int = Time.get_ticks_usec()
+		p_callable.call()
+		best = mini(best, Time.get_ticks_usec() - time)
+	return best
+
+
+func _print_results(p_results: Dictionary) -> void:
+	for key in p_results:
+		var elapsed: int = p_results[key]
+		print("  %-34s %8.2f ms  %8.1f ns/lookup" % [ key, elapsed / 1000., elapsed * 1000. / samples ])
+
+
+func _print_comparison(p_baseline_version: String, p_baseline: Dictionary, p_results: Dictionary) -> void:
+	print("  %-34s %14s %14s %8s" % [ "ns/lookup", "baseline " + p_baseline_version, "current", "speedup" ])
+	for key in p_results:
+		var current: float = p_results[key] * 1000. / samples
+		if not p_baseline.has(key):
+			print("  %-34s %14s %14.1f" % [ key, "-", current ])
+			continue
+		var before: float = p_baseline[key] * 1000. / samples
+		print("  %-34s %14.1f %14.1f %7.2fx" % [ key, before, current, before / maxf(current, 0.001) ])
@@ -0,0 +1,72 @@
+# Copyright © 2025 Cory Petkovsek, Roope Palmroos, and Contributors.
+# Benchmark Terrain3D Instancer Modes
+#
+# This script compares the two instancer_modes on your own scene: MultiMeshInstance3D nodes, and
+# multimeshes drawn directly through the RenderingServer. To use it:
+#
+# 1. Select your Terrain3D node with some regions loaded and instances painted or placed.
+# 1. In the inspector, click Script (very bottom) and Quick Load benchmark_instancer.gd.
+# 1. Click run_benchmark. Results are printed to the output window.
+# 1. Clear the script from your Terrain3D node before saving your scene.
+#
+# Each mode rebuilds all instancer meshes with force_update_mmis(), as on load, and the fastest of
+# several runs is kept. The node count, object count and static memory are then read with all meshes
+# built. As everything else in the scene is the same for both modes, the differences between the
+# two columns are the cost of each mode. Instancer streaming is disabled while measuring, so every
+# cell is built, then restored along with the original mode.
+
+@tool
+extends Terrain3D
+
+@export var repeats: int = 3
+@export var run_benchmark: bool = false : set = benchmark
+
+
+func benchmark(value: bool) -> void:
+	if not data or data.get_region_count() == 0:
+		push_error("No regions loaded")
+		return
+	if not assets or assets.get_mesh_count() == 0:
+		push_error("No mesh assets")
+		return
+
+	print("Terrain3D instancer benchmark, Terrain3D %s, %d regions of %d, %d mesh assets" % [
+		get_version(), data.get_region_count(), region_size, assets.get_mesh_count() ])
+
+	var was_mode: InstancerMode = instancer_mode
+	var was_streaming: bool = instancer_streaming
+	instancer_streaming = false
+
+	var results: Dictionary = {}
+	for mode in [ InstancerMode.INSTANCER_NODES, InstancerMode.INSTANCER_SERVER ]:
+		instancer_mode = mode
+		results[mode] = _measure()
+
+	instancer_mode = was_mode
+	instancer_streaming = was_streaming
+
+	var nodes: Dictionary = results[InstancerMode.INSTANCER_NODES]
+	var server: Dictionary = results[InstancerMode.INSTANCER_SERVER]
+	print("  %-24s %14s %14s %14s" % [ "", "Nodes", "Server", "Difference" ])
+	print("  %-24s %14.2f %14.2f %14.2f" % [ "Build (ms)", nodes.time / 1000., server.time / 1000.,
+		(server.time - nodes.time) / 1000. ])
+	print("  %-24s %14d %14d %14d" % [ "Nodes in scene", nodes.nodes, server.nodes, server.nodes - nodes.nodes ])
+	print("  %-24s %14d %14d %14d" % [ "Objects", nodes.objects, server.objects, server.objects - nodes.objects ])
+	print("  %-24s %14.2f %14.2f %14.2f" % [ "Static memory (MiB)", nodes.memory / 1048576., server.memory / 1048576.,
+		(server.memory - nodes.memory) / 1048576. ])
+
+
+# Rebuilds all instancer meshes in the current mode and returns the fastest build time in
+# microseconds, and the node count, object count and static memory after it
+func _measure() -> Dictionary:
+	var best: int = 9223372036854775807
+	for i in maxi(repeats, 1):
+		var time: int = Time.get_ticks_usec()
+		instancer.force_update_mmis()
+		best = mini(best, Time.get_ticks_usec() - time)
+	return {
+		"time": best,
+		"nodes": int(Performance.get_monitor(Performance.OBJECT_NODE_COUNT)),
+		"objects": int(Performance.get_monitor(Performance.OBJECT_COUNT)),
+		"memory": int(Performance.get_monitor(Performance.MEMORY_STATIC)),
+	}
@@ -1,28 +1,95 @@
 // Copyright © 2025 Cory Petkovsek, Roope Palmroos, and Contributors.
 
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/rd_texture_format.hpp>
+#include <godot_cpp/classes/rd_texture_view.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
 
 #include "generated_texture.h"
 #include "logger.h"
 
+///////////////////////////
+// Private Functions
+///////////////////////////
+
+// Formats of the texture arrays that can be updated in sub-rectangles
+RenderingDevice::DataFormat GeneratedTexture::_get_rd_format(const Image::Format p_format) {
+	switch (p_format) {
+		case Image::FORMAT_RF:
+			return RenderingDevice::DATA_FORMAT_R32_SFLOAT;
+		case Image::FORMAT_RH:
+			return RenderingDevice::DATA_FORMAT_R16_SFLOAT;
+		case Image::FORMAT_RGBA8:
+			return RenderingDevice::DATA_FORMAT_R8G8B8A8_UNORM;
+		default:
+			return RenderingDevice::DATA_FORMAT_MAX;
+	}
+}
+
+// Returns the RenderingDevice if it can be used from this thread. It's unavailable in Compatibility,
+// and with a separate render thread, RenderingServer textures are used instead.
+RenderingDevice *GeneratedTexture::_get_rendering_device() {
+	if (int(ProjectSettings::get_singleton()->get_setting_with_override("rendering/driver/threads/thread_model")) == 2) {
+		return nullptr;
+	}
+	return RS->get_rendering_device();
+}
+
+void GeneratedTexture::_free_rids(const RID &p_rid, const RID &p_rd_rid) {
+	if (p_rid.is_valid()) {
+		LOG(EXTREME, "GeneratedTexture freeing ", p_rid);
+		RS->free_rid(p_rid);
+	}
+	if (p_rd_rid.is_valid()) {
+		RenderingDevice *rd = RS->get_rendering_device();
+		if (rd) {
+			LOG(EXTREME, "GeneratedTexture freeing RenderingDevice texture ", p_rd_rid);
+			rd->free_rid(p_rd_rid);
+		}
+	}
+}
+
 ///////////////////////////
 // Public Functions
 ///////////////////////////
 
 void GeneratedTexture::clear() {
-	if (_rid.is_valid()) {
-		LOG(EXTREME, "GeneratedTexture freeing ", _rid);
-		RS->free_rid(_rid);
-	}
+	_free_rids(_rid, _rd_rid);
 	if (_image.is_valid()) {
 		LOG(EXTREME, "GeneratedTexture unref image", _image);
 		_image.unref();
 	}
 	_rid = RID();
+	_rd_rid = RID();
 	_dirty = true;
 }
 
-RID GeneratedTexture::create(const TypedArray<Image> &p_layers) {
+// Copies a rectangle of a mipmap level of p_image into a tightly packed buffer
+PackedByteArray GeneratedTexture::_get_rect_data(const Ref<Image> &p_image, const int p_mipmap, const Rect2i &p_rect) {
+	const PackedByteArray src = p_image->get_data();
+	const int base_size = p_image->has_mipmaps() ? int(p_image->get_mipmap_offset(1)) : int(src.size());
+	const int pixel_size = base_size / (p_image->get_width() * p_image->get_height());
+	const int width = MAX(p_image->get_width() >> p_mipmap, 1);
+	const uint8_t *src_ptr = src.ptr() + p_image->get_mipmap_offset(p_mipmap);
+	const int row_size = p_rect.size.x * pixel_size;
+	PackedByteArray data;
+	data.resize(row_size * p_rect.size.y);
+	uint8_t *dst_ptr = data.ptrw();
+	for (int y = 0; y < p_rect.size.y; y++) {
+		memcpy(dst_ptr + y * row_size, src_ptr + ((p_rect.position.y + y) * width + p_rect.position.x) * pixel_size, row_size);
+	}
+	return data;
+}
+
+// Replaces the texture array with one of p_layers. The previous array stays valid until the new one
+// exists, so it can stay bound to the shader while rebuilding. If p_updatable, the array is created on
+// the RenderingDevice so edits can upload sub-rectangles with update(). This is only needed while
+// editing, so exported games that don't edit keep the RenderingServer textures.
+RID GeneratedTexture::create(const TypedArray<Image> &p_layers, const bool p_updatable) {
+	RID old_rid = _rid;
+	RID old_rd_rid = _rd_rid;
+	_rid = RID();
+	_rd_rid = RID();
 	if (!p_layers.is_empty()) {
 		if (Terrain3D::debug_level >= DEBUG) {
 			LOG(EXTREME, "RenderingServer creating Texture2DArray, layers size: ", p_layers.size());
@@ -31,15 +98,96 @@ RID GeneratedTexture::create(const TypedArray<Image> &p_layers) {
 				LOG(EXTREME, i, ": ", img, ", empty: ", img->is_empty(), ", size: ", img->get_size(), ", format: ", img->get_format());
 			}
 		}
+
+		// Create the array on the RenderingDevice so layers can be updated in sub-rectangles. Layers
+		// are validated to the same size and format by the regions.
+		Ref<Image> first = p_layers[0];
+		RenderingDevice *rd = p_updatable ? _get_rendering_device() : nullptr;
+		RenderingDevice::DataFormat format = _get_rd_format(first->get_format());
+		if (rd && format != RenderingDevice::DATA_FORMAT_MAX) {
+			Ref<RDTextureFormat> tf;
+			tf.instantiate();
+			Ref<RDTextureView> view;
+			view.instantiate();
+			tf->set_format(format);
+			// Color maps are sampled through an sRGB view, so allow both, as RenderingServer does
+			if (format == RenderingDevice::DATA_FORMAT_R8G8B8A8_UNORM) {
+				tf->add_shareable_format(RenderingDevice::DATA_FORMAT_R8G8B8A8_UNORM);
+				tf->add_shareable_format(RenderingDevice::DATA_FORMAT_R8G8B8A8_SRGB);
+			}
+			tf->set_texture_type(RenderingDevice::TEXTURE_TYPE_2D_ARRAY);
+			tf->set_width(first->get_width());
+			tf->set_height(first->get_height());
+			tf->set_mipmaps(first->get_mipmap_count() + 1);
+			tf->set_array_layers(p_layers.size());
+			tf->set_usage_bits(RenderingDevice::TEXTURE_USAGE_SAMPLING_BIT |
+					RenderingDevice::TEXTURE_USAGE_CAN_UPDATE_BIT |
+					RenderingDevice::TEXTURE_USAGE_CAN_COPY_FROM_BIT |
+					RenderingDevice::TEXTURE_USAGE_CAN_COPY_TO_BIT);
+			TypedArray<PackedByteArray> data;
+			for (int i = 0; i < p_layers.size(); i++) {
+				Ref<Image> img = p_layers[i];
+				data.push_back(img->get_data());
+			}
+			_rd_rid = rd->texture_create(tf, view, data);
+			if (_rd_rid.is_valid()) {
+				LOG(EXTREME, "RenderingDevice created Texture2DArray: ", _rd_rid);
+				_rid = RS->texture_rd_create(_rd_rid, RenderingServer::TEXTURE_LAYERED_2D_ARRAY);
+				_dirty = false;
+				_free_rids(old_rid, old_rd_rid);
+				return _rid;
+			}
+			LOG(WARN, "RenderingDevice couldn't create texture array. Using RenderingServer");
+		}
+
 		_rid = RS->texture_2d_layered_create(p_layers, RenderingServer::TEXTURE_LAYERED_2D_ARRAY);
 		_dirty = false;
 	} else {
 		clear();
 	}
+	_free_rids(old_rid, old_rd_rid);
 	return _rid;
 }
 
-void GeneratedTexture::update(const Ref<Image> &p_image, const int p_layer) {
+// Updates a layer of the texture array from p_image. If p_rect has an area and the array is on the
+// RenderingDevice, only that rectangle of each mipmap level is uploaded, through a staging texture the
+// size of the rect.
+void GeneratedTexture::update(const Ref<Image> &p_image, const int p_layer, const Rect2i &p_rect) {
+	if (_rd_rid.is_valid()) {
+		RenderingDevice *rd = RS->get_rendering_device();
+		if (!rd) {
+			return;
+		}
+		Rect2i rect = p_rect.intersection(Rect2i(V2I_ZERO, p_image->get_size()));
+		if (!rect.has_area() || rect.size == p_image->get_size()) {
+			LOG(EXTREME, "RenderingDevice updating Texture2DArray at index: ", p_layer);
+			rd->texture_update(_rd_rid, p_layer, p_image->get_data());
+			return;
+		}
+		LOG(EXTREME, "RenderingDevice updating Texture2DArray at index: ", p_layer, ", rect: ", rect);
+		for (int mipmap = 0; mipmap <= p_image->get_mipmap_count(); mipmap++) {
+			// Pixels of this level that include any of the rect
+			Vector2i start = rect.position / (1 << mipmap);
+			Vector2i end = (rect.get_end() + Vector2i(1, 1) * ((1 << mipmap) - 1)) / (1 << mipmap);
+			Vector2i mip_size = Vector2i(MAX(p_image->get_width() >> mipmap, 1), MAX(p_image->get_height() >> mipmap, 1));
+			Rect2i mip_rect = Rect2i(start, end - start).intersection(Rect2i(V2I_ZERO, mip_size));
+			Ref<RDTextureFormat> tf;
+			tf.instantiate();
+			Ref<RDTextureView> view;
+			view.instantiate();
+			tf->set_format(_get_rd_format(p_image->get_format()));
+			tf->set_width(mip_rect.size.x);
+			tf->set_height(mip_rect.size.y);
+			tf->set_usage_bits(RenderingDevice::TEXTURE_USAGE_CAN_UPDATE_BIT | RenderingDevice::TEXTURE_USAGE_CAN_COPY_FROM_BIT);
+			TypedArray<PackedByteArray> data;
+			data.push_back(_get_rect_data(p_image, mipmap, mip_rect));
+			RID staging = rd->texture_create(tf, view, data);
+			rd->texture_copy(staging, _rd_rid, V3_ZERO, Vector3(mip_rect.position.x, mip_rect.position.y, 0.f),
+					Vector3(mip_rect.size.x, mip_rect.size.y, 1.f), 0, mipmap, 0, p_layer);
+			rd->free_rid(staging);
+		}
+		return;
+	}
 	LOG(EXTREME, "RenderingServer updating Texture2DArray at index: ", p_layer);
 	RS->texture_2d_update(_rid, p_image, p_layer);
 }
@@ -4,6 +4,7 @@
 #define GENERATEDTEXTURE_CLASS_H
 
 #include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/rendering_device.hpp>
 
 #include "constants.h"
 
@@ -14,17 +15,24 @@ class GeneratedTexture {
 
 private:
 	RID _rid = RID();
+	RID _rd_rid = RID(); // Texture array owned on the RenderingDevice, if created updatable
 	Ref<Image> _image;
 	bool _dirty = false;
 
+	static RenderingDevice::DataFormat _get_rd_format(const Image::Format p_format);
+	static RenderingDevice *_get_rendering_device();
+	static PackedByteArray _get_rect_data(const Ref<Image> &p_image, const int p_mipmap, const Rect2i &p_rect);
+	static void _free_rids(const RID &p_rid, const RID &p_rd_rid);
+
 public:
 	void clear();
+	void set_dirty() { _dirty = true; }
 	bool is_dirty() const { return _dirty; }
-	RID create(const TypedArray<Image> &p_layers);
-	void update(const Ref<Image> &p_image, const int p_layer);
+	RID create(const TypedArray<Image> &p_layers, const bool p_updatable = false);
+	void update(const Ref<Image> &p_image, const int p_layer, const Rect2i &p_rect = Rect2i());
 	RID create(const Ref<Image> &p_image);
 	Ref<Image> get_image() const { return _image; }
 	RID get_rid() const { return _rid; }
 };
 
-#endif // GENERATEDTEXTURE_CLASS_H
\ No newline at end of file
+#endif // GENERATEDTEXTURE_CLASS_H
@@ -1,6 +1,8 @@
 // Copyright © 2025 Cory Petkovsek, Roope Palmroos, and Contributors.
 
 #include <godot_cpp/classes/rendering_server.hpp>
+#include <unordered_map>
+#include <vector>
 
 #include "geoclipmap.h"
 #include "logger.h"
@@ -10,92 +12,140 @@
 ///////////////////////////
 
 // Half each triangle, have to check for longest side.
+// Works on flat, pre-sized buffers. Coincident input vertices are welded first, then each split edge
+// gets one midpoint, found through an open addressing table keyed by the edge's sorted vertex ids.
+// Midpoints are also welded by position, so one landing on an existing vertex, or on the midpoint of
+// another edge, reuses it. Output vertices are numbered on first use, in the order each triangle
+// references them, so unreferenced vertices are dropped.
 void GeoClipMap::_subdivide_half(PackedVector3Array &vertices, PackedInt32Array &indices) {
-	PackedVector3Array new_vertices;
-	PackedInt32Array new_indices;
+	int tri_count = indices.size() / 3;
+	if (tri_count == 0) {
+		return;
+	}
 
+	// Each triangle adds at most one midpoint
+	const int max_vertices = vertices.size() + tri_count;
+	std::vector<Vector3> verts(max_vertices);
+	const Vector3 *src_verts = vertices.ptr();
+	const int32_t *src_ids = indices.ptr();
+	int vert_count = 0;
+
+	// Weld duplicate positions, eg where the trim arms meet
 	std::unordered_map<Vector3, int, Vector3Hash> vertex_map;
+	vertex_map.reserve(max_vertices);
+	std::vector<int32_t> remap_ids(vertices.size());
+	for (int i = 0; i < vertices.size(); i++) {
+		auto it = vertex_map.emplace(src_verts[i], vert_count);
+		if (it.second) {
+			verts[vert_count++] = src_verts[i];
+		}
+		remap_ids[i] = it.first->second;
+	}
 
-	auto midpoint = [](const Vector3 &p1, const Vector3 &p2) -> Vector3 {
-		return (p1 + p2) / 2.0f;
+	// Edge table, sized to a power of two with at least half of the slots free
+	uint32_t table_size = 1;
+	while (table_size < uint32_t(tri_count) * 2) {
+		table_size <<= 1;
+	}
+	const uint32_t mask = table_size - 1;
+	std::vector<int64_t> edge_keys(table_size, -1);
+	std::vector<int32_t> edge_ids(table_size);
+
+	auto find_or_add_midpoint = [&](const int32_t p_a, const int32_t p_b) -> int32_t {
+		int64_t key = (int64_t(MIN(p_a, p_b)) << 32) | int64_t(MAX(p_a, p_b));
+		uint32_t slot = uint32_t((uint64_t(key) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+		while (edge_keys[slot] != -1) {
+			if (edge_keys[slot] == key) {
+				return edge_ids[slot];
+			}
+			slot = (slot + 1) & mask;
+		}
+		Vector3 midpoint = (verts[p_a] + verts[p_b]) / 2.0f;
+		auto it = vertex_map.emplace(midpoint, vert_count);
+		if (it.second) {
+			verts[vert_count++] = midpoint;
+		}
+		edge_keys[slot] = key;
+		edge_ids[slot] = it.first->second;
+		return it.first->second;
 	};
 
-	auto find_or_add_vertex = [&vertex_map, &new_vertices](const Vector3 &vertex) -> int {
-		auto it = vertex_map.find(vertex);
-		if (it != vertex_map.end()) {
-			return it->second;
-		} else {
-			int index = new_vertices.size();
-			vertex_map[vertex] = index;
-			new_vertices.push_back(vertex);
-			return index;
+	// Output ids of the welded vertices, -1 until first used
+	PackedVector3Array new_vertices;
+	new_vertices.resize(max_vertices);
+	PackedInt32Array new_indices;
+	new_indices.resize(tri_count * 6);
+	Vector3 *out_verts = new_vertices.ptrw();
+	int32_t *ids = new_indices.ptrw();
+	std::vector<int32_t> out_ids(max_vertices, -1);
+	int out_count = 0;
+	auto use_vertex = [&](const int32_t p_id) -> int32_t {
+		if (out_ids[p_id] < 0) {
+			out_ids[p_id] = out_count;
+			out_verts[out_count++] = verts[p_id];
 		}
+		return out_ids[p_id];
 	};
 
-	for (int i = 0; i < indices.size(); i += 3) {
-		int id_0 = indices[i];
-		int id_1 = indices[i + 1];
-		int id_2 = indices[i + 2];
+	int n = 0;
+	for (int i = 0; i < tri_count * 3; i += 3) {
+		int32_t a = remap_ids[src_ids[i]];
+		int32_t b = remap_ids[src_ids[i + 1]];
+		int32_t c = remap_ids[src_ids[i + 2]];
 
-		Vector3 A = vertices[id_0];
-		Vector3 B = vertices[id_1];
-		Vector3 C = vertices[id_2];
+		const Vector3 A = verts[a];
+		const Vector3 B = verts[b];
+		const Vector3 C = verts[c];
 
 		float length_AB = (B - A).length_squared();
 		float length_BC = (C - B).length_squared();
 		float length_CA = (A - C).length_squared();
 
+		int32_t A_id = use_vertex(a);
+		int32_t B_id = use_vertex(b);
+		int32_t C_id = use_vertex(c);
+
 		// Determine the longest edge and its midpoint, chaos otherwise.
-		int A_id, B_id, C_id, mid_id;
+		int32_t mid_id;
 		if (length_AB >= length_BC && length_AB >= length_CA) {
-			A_id = find_or_add_vertex(A);
-			B_id = find_or_add_vertex(B);
-			C_id = find_or_add_vertex(C);
-			mid_id = find_or_add_vertex(midpoint(A, B));
+			mid_id = use_vertex(find_or_add_midpoint(a, b));
 
-			new_indices.push_back(A_id);
-			new_indices.push_back(mid_id);
-			new_indices.push_back(C_id);
+			ids[n++] = A_id;
+			ids[n++] = mid_id;
+			ids[n++] = C_id;
 
-			new_indices.push_back(mid_id);
-			new_indices.push_back(B_id);
-			new_indices.push_back(C_id);
+			ids[n++] = mid_id;
+			ids[n++] = B_id;
+			ids[n++] = C_id;
 
 		} else if (length_BC >= length_AB && length_BC >= length_CA) {
-			A_id = find_or_add_vertex(A);
-			B_id = find_or_add_vertex(B);
-			C_id = find_or_add_vertex(C);
-			mid_id = find_or_add_vertex(midpoint(B, C));
+			mid_id = use_vertex(find_or_add_midpoint(b, c));
 
-			new_indices.push_back(B_id);
-			new_indices.push_back(mid_id);
-			new_indices.push_back(A_id);
+			ids[n++] = B_id;
+			ids[n++] = mid_id;
+			ids[n++] = A_id;
 
-			new_indices.push_back(mid_id);
-			new_indices.push_back(C_id);
-			new_indices.push_back(A_id);
+			ids[n++] = mid_id;
+			ids[n++] = C_id;
+			ids[n++] = A_id;
 
 		} else {
-			// length_BC >= length_AB && length_BC >= length_CA
-			A_id = find_or_add_vertex(A);
-			B_id = find_or_add_vertex(B);
-			C_id = find_or_add_vertex(C);
-			mid_id = find_or_add_vertex(midpoint(C, A));
-
-			new_indices.push_back(C_id);
-			new_indices.push_back(mid_id);
-			new_indices.push_back(B_id);
-
-			new_indices.push_back(mid_id);
-			new_indices.push_back(A_id);
-			new_indices.push_back(B_id);
+			// length_CA > length_AB && length_CA > length_BC
+			mid_id = use_vertex(find_or_add_midpoint(c, a));
+
+			ids[n++] = C_id;
+			ids[n++] = mid_id;
+			ids[n++] = B_id;
+
+			ids[n++] = mid_id;
+			ids[n++] = A_id;
+			ids[n++] = B_id;
 		}
 	}
 
-	vertices.clear();
-	vertices.append_array(new_vertices);
-	indices.clear();
-	indices.append_array(new_indices);
+	new_vertices.resize(out_count);
+	vertices = new_vertices;
+	indices = new_indices;
 }
 
 RID GeoClipMap::_create_mesh(const PackedVector3Array &p_vertices, const PackedInt32Array &p_indices, const AABB &p_aabb) {
@@ -164,12 +214,14 @@ Vector<RID> GeoClipMap::generate(const int p_size, const int p_levels) {
 		vertices.resize(PATCH_VERT_RESOLUTION * PATCH_VERT_RESOLUTION);
 		PackedInt32Array indices;
 		indices.resize(TILE_RESOLUTION * TILE_RESOLUTION * 6);
+		Vector3 *verts = vertices.ptrw();
+		int32_t *ids = indices.ptrw();
 
 		n = 0;
 
 		for (int y = 0; y < PATCH_VERT_RESOLUTION; y++) {
 			for (int x = 0; x < PATCH_VERT_RESOLUTION; x++) {
-				vertices[n++] = Vector3(x, 0.f, y);
+				verts[n++] = Vector3(x, 0.f, y);
 			}
 		}
 
@@ -177,13 +229,13 @@ Vector<RID> GeoClipMap::generate(const int p_size, const int p_levels) {
 
 		for (int y = 0; y < TILE_RESOLUTION; y++) {
 			for (int x = 0; x < TILE_RESOLUTION; x++) {
-				indices[n++] = _patch_2d(x, y, PATCH_VERT_RESOLUTION);
-				indices[n++] = _patch_2d(x + 1, y + 1, PATCH_VERT_RESOLUTION);
-				indices[n++] = _patch_2d(x, y + 1, PATCH_VERT_RESOLUTION);
+				ids[n++] = _patch_2d(x, y, PATCH_VERT_RESOLUTION);
+				ids[n++] = _patch_2d(x + 1, y + 1, PATCH_VERT_RESOLUTION);
+				ids[n++] = _patch_2d(x, y + 1, PATCH_VERT_RESOLUTION);
 
-				indices[n++] = _patch_2d(x, y, PATCH_VERT_RESOLUTION);
-				indices[n++] = _patch_2d(x + 1, y, PATCH_VERT_RESOLUTION);
-				indices[n++] = _patch_2d(x + 1, y + 1, PATCH_VERT_RESOLUTION);
+				ids[n++] = _patch_2d(x, y, PATCH_VERT_RESOLUTION);
+				ids[n++] = _patch_2d(x + 1, y, PATCH_VERT_RESOLUTION);
+				ids[n++] = _patch_2d(x + 1, y + 1, PATCH_VERT_RESOLUTION);
 			}
 		}
 
@@ -201,47 +253,49 @@ Vector<RID> GeoClipMap::generate(const int p_size, const int p_levels) {
 		vertices.resize(PATCH_VERT_RESOLUTION * 8);
 		PackedInt32Array indices;
 		indices.resize(TILE_RESOLUTION * 24);
+		Vector3 *verts = vertices.ptrw();
+		int32_t *ids = indices.ptrw();
 
 		n = 0;
 		int offset = TILE_RESOLUTION;
 
 		for (int i = 0; i < PATCH_VERT_RESOLUTION; i++) {
-			vertices[n] = Vector3(offset + i + 1.f, 0.f, 0.f);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(offset + i + 1.f, 0.f, 0.f);
+			aabb.expand_to(verts[n]);
 			n++;
 
-			vertices[n] = Vector3(offset + i + 1.f, 0.f, 1.f);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(offset + i + 1.f, 0.f, 1.f);
+			aabb.expand_to(verts[n]);
 			n++;
 		}
 
 		for (int i = 0; i < PATCH_VERT_RESOLUTION; i++) {
-			vertices[n] = Vector3(1.f, 0.f, offset + i + 1.f);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(1.f, 0.f, offset + i + 1.f);
+			aabb.expand_to(verts[n]);
 			n++;
 
-			vertices[n] = Vector3(0.f, 0.f, offset + i + 1.f);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(0.f, 0.f, offset + i + 1.f);
+			aabb.expand_to(verts[n]);
 			n++;
 		}
 
 		for (int i = 0; i < PATCH_VERT_RESOLUTION; i++) {
-			vertices[n] = Vector3(-real_t(offset + i), 0.f, 1.f);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(-real_t(offset + i), 0.f, 1.f);
+			aabb.expand_to(verts[n]);
 			n++;
 
-			vertices[n] = Vector3(-real_t(offset + i), 0.f, 0.f);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(-real_t(offset + i), 0.f, 0.f);
+			aabb.expand_to(verts[n]);
 			n++;
 		}
 
 		for (int i = 0; i < PATCH_VERT_RESOLUTION; i++) {
-			vertices[n] = Vector3(0.f, 0.f, -real_t(offset + i));
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(0.f, 0.f, -real_t(offset + i));
+			aabb.expand_to(verts[n]);
 			n++;
 
-			vertices[n] = Vector3(1.f, 0.f, -real_t(offset + i));
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(1.f, 0.f, -real_t(offset + i));
+			aabb.expand_to(verts[n]);
 			n++;
 		}
 
@@ -255,19 +309,19 @@ Vector<RID> GeoClipMap::generate(const int p_size, const int p_levels) {
 			int tr = (arm + i) * 2 + 3;
 
 			if (arm % 2 == 0) {
-				indices[n++] = br;
-				indices[n++] = bl;
-				indices[n++] = tr;
-				indices[n++] = bl;
-				indices[n++] = tl;
-				indices[n++] = tr;
+				ids[n++] = br;
+				ids[n++] = bl;
+				ids[n++] = tr;
+				ids[n++] = bl;
+				ids[n++] = tl;
+				ids[n++] = tr;
 			} else {
-				indices[n++] = br;
-				indices[n++] = bl;
-				indices[n++] = tl;
-				indices[n++] = br;
-				indices[n++] = tl;
-				indices[n++] = tr;
+				ids[n++] = br;
+				ids[n++] = bl;
+				ids[n++] = tl;
+				ids[n++] = br;
+				ids[n++] = tl;
+				ids[n++] = tr;
 			}
 		}
 		filler_inner_mesh = _create_mesh(vertices, indices, aabb);
@@ -283,52 +337,54 @@ Vector<RID> GeoClipMap::generate(const int p_size, const int p_levels) {
 		vertices.resize((CLIPMAP_VERT_RESOLUTION * 2 + 1) * 2);
 		PackedInt32Array indices;
 		indices.resize((CLIPMAP_VERT_RESOLUTION * 2 - 1) * 6);
+		Vector3 *verts = vertices.ptrw();
+		int32_t *ids = indices.ptrw();
 
 		n = 0;
 		Vector3 offset = Vector3(0.5f * real_t(CLIPMAP_VERT_RESOLUTION + 1), 0.f, 0.5f * real_t(CLIPMAP_VERT_RESOLUTION + 1));
 
 		for (int i = 0; i < CLIPMAP_VERT_RESOLUTION + 1; i++) {
-			vertices[n] = Vector3(0.f, 0.f, CLIPMAP_VERT_RESOLUTION - i) - offset;
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(0.f, 0.f, CLIPMAP_VERT_RESOLUTION - i) - offset;
+			aabb.expand_to(verts[n]);
 			n++;
 
-			vertices[n] = Vector3(1.f, 0.f, CLIPMAP_VERT_RESOLUTION - i) - offset;
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(1.f, 0.f, CLIPMAP_VERT_RESOLUTION - i) - offset;
+			aabb.expand_to(verts[n]);
 			n++;
 		}
 
 		int start_of_horizontal = n;
 
 		for (int i = 0; i < CLIPMAP_VERT_RESOLUTION; i++) {
-			vertices[n] = Vector3(i + 1.f, 0.f, 0.f) - offset;
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(i + 1.f, 0.f, 0.f) - offset;
+			aabb.expand_to(verts[n]);
 			n++;
 
-			vertices[n] = Vector3(i + 1.f, 0.f, 1.f) - offset;
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(i + 1.f, 0.f, 1.f) - offset;
+			aabb.expand_to(verts[n]);
 			n++;
 		}
 
 		n = 0;
 
 		for (int i = 0; i < CLIPMAP_VERT_RESOLUTION; i++) {
-			indices[n++] = (i + 0) * 2 + 1;
-			indices[n++] = (i + 0) * 2 + 0;
-			indices[n++] = (i + 1) * 2 + 0;
+			ids[n++] = (i + 0) * 2 + 1;
+			ids[n++] = (i + 0) * 2 + 0;
+			ids[n++] = (i + 1) * 2 + 0;
 
-			indices[n++] = (i + 1) * 2 + 1;
-			indices[n++] = (i + 0) * 2 + 1;
-			indices[n++] = (i + 1) * 2 + 0;
+			ids[n++] = (i + 1) * 2 + 1;
+			ids[n++] = (i + 0) * 2 + 1;
+			ids[n++] = (i + 1) * 2 + 0;
 		}
 
 		for (int i = 0; i < CLIPMAP_VERT_RESOLUTION - 1; i++) {
-			indices[n++] = start_of_horizontal + (i + 0) * 2 + 1;
-			indices[n++] = start_of_horizontal + (i + 0) * 2 + 0;
-			indices[n++] = start_of_horizontal + (i + 1) * 2 + 0;
+			ids[n++] = start_of_horizontal + (i + 0) * 2 + 1;
+			ids[n++] = start_of_horizontal + (i + 0) * 2 + 0;
+			ids[n++] = start_of_horizontal + (i + 1) * 2 + 0;
 
-			indices[n++] = start_of_horizontal + (i + 1) * 2 + 1;
-			indices[n++] = start_of_horizontal + (i + 0) * 2 + 1;
-			indices[n++] = start_of_horizontal + (i + 1) * 2 + 0;
+			ids[n++] = start_of_horizontal + (i + 1) * 2 + 1;
+			ids[n++] = start_of_horizontal + (i + 0) * 2 + 1;
+			ids[n++] = start_of_horizontal + (i + 1) * 2 + 0;
 		}
 		trim_inner_mesh = _create_mesh(vertices, indices, aabb);
 		_subdivide_half(vertices, indices);
@@ -343,28 +399,30 @@ Vector<RID> GeoClipMap::generate(const int p_size, const int p_levels) {
 		vertices.resize(PATCH_VERT_RESOLUTION * 8);
 		PackedInt32Array indices;
 		indices.resize(TILE_RESOLUTION * 24 + 6);
+		Vector3 *verts = vertices.ptrw();
+		int32_t *ids = indices.ptrw();
 
 		n = 0;
 
 		for (int i = 0; i < PATCH_VERT_RESOLUTION * 2; i++) {
-			vertices[n] = Vector3(real_t(i - TILE_RESOLUTION), 0.f, 0.f);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(real_t(i - TILE_RESOLUTION), 0.f, 0.f);
+			aabb.expand_to(verts[n]);
 			n++;
 
-			vertices[n] = Vector3(real_t(i - TILE_RESOLUTION), 0.f, 1.f);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(real_t(i - TILE_RESOLUTION), 0.f, 1.f);
+			aabb.expand_to(verts[n]);
 			n++;
 		}
 
 		int start_of_vertical = n;
 
 		for (int i = 0; i < PATCH_VERT_RESOLUTION * 2; i++) {
-			vertices[n] = Vector3(0.f, 0.f, real_t(i - TILE_RESOLUTION));
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(0.f, 0.f, real_t(i - TILE_RESOLUTION));
+			aabb.expand_to(verts[n]);
 			n++;
 
-			vertices[n] = Vector3(1.f, 0.f, real_t(i - TILE_RESOLUTION));
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(1.f, 0.f, real_t(i - TILE_RESOLUTION));
+			aabb.expand_to(verts[n]);
 			n++;
 		}
 
@@ -376,12 +434,12 @@ Vector<RID> GeoClipMap::generate(const int p_size, const int p_levels) {
 			int tl = i * 2 + 2;
 			int tr = i * 2 + 3;
 
-			indices[n++] = br;
-			indices[n++] = bl;
-			indices[n++] = tr;
-			indices[n++] = bl;
-			indices[n++] = tl;
-			indices[n++] = tr;
+			ids[n++] = br;
+			ids[n++] = bl;
+			ids[n++] = tr;
+			ids[n++] = bl;
+			ids[n++] = tl;
+			ids[n++] = tr;
 		}
 
 		for (int i = 0; i < TILE_RESOLUTION * 2 + 1; i++) {
@@ -394,12 +452,12 @@ Vector<RID> GeoClipMap::generate(const int p_size, const int p_levels) {
 			int tl = i * 2 + 2;
 			int tr = i * 2 + 3;
 
-			indices[n++] = start_of_vertical + br;
-			indices[n++] = start_of_vertical + tr;
-			indices[n++] = start_of_vertical + bl;
-			indices[n++] = start_of_vertical + bl;
-			indices[n++] = start_of_vertical + tr;
-			indices[n++] = start_of_vertical + tl;
+			ids[n++] = start_of_vertical + br;
+			ids[n++] = start_of_vertical + tr;
+			ids[n++] = start_of_vertical + bl;
+			ids[n++] = start_of_vertical + bl;
+			ids[n++] = start_of_vertical + tr;
+			ids[n++] = start_of_vertical + tl;
 		}
 
 		cross_mesh = _create_mesh(vertices, indices, aabb);
@@ -413,36 +471,38 @@ Vector<RID> GeoClipMap::generate(const int p_size, const int p_levels) {
 		vertices.resize(CLIPMAP_VERT_RESOLUTION * 4);
 		PackedInt32Array indices;
 		indices.resize(CLIPMAP_VERT_RESOLUTION * 6);
+		Vector3 *verts = vertices.ptrw();
+		int32_t *ids = indices.ptrw();
 
 		n = 0;
 
 		for (int i = 0; i < CLIPMAP_VERT_RESOLUTION; i++) {
 			n = CLIPMAP_VERT_RESOLUTION * 0 + i;
-			vertices[n] = Vector3(i, 0.f, 0.f);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(i, 0.f, 0.f);
+			aabb.expand_to(verts[n]);
 
 			n = CLIPMAP_VERT_RESOLUTION * 1 + i;
-			vertices[n] = Vector3(CLIPMAP_VERT_RESOLUTION, 0.f, i);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(CLIPMAP_VERT_RESOLUTION, 0.f, i);
+			aabb.expand_to(verts[n]);
 
 			n = CLIPMAP_VERT_RESOLUTION * 2 + i;
-			vertices[n] = Vector3(CLIPMAP_VERT_RESOLUTION - i, 0.f, CLIPMAP_VERT_RESOLUTION);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(CLIPMAP_VERT_RESOLUTION - i, 0.f, CLIPMAP_VERT_RESOLUTION);
+			aabb.expand_to(verts[n]);
 
 			n = CLIPMAP_VERT_RESOLUTION * 3 + i;
-			vertices[n] = Vector3(0.f, 0.f, CLIPMAP_VERT_RESOLUTION - i);
-			aabb.expand_to(vertices[n]);
+			verts[n] = Vector3(0.f, 0.f, CLIPMAP_VERT_RESOLUTION - i);
+			aabb.expand_to(verts[n]);
 		}
 
 		n = 0;
 
 		for (int i = 0; i < CLIPMAP_VERT_RESOLUTION * 4; i += 2) {
-			indices[n++] = i + 1;
-			indices[n++] = i;
-			indices[n++] = i + 2;
+			ids[n++] = i + 1;
+			ids[n++] = i;
+			ids[n++] = i + 2;
 		}
 
-		indices[indices.size() - 1] = 0;
+		ids[indices.size() - 1] = 0;
 
 		seam_mesh = _create_mesh(vertices, indices, aabb);
 	}
@@ -34,6 +34,7 @@ uniform float _region_texel_size = 0.0009765625; // = 1/1024
 uniform int _region_map_size = 32;
 uniform int _region_map[1024];
 uniform vec2 _region_locations[1024];
+uniform int _summary_layer = -2; // Low resolution layer of non-resident regions when streaming
 uniform float _texture_uv_scale_array[32];
 uniform float _texture_detile_array[32];
 uniform vec4 _texture_color_array[32];
@@ -99,7 +100,13 @@ ivec3 get_region_uv(const vec2 uv) {
 	ivec2 pos = ivec2(floor(uv * _region_texel_size)) + (_region_map_size / 2);
 	int bounds = int(uint(pos.x | pos.y) < uint(_region_map_size));
 	int layer_index = _region_map[ pos.y * _region_map_size + pos.x ] * bounds - 1;
-	return ivec3(ivec2(mod(uv,_region_size)), layer_index);
+	ivec2 texel = ivec2(mod(uv,_region_size));
+	// The summary has a tile per region at its place in the region map
+	if (layer_index == _summary_layer) {
+		int tile_size = int(_region_size) / _region_map_size;
+		texel = pos * tile_size + texel / (int(_region_size) / tile_size);
+	}
+	return ivec3(texel, layer_index);
 }
 
 // Takes in UV2 region space coordinates, returns vec3 with:
@@ -110,6 +117,9 @@ vec3 get_region_uv2(const vec2 uv2) {
 	ivec2 pos = ivec2(floor(uv2 - vec2(_region_texel_size * 0.5))) + (_region_map_size / 2);
 	int bounds = int(uint(pos.x | pos.y) < uint(_region_map_size));
 	int layer_index = _region_map[ pos.y * _region_map_size + pos.x ] * bounds - 1;
+	if (layer_index == _summary_layer) {
+		return vec3((uv2 + float(_region_map_size / 2)) / float(_region_map_size), float(layer_index));
+	}
 	return vec3(uv2 - _region_locations[layer_index], float(layer_index));
 }
 
@@ -447,6 +457,9 @@ void fragment() {
 	vec4 color_map = vec4(1., 1., 1., .5);
 	if (region_uv.z >= 0.) {
 		float lod = textureQueryLod(_color_maps, uv2.xy).y;
+		if (int(region_uv.z) == _summary_layer) {
+			lod = max(lod - log2(float(_region_map_size)), 0.);
+		}
 		color_map = textureLod(_color_maps, region_uv, lod);
 	}
 	
@@ -1,10 +1,8 @@
 // Copyright © 2025 Cory Petkovsek, Roope Palmroos, and Contributors.
 
-#include <godot_cpp/classes/collision_shape3d.hpp>
 #include <godot_cpp/classes/editor_interface.hpp>
 #include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/environment.hpp>
-#include <godot_cpp/classes/height_map_shape3d.hpp>
 #include <godot_cpp/classes/label3d.hpp>
 #include <godot_cpp/classes/os.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
@@ -15,6 +13,7 @@
 #include <godot_cpp/classes/time.hpp>
 #include <godot_cpp/classes/viewport.hpp>
 #include <godot_cpp/classes/viewport_texture.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
 #include <godot_cpp/classes/world3d.hpp>
 
 #include "geoclipmap.h"
@@ -61,15 +60,25 @@ void Terrain3D::_initialize() {
 		LOG(DEBUG, "Connecting _data::region_map_changed signal to _build_collision()");
 		_data->connect("region_map_changed", callable_mp(this, &Terrain3D::_build_collision));
 	}
+	// Maps were edited, update collision of the affected regions
+	if (!_data->is_connected("maps_edited", callable_mp(this, &Terrain3D::_queue_collision_update))) {
+		LOG(DEBUG, "Connecting _data::maps_edited signal to _queue_collision_update()");
+		_data->connect("maps_edited", callable_mp(this, &Terrain3D::_queue_collision_update));
+	}
 	// Any map was regenerated or regions changed, update material
 	if (!_data->is_connected("maps_changed", callable_mp(_material.ptr(), &Terrain3DMaterial::_update_maps))) {
 		LOG(DEBUG, "Connecting _data::maps_changed signal to _material->_update_maps()");
 		_data->connect("maps_changed", callable_mp(_material.ptr(), &Terrain3DMaterial::_update_maps));
 	}
-	// Height map was regenerated, update aabbs
-	if (!_data->is_connected("height_maps_changed", callable_mp(this, &Terrain3D::update_aabbs))) {
-		LOG(DEBUG, "Connecting _data::height_maps_changed signal to update_aabbs()");
-		_data->connect("height_maps_changed", callable_mp(this, &Terrain3D::update_aabbs));
+	// Regions were added or removed, update all aabbs
+	if (!_data->is_connected("region_map_changed", callable_mp(this, &Terrain3D::update_aabbs))) {
+		LOG(DEBUG, "Connecting _data::region_map_changed signal to update_aabbs()");
+		_data->connect("region_map_changed", callable_mp(this, &Terrain3D::update_aabbs));
+	}
+	// Maps were edited, update aabbs over the edited area
+	if (!_data->is_connected("maps_edited", callable_mp(this, &Terrain3D::_update_aabbs_area))) {
+		LOG(DEBUG, "Connecting _data::maps_edited signal to _update_aabbs_area()");
+		_data->connect("maps_edited", callable_mp(this, &Terrain3D::_update_aabbs_area));
 	}
 	// Texture assets changed, update material
 	if (!_assets->is_connected("textures_changed", callable_mp(_material.ptr(), &Terrain3DMaterial::_update_texture_arrays))) {
@@ -113,10 +122,45 @@ void Terrain3D::__process(const double p_delta) {
 	if (is_instance_valid(_camera_instance_id) && _camera->is_inside_tree()) {
 		Vector3 cam_pos = _camera->get_global_position();
 		Vector2 cam_pos_2d = Vector2(cam_pos.x, cam_pos.z);
-		if (_camera_last_position.distance_to(cam_pos_2d) > 0.2f) {
+		if (_camera_last_position.distance_to(cam_pos_2d) > 0.2f ||
+				(_occlusion_culling && _occlusion.needs_update(cam_pos))) {
 			snap(cam_pos);
 			_camera_last_position = cam_pos_2d;
 		}
+		// Create and free instancer cells around the camera, within a time budget each frame
+		if (_instancer_streaming && _instancer != nullptr) {
+			_instancer->update_streaming(cam_pos, _instancer_streaming_budget);
+		}
+	}
+
+	// Re-center the instance sets of extra cameras on them
+	for (int i = 0; i < _views.size(); i++) {
+		CameraView &view = _views.write[i];
+		if (!is_instance_valid(view.camera_id, view.camera)) {
+			LOG(DEBUG, "Extra camera freed, removing its instances");
+			_free_instances(view.instances);
+			_views.remove_at(i--);
+			continue;
+		}
+		if (!view.camera->is_inside_tree() || _mesh_data.mesh_set.meshes.is_empty()) {
+			continue;
+		}
+		RID scenario = view.camera->get_world_3d()->get_scenario();
+		if (!view.instances.cross.is_valid()) {
+			view.instances.mesh_set = _mesh_data.mesh_set;
+			view.instances.lods = _mesh_data.lods;
+			_create_instances(view.instances, scenario, view.layers, _cast_shadows);
+			view.last_position = V2_MAX;
+		} else if (view.scenario != scenario) {
+			_update_instances(view.instances, scenario, view.layers, _cast_shadows, is_visible_in_tree());
+		}
+		view.scenario = scenario;
+		Vector3 cam_pos = view.camera->get_global_position();
+		Vector2 cam_pos_2d = Vector2(cam_pos.x, cam_pos.z);
+		if (view.last_position.distance_to(cam_pos_2d) > 0.2f) {
+			_snap_instances(view.instances, cam_pos);
+			view.last_position = cam_pos_2d;
+		}
 	}
 }
 
@@ -169,189 +213,63 @@ void Terrain3D::_destroy_instancer() {
 }
 
 void Terrain3D::_build_collision() {
-	if (!_collision_enabled || !_is_inside_world || !is_inside_tree()) {
-		return;
-	}
-	// Create collision only in game, unless showing debug
-	if (IS_EDITOR && !_is_collision_editor()) {
-		return;
-	}
-	if (_data == nullptr) {
-		LOG(ERROR, "_data missing, cannot create collision");
+	if (!_is_inside_world || !is_inside_tree()) {
 		return;
 	}
-	_destroy_collision();
-
-	if (!_is_collision_editor()) {
-		LOG(INFO, "Building collision with physics server");
-		_static_body = PhysicsServer3D::get_singleton()->body_create();
-		PhysicsServer3D::get_singleton()->body_set_mode(_static_body, PhysicsServer3D::BODY_MODE_STATIC);
-		PhysicsServer3D::get_singleton()->body_set_space(_static_body, get_world_3d()->get_space());
-		PhysicsServer3D::get_singleton()->body_attach_object_instance_id(_static_body, get_instance_id());
-	} else {
-		LOG(WARN, "Building editor collision. Disable this mode for releases");
-		_debug_static_body = memnew(StaticBody3D);
-		_debug_static_body->set_name("StaticBody3D");
-		_debug_static_body->set_as_top_level(true);
-		add_child(_debug_static_body, true);
-	}
-	_update_collision();
+	_collision.build();
 }
 
-/* Eventually this should be callable to update collision on changes,
- * and especially updating only the ones that have changed. However it's not there yet, so
- * destroy and recreate for now.
- */
-void Terrain3D::_update_collision() {
-	if (!_collision_enabled || !is_inside_tree()) {
-		return;
-	}
-	// Create collision only in game, unless showing debug
-	if (IS_EDITOR && !_is_collision_editor()) {
-		return;
-	}
-	if ((!_is_collision_editor() && !_static_body.is_valid()) ||
-			(_is_collision_editor() && _debug_static_body == nullptr)) {
-		_build_collision();
-	}
-
-	int time = Time::get_singleton()->get_ticks_msec();
-	int shape_size = _region_size + 1;
-	for (int i = 0; i < _data->get_region_count(); i++) {
-		PackedRealArray map_data = PackedRealArray();
-		map_data.resize(shape_size * shape_size);
+// Connected to Terrain3DData::maps_edited
+void Terrain3D::_queue_collision_update(const AABB &p_area) {
+	_collision.queue_update(p_area);
+}
 
-		Vector2i region_loc = _data->get_region_locations()[i];
-		Vector2i global_loc = region_loc * _region_size;
-		Vector3 global_pos = Vector3(global_loc.x, 0.f, global_loc.y);
+void Terrain3D::_destroy_collision() {
+	_collision.destroy();
+}
 
-		Ref<Image> map, map_x, map_z, map_xz;
-		Ref<Image> cmap, cmap_x, cmap_z, cmap_xz;
-		Ref<Terrain3DRegion> region = _data->get_region(region_loc);
-		if (region.is_null()) {
-			LOG(ERROR, "Region ", region_loc, " not found");
-			continue;
+// Returns the clipmap meshes for the mesh size, generating them only if they aren't in the most
+// recently used cache, so switching between a few quality presets is instant.
+Terrain3D::MeshSet Terrain3D::_get_mesh_set(const int p_mesh_size, const int p_mesh_lods) {
+	int index = -1;
+	for (int i = 0; i < _mesh_cache.size(); i++) {
+		if (_mesh_cache[i].mesh_size == p_mesh_size) {
+			index = i;
+			break;
 		}
-		map = region->get_map(TYPE_HEIGHT);
-		cmap = region->get_map(TYPE_CONTROL);
-
-		region = _data->get_regionp(Vector3(global_pos.x + _region_size, 0.f, global_pos.z) * _vertex_spacing);
-		if (region.is_valid()) {
-			map_x = region->get_map(TYPE_HEIGHT);
-			cmap_x = region->get_map(TYPE_CONTROL);
-		}
-		region = _data->get_regionp(Vector3(global_pos.x, 0.f, global_pos.z + _region_size) * _vertex_spacing);
-		if (region.is_valid()) {
-			map_z = region->get_map(TYPE_HEIGHT);
-			cmap_z = region->get_map(TYPE_CONTROL);
-		}
-		region = _data->get_regionp(Vector3(global_pos.x + _region_size, 0.f, global_pos.z + _region_size) * _vertex_spacing);
-		if (region.is_valid()) {
-			map_xz = region->get_map(TYPE_HEIGHT);
-			cmap_xz = region->get_map(TYPE_CONTROL);
-		}
-
-		for (int z = 0; z < shape_size; z++) {
-			for (int x = 0; x < shape_size; x++) {
-				// Choose array indexing to match triangulation of heightmapshape with the mesh
-				// https://stackoverflow.com/questions/16684856/rotating-a-2d-pixel-array-by-90-degrees
-				// Normal array index rotated Y=0 - shape rotation Y=0 (xform below)
-				// int index = z * shape_size + x;
-				// Array Index Rotated Y=-90 - must rotate shape Y=+90 (xform below)
-				int index = shape_size - 1 - z + x * shape_size;
-
-				// Set heights on local map, or adjacent maps if on the last row/col
-				if (x < _region_size && z < _region_size) {
-					map_data[index] = (is_hole(cmap->get_pixel(x, z).r)) ? NAN : map->get_pixel(x, z).r;
-				} else if (x == _region_size && z < _region_size) {
-					if (map_x.is_valid()) {
-						map_data[index] = (is_hole(cmap_x->get_pixel(0, z).r)) ? NAN : map_x->get_pixel(0, z).r;
-					} else {
-						map_data[index] = 0.0f;
-					}
-				} else if (z == _region_size && x < _region_size) {
-					if (map_z.is_valid()) {
-						map_data[index] = (is_hole(cmap_z->get_pixel(x, 0).r)) ? NAN : map_z->get_pixel(x, 0).r;
-					} else {
-						map_data[index] = 0.0f;
-					}
-				} else if (x == _region_size && z == _region_size) {
-					if (map_xz.is_valid()) {
-						map_data[index] = (is_hole(cmap_xz->get_pixel(0, 0).r)) ? NAN : map_xz->get_pixel(0, 0).r;
-					} else {
-						map_data[index] = 0.0f;
-					}
-				}
-			}
+	}
+	if (index < 0) {
+		uint64_t time = Time::get_singleton()->get_ticks_usec();
+		MeshSet entry;
+		entry.mesh_size = p_mesh_size;
+		entry.meshes = GeoClipMap::generate(p_mesh_size, p_mesh_lods);
+		for (const RID rid : entry.meshes) {
+			entry.aabbs.push_back(RS->mesh_get_custom_aabb(rid));
 		}
-
-		// Non rotated shape for normal array index above
-		//Transform3D xform = Transform3D(Basis(), global_pos);
-		// Rotated shape Y=90 for -90 rotated array index
-		Transform3D xform = Transform3D(Basis(Vector3(0.f, 1.f, 0.f), Math_PI * .5f),
-				global_pos + Vector3(_region_size, 0.f, _region_size) * .5f);
-		xform.scale(Vector3(_vertex_spacing, 1.f, _vertex_spacing));
-
-		if (!_is_collision_editor()) {
-			RID shape = PhysicsServer3D::get_singleton()->heightmap_shape_create();
-			Dictionary shape_data;
-			shape_data["width"] = shape_size;
-			shape_data["depth"] = shape_size;
-			shape_data["heights"] = map_data;
-			Vector2 min_max = _data->get_height_range();
-			shape_data["min_height"] = min_max.x;
-			shape_data["max_height"] = min_max.y;
-			PhysicsServer3D::get_singleton()->shape_set_data(shape, shape_data);
-			PhysicsServer3D::get_singleton()->body_add_shape(_static_body, shape);
-			PhysicsServer3D::get_singleton()->body_set_shape_transform(_static_body, i, xform);
-			PhysicsServer3D::get_singleton()->body_set_collision_mask(_static_body, _collision_mask);
-			PhysicsServer3D::get_singleton()->body_set_collision_layer(_static_body, _collision_layer);
-			PhysicsServer3D::get_singleton()->body_set_collision_priority(_static_body, _collision_priority);
-		} else {
-			CollisionShape3D *debug_col_shape;
-			debug_col_shape = memnew(CollisionShape3D);
-			debug_col_shape->set_name("CollisionShape3D");
-			_debug_static_body->add_child(debug_col_shape, true);
-			debug_col_shape->set_owner(_debug_static_body);
-
-			Ref<HeightMapShape3D> hshape;
-			hshape.instantiate();
-			hshape->set_map_width(shape_size);
-			hshape->set_map_depth(shape_size);
-			hshape->set_map_data(map_data);
-			debug_col_shape->set_shape(hshape);
-			debug_col_shape->set_global_transform(xform);
-			_debug_static_body->set_collision_mask(_collision_mask);
-			_debug_static_body->set_collision_layer(_collision_layer);
-			_debug_static_body->set_collision_priority(_collision_priority);
+		_mesh_cache.insert(0, entry);
+		if (_mesh_cache.size() > MESH_CACHE_SIZE) {
+			LOG(DEBUG, "Freeing cached meshes of size: ", _mesh_cache[MESH_CACHE_SIZE].mesh_size);
+			for (const RID rid : _mesh_cache[MESH_CACHE_SIZE].meshes) {
+				RS->free_rid(rid);
+			}
+			_mesh_cache.remove_at(MESH_CACHE_SIZE);
 		}
+		LOG(DEBUG, "Generated meshes of size ", p_mesh_size, " in ", (Time::get_singleton()->get_ticks_usec() - time) / 1000.f, " ms");
+	} else if (index > 0) {
+		MeshSet entry = _mesh_cache[index];
+		_mesh_cache.remove_at(index);
+		_mesh_cache.insert(0, entry);
 	}
-	LOG(DEBUG, "Collision creation time: ", Time::get_singleton()->get_ticks_msec() - time, " ms");
+	return _mesh_cache[0];
 }
 
-void Terrain3D::_destroy_collision() {
-	if (_static_body.is_valid()) {
-		LOG(INFO, "Freeing physics body");
-		RID shape = PhysicsServer3D::get_singleton()->body_get_shape(_static_body, 0);
-		PhysicsServer3D::get_singleton()->free_rid(shape);
-		PhysicsServer3D::get_singleton()->free_rid(_static_body);
-		_static_body = RID();
-	}
-
-	if (_debug_static_body != nullptr) {
-		LOG(INFO, "Freeing debug static body");
-		for (int i = 0; i < _debug_static_body->get_child_count(); i++) {
-			Node *child = _debug_static_body->get_child(i);
-			LOG(DEBUG, "Freeing dsb child ", i, " ", child->get_name());
-			_debug_static_body->remove_child(child);
-			memdelete(child);
+void Terrain3D::_clear_mesh_cache() {
+	for (const MeshSet &entry : _mesh_cache) {
+		for (const RID rid : entry.meshes) {
+			RS->free_rid(rid);
 		}
-
-		LOG(DEBUG, "Freeing static body");
-		remove_child(_debug_static_body);
-		memdelete(_debug_static_body);
-		_debug_static_body = nullptr;
 	}
+	_mesh_cache.clear();
 }
 
 void Terrain3D::_build_meshes(const int p_mesh_lods, const int p_mesh_size) {
@@ -361,21 +279,70 @@ void Terrain3D::_build_meshes(const int p_mesh_lods, const int p_mesh_size) {
 	}
 	LOG(INFO, "Building the terrain meshes");
 
-	// Generate terrain meshes, lods, seams
-	_meshes = GeoClipMap::generate(p_mesh_size, p_mesh_lods);
-	ERR_FAIL_COND(_meshes.is_empty());
+	// Generate terrain meshes, lods, seams, or reuse them from the cache
+	_mesh_data.mesh_set = _get_mesh_set(p_mesh_size, p_mesh_lods);
+	ERR_FAIL_COND(_mesh_data.mesh_set.meshes.is_empty());
+	_mesh_data.lods = p_mesh_lods;
+	_mesh_data.lod_bias = 0;
+
+	// The shadow clipmap covers the same distance with fewer, coarser meshes
+	bool shadow_clipmap = _is_shadow_clipmap_active();
+	if (shadow_clipmap) {
+		_shadow_data.mesh_set = _get_mesh_set(_shadow_mesh_size, p_mesh_lods);
+		_shadow_data.lod_bias = _shadow_lod_bias;
+		_shadow_data.lods = 1;
+		while (_shadow_data.lods < p_mesh_lods &&
+				(_shadow_mesh_size << (_shadow_data.lods + _shadow_lod_bias)) < (p_mesh_size << p_mesh_lods)) {
+			_shadow_data.lods++;
+		}
+		LOG(DEBUG, "Shadow clipmap size: ", _shadow_mesh_size, ", lods: ", _shadow_data.lods, ", lod bias: ", _shadow_lod_bias);
+	}
 
 	// Set the current terrain material on all meshes
 	RID material_rid = _material->get_material_rid();
-	for (const RID rid : _meshes) {
+	for (const RID rid : _mesh_data.mesh_set.meshes) {
+		RS->mesh_surface_set_material(rid, 0, material_rid);
+	}
+	for (const RID rid : _shadow_data.mesh_set.meshes) {
 		RS->mesh_surface_set_material(rid, 0, material_rid);
 	}
 
 	LOG(DEBUG, "Creating mesh instances");
-
-	// Get current visual scenario so the instances appear in the scene
 	RID scenario = get_world_3d()->get_scenario();
+	_create_instances(_mesh_data, scenario, _render_layers, _get_main_cast_shadows());
+	if (shadow_clipmap) {
+		_create_instances(_shadow_data, scenario, _render_layers, RenderingServer::SHADOW_CASTING_SETTING_SHADOWS_ONLY);
+	}
+	// Extra camera sets are created on the next _process()
 
+	// Force a snap update of all levels, which also sets the AABBs
+	_camera_last_position = V2_MAX;
+}
+
+// Rebuilds the mesh instances only, eg on mesh or shadow setting changes. Collision and the other
+// subsystems don't depend on them, and the meshes themselves come from the cache after the first
+// use of a size.
+void Terrain3D::_rebuild_meshes() {
+	if (_initialized) {
+		_clear_meshes();
+		_build_meshes(_mesh_lods, _mesh_size);
+		_initialized = true;
+	}
+}
+
+bool Terrain3D::_is_shadow_clipmap_active() const {
+	return _shadow_clipmap_enabled && (_cast_shadows == RenderingServer::SHADOW_CASTING_SETTING_ON ||
+											  _cast_shadows == RenderingServer::SHADOW_CASTING_SETTING_DOUBLE_SIDED);
+}
+
+// The main clipmap leaves shadows to the shadow clipmap, if active
+RenderingServer::ShadowCastingSetting Terrain3D::_get_main_cast_shadows() const {
+	return _is_shadow_clipmap_active() ? RenderingServer::SHADOW_CASTING_SETTING_OFF : _cast_shadows;
+}
+
+// Creates a set of clipmap mesh instances in the scenario, using its mesh set, lods and lod bias
+void Terrain3D::_create_instances(Instances &r_instances, const RID &p_scenario, const uint32_t p_layers,
+		const RenderingServer::ShadowCastingSetting p_cast_shadows) {
 	bool baked_light;
 	bool dynamic_gi;
 	switch (_gi_mode) {
@@ -394,13 +361,13 @@ void Terrain3D::_build_meshes(const int p_mesh_lods, const int p_mesh_size) {
 		} break;
 	}
 
-	_mesh_data.cross = RS->instance_create2(_meshes[GeoClipMap::CROSS], scenario);
-	RS->instance_set_layer_mask(_mesh_data.cross, _render_layers);
-	RS->instance_geometry_set_cast_shadows_setting(_mesh_data.cross, _cast_shadows);
-	RS->instance_geometry_set_flag(_mesh_data.cross, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
-	RS->instance_geometry_set_flag(_mesh_data.cross, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
+	r_instances.cross = RS->instance_create2(r_instances.mesh_set.meshes[GeoClipMap::CROSS], p_scenario);
+	RS->instance_set_layer_mask(r_instances.cross, p_layers);
+	RS->instance_geometry_set_cast_shadows_setting(r_instances.cross, p_cast_shadows);
+	RS->instance_geometry_set_flag(r_instances.cross, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
+	RS->instance_geometry_set_flag(r_instances.cross, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
 
-	for (int lod = 0; lod < p_mesh_lods; lod++) {
+	for (int lod = 0; lod < r_instances.lods; lod++) {
 		for (int x = 0; x < 4; x++) {
 			for (int y = 0; y < 4; y++) {
 				if (lod != 0 && (x == 1 || x == 2) && (y == 1 || y == 2)) {
@@ -408,72 +375,60 @@ void Terrain3D::_build_meshes(const int p_mesh_lods, const int p_mesh_size) {
 				}
 				RID tile;
 				if (lod == 0) {
-					tile = RS->instance_create2(_meshes[GeoClipMap::TILE_INNER], scenario);
+					tile = RS->instance_create2(r_instances.mesh_set.meshes[GeoClipMap::TILE_INNER], p_scenario);
 				} else {
-					tile = RS->instance_create2(_meshes[GeoClipMap::TILE], scenario);
+					tile = RS->instance_create2(r_instances.mesh_set.meshes[GeoClipMap::TILE], p_scenario);
 				}
-				RS->instance_set_layer_mask(tile, _render_layers);
-				RS->instance_geometry_set_cast_shadows_setting(tile, _cast_shadows);
+				RS->instance_set_layer_mask(tile, p_layers);
+				RS->instance_geometry_set_cast_shadows_setting(tile, p_cast_shadows);
 				RS->instance_geometry_set_flag(tile, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
 				RS->instance_geometry_set_flag(tile, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
-				_mesh_data.tiles.push_back(tile);
+				r_instances.tiles.push_back(tile);
 			}
 		}
 
 		RID filler;
 		if (lod == 0) {
-			filler = RS->instance_create2(_meshes[GeoClipMap::FILLER_INNER], scenario);
+			filler = RS->instance_create2(r_instances.mesh_set.meshes[GeoClipMap::FILLER_INNER], p_scenario);
 		} else {
-			filler = RS->instance_create2(_meshes[GeoClipMap::FILLER], scenario);
+			filler = RS->instance_create2(r_instances.mesh_set.meshes[GeoClipMap::FILLER], p_scenario);
 		}
-		RS->instance_set_layer_mask(filler, _render_layers);
-		RS->instance_geometry_set_cast_shadows_setting(filler, _cast_shadows);
+		RS->instance_set_layer_mask(filler, p_layers);
+		RS->instance_geometry_set_cast_shadows_setting(filler, p_cast_shadows);
 		RS->instance_geometry_set_flag(filler, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
 		RS->instance_geometry_set_flag(filler, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
-		_mesh_data.fillers.push_back(filler);
+		r_instances.fillers.push_back(filler);
 
-		if (lod != p_mesh_lods - 1) {
+		if (lod != r_instances.lods - 1) {
 			RID trim;
 			if (lod == 0) {
-				trim = RS->instance_create2(_meshes[GeoClipMap::TRIM_INNER], scenario);
+				trim = RS->instance_create2(r_instances.mesh_set.meshes[GeoClipMap::TRIM_INNER], p_scenario);
 			} else {
-				trim = RS->instance_create2(_meshes[GeoClipMap::TRIM], scenario);
+				trim = RS->instance_create2(r_instances.mesh_set.meshes[GeoClipMap::TRIM], p_scenario);
 			}
-			RS->instance_set_layer_mask(trim, _render_layers);
-			RS->instance_geometry_set_cast_shadows_setting(trim, _cast_shadows);
+			RS->instance_set_layer_mask(trim, p_layers);
+			RS->instance_geometry_set_cast_shadows_setting(trim, p_cast_shadows);
 			RS->instance_geometry_set_flag(trim, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
 			RS->instance_geometry_set_flag(trim, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
-			_mesh_data.trims.push_back(trim);
+			r_instances.trims.push_back(trim);
 
-			RID seam = RS->instance_create2(_meshes[GeoClipMap::SEAM], scenario);
-			RS->instance_set_layer_mask(seam, _render_layers);
-			RS->instance_geometry_set_cast_shadows_setting(seam, _cast_shadows);
+			RID seam = RS->instance_create2(r_instances.mesh_set.meshes[GeoClipMap::SEAM], p_scenario);
+			RS->instance_set_layer_mask(seam, p_layers);
+			RS->instance_geometry_set_cast_shadows_setting(seam, p_cast_shadows);
 			RS->instance_geometry_set_flag(seam, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
 			RS->instance_geometry_set_flag(seam, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
-			_mesh_data.seams.push_back(seam);
+			r_instances.seams.push_back(seam);
 		}
 	}
-
-	update_aabbs();
-	// Force a snap update
-	_camera_last_position = V2_MAX;
+	r_instances.tile_aabbs.resize(r_instances.tiles.size());
+	r_instances.tiles_occluded.resize(r_instances.tiles.size());
+	r_instances.tiles_occluded.fill(false);
+	r_instances.snapped_cells.clear();
 }
 
-/**
- * Make all mesh instances visible or not
- * Update all mesh instances with the new world scenario so they appear
- */
-void Terrain3D::_update_mesh_instances() {
-	if (!_initialized || !_is_inside_world || !is_inside_tree()) {
-		return;
-	}
-	if (_static_body.is_valid()) {
-		RID _space = get_world_3d()->get_space();
-		PhysicsServer3D::get_singleton()->body_set_space(_static_body, _space);
-	}
-
-	RID _scenario = get_world_3d()->get_scenario();
-
+// Updates the scenario, visibility and render settings of a set of clipmap mesh instances
+void Terrain3D::_update_instances(const Instances &p_instances, const RID &p_scenario, const uint32_t p_layers,
+		const RenderingServer::ShadowCastingSetting p_cast_shadows, const bool p_visible) {
 	bool baked_light;
 	bool dynamic_gi;
 	switch (_gi_mode) {
@@ -492,74 +447,112 @@ void Terrain3D::_update_mesh_instances() {
 		} break;
 	}
 
-	bool v = is_visible_in_tree();
-	RS->instance_set_visible(_mesh_data.cross, v);
-	RS->instance_set_scenario(_mesh_data.cross, _scenario);
-	RS->instance_set_layer_mask(_mesh_data.cross, _render_layers);
-	RS->instance_geometry_set_cast_shadows_setting(_mesh_data.cross, _cast_shadows);
-	RS->instance_geometry_set_flag(_mesh_data.cross, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
-	RS->instance_geometry_set_flag(_mesh_data.cross, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
-
-	for (const RID rid : _mesh_data.tiles) {
-		RS->instance_set_visible(rid, v);
-		RS->instance_set_scenario(rid, _scenario);
-		RS->instance_set_layer_mask(rid, _render_layers);
-		RS->instance_geometry_set_cast_shadows_setting(rid, _cast_shadows);
+	RS->instance_set_visible(p_instances.cross, p_visible);
+	RS->instance_set_scenario(p_instances.cross, p_scenario);
+	RS->instance_set_layer_mask(p_instances.cross, p_layers);
+	RS->instance_geometry_set_cast_shadows_setting(p_instances.cross, p_cast_shadows);
+	RS->instance_geometry_set_flag(p_instances.cross, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
+	RS->instance_geometry_set_flag(p_instances.cross, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
+
+	for (int i = 0; i < p_instances.tiles.size(); i++) {
+		const RID rid = p_instances.tiles[i];
+		_apply_tile_occlusion(p_instances, i, p_cast_shadows, p_visible);
+		RS->instance_set_scenario(rid, p_scenario);
+		RS->instance_set_layer_mask(rid, p_layers);
 		RS->instance_geometry_set_flag(rid, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
 		RS->instance_geometry_set_flag(rid, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
 	}
 
-	for (const RID rid : _mesh_data.fillers) {
-		RS->instance_set_visible(rid, v);
-		RS->instance_set_scenario(rid, _scenario);
-		RS->instance_set_layer_mask(rid, _render_layers);
-		RS->instance_geometry_set_cast_shadows_setting(rid, _cast_shadows);
+	for (const RID rid : p_instances.fillers) {
+		RS->instance_set_visible(rid, p_visible);
+		RS->instance_set_scenario(rid, p_scenario);
+		RS->instance_set_layer_mask(rid, p_layers);
+		RS->instance_geometry_set_cast_shadows_setting(rid, p_cast_shadows);
 		RS->instance_geometry_set_flag(rid, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
 		RS->instance_geometry_set_flag(rid, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
 	}
 
-	for (const RID rid : _mesh_data.trims) {
-		RS->instance_set_visible(rid, v);
-		RS->instance_set_scenario(rid, _scenario);
-		RS->instance_set_layer_mask(rid, _render_layers);
-		RS->instance_geometry_set_cast_shadows_setting(rid, _cast_shadows);
+	for (const RID rid : p_instances.trims) {
+		RS->instance_set_visible(rid, p_visible);
+		RS->instance_set_scenario(rid, p_scenario);
+		RS->instance_set_layer_mask(rid, p_layers);
+		RS->instance_geometry_set_cast_shadows_setting(rid, p_cast_shadows);
 		RS->instance_geometry_set_flag(rid, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
 		RS->instance_geometry_set_flag(rid, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
 	}
 
-	for (const RID rid : _mesh_data.seams) {
-		RS->instance_set_visible(rid, v);
-		RS->instance_set_scenario(rid, _scenario);
-		RS->instance_set_layer_mask(rid, _render_layers);
-		RS->instance_geometry_set_cast_shadows_setting(rid, _cast_shadows);
+	for (const RID rid : p_instances.seams) {
+		RS->instance_set_visible(rid, p_visible);
+		RS->instance_set_scenario(rid, p_scenario);
+		RS->instance_set_layer_mask(rid, p_layers);
+		RS->instance_geometry_set_cast_shadows_setting(rid, p_cast_shadows);
 		RS->instance_geometry_set_flag(rid, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, baked_light);
 		RS->instance_geometry_set_flag(rid, RenderingServer::INSTANCE_FLAG_USE_DYNAMIC_GI, dynamic_gi);
 	}
 }
 
-void Terrain3D::_clear_meshes() {
-	LOG(INFO, "Clearing the terrain meshes");
-	for (const RID rid : _meshes) {
-		RS->free_rid(rid);
+void Terrain3D::_free_instances(Instances &r_instances) {
+	if (r_instances.cross.is_valid()) {
+		RS->free_rid(r_instances.cross);
+		r_instances.cross = RID();
 	}
-	RS->free_rid(_mesh_data.cross);
-	for (const RID rid : _mesh_data.tiles) {
+	for (const RID rid : r_instances.tiles) {
 		RS->free_rid(rid);
 	}
-	for (const RID rid : _mesh_data.fillers) {
+	for (const RID rid : r_instances.fillers) {
 		RS->free_rid(rid);
 	}
-	for (const RID rid : _mesh_data.trims) {
+	for (const RID rid : r_instances.trims) {
 		RS->free_rid(rid);
 	}
-	for (const RID rid : _mesh_data.seams) {
+	for (const RID rid : r_instances.seams) {
 		RS->free_rid(rid);
 	}
-	_meshes.clear();
-	_mesh_data.tiles.clear();
-	_mesh_data.fillers.clear();
-	_mesh_data.trims.clear();
-	_mesh_data.seams.clear();
+	r_instances.tiles.clear();
+	r_instances.tile_aabbs.clear();
+	r_instances.tiles_occluded.clear();
+	r_instances.fillers.clear();
+	r_instances.trims.clear();
+	r_instances.seams.clear();
+	r_instances.snapped_cells.clear();
+}
+
+/**
+ * Make all mesh instances visible or not
+ * Update all mesh instances with the new world scenario so they appear
+ */
+void Terrain3D::_update_mesh_instances() {
+	if (!_initialized || !_is_inside_world || !is_inside_tree()) {
+		return;
+	}
+	_collision.update_settings();
+
+	bool v = is_visible_in_tree();
+	RID scenario = get_world_3d()->get_scenario();
+	_update_instances(_mesh_data, scenario, _render_layers, _get_main_cast_shadows(), v);
+	if (_shadow_data.cross.is_valid()) {
+		_update_instances(_shadow_data, scenario, _render_layers, RenderingServer::SHADOW_CASTING_SETTING_SHADOWS_ONLY, v);
+	}
+	for (const CameraView &view : _views) {
+		if (view.instances.cross.is_valid()) {
+			_update_instances(view.instances, view.scenario, view.layers, _cast_shadows, v);
+		}
+	}
+	if (_instancer != nullptr) {
+		_instancer->_update_scenario(scenario, v);
+	}
+}
+
+void Terrain3D::_clear_meshes() {
+	LOG(INFO, "Clearing the terrain meshes");
+	// The mesh RIDs are owned by _mesh_cache
+	_free_instances(_mesh_data);
+	_free_instances(_shadow_data);
+	for (int i = 0; i < _views.size(); i++) {
+		_free_instances(_views.write[i].instances);
+	}
+	_mesh_data.mesh_set = MeshSet();
+	_shadow_data.mesh_set = MeshSet();
 	_initialized = false;
 }
 
@@ -628,6 +621,27 @@ void Terrain3D::_destroy_mouse_picking() {
 	memdelete_safely(_mouse_vp);
 }
 
+// Runs one group of intersect_rays() on a worker thread
+void Terrain3D::_intersect_ray_group(void *p_batch, uint32_t p_group) {
+	const RayBatch *batch = static_cast<const RayBatch *>(p_batch);
+	int start = int(p_group) * RAY_GROUP_SIZE;
+	int end = MIN(start + RAY_GROUP_SIZE, batch->count);
+	for (int i = start; i < end; i++) {
+		Vector3 direction = batch->directions[i].normalized();
+		real_t max_distance = batch->max_distances ? real_t(batch->max_distances[i]) : FLT_MAX;
+		real_t distance;
+		if (batch->data->intersect_ray(batch->origins[i], direction, max_distance, distance)) {
+			batch->positions[i] = batch->origins[i] + direction * distance;
+			batch->normals[i] = batch->data->get_normal(batch->positions[i]);
+			batch->distances[i] = distance;
+		} else {
+			batch->positions[i] = V3_MAX;
+			batch->normals[i] = V3_ZERO;
+			batch->distances[i] = -1.f;
+		}
+	}
+}
+
 void Terrain3D::_generate_triangles(PackedVector3Array &p_vertices, PackedVector2Array *p_uvs, const int32_t p_lod,
 		const Terrain3DData::HeightFilter p_filter, const bool p_require_nav, const AABB &p_global_aabb) const {
 	ERR_FAIL_COND(_data == nullptr);
@@ -719,6 +733,9 @@ void Terrain3D::_generate_triangle_pair(PackedVector3Array &p_vertices, PackedVe
 ///////////////////////////
 
 Terrain3D::Terrain3D() {
+	_collision.initialize(this);
+	_occlusion.initialize(this);
+
 	// Check if we are using the compatibility renderer
 	_compatibility = String(ProjectSettings::get_singleton()->get_setting_with_override("rendering/renderer/rendering_method")).contains("gl_compatibility");
 
@@ -809,6 +826,66 @@ void Terrain3D::set_camera(Camera3D *p_camera) {
 	}
 }
 
+/**
+ * Adds an extra camera, eg for split screen, picture in picture or reflections, with its own set of
+ * clipmap instances centered on it. The set shares the meshes and material of the main terrain and
+ * renders only on p_layers, in the world of the camera's viewport. Include p_layers in that camera's
+ * cull mask and exclude them from the others. Calling it again updates the layers.
+ */
+void Terrain3D::add_camera(Camera3D *p_camera, const uint32_t p_layers) {
+	if (p_camera == nullptr) {
+		LOG(ERROR, "Camera is null");
+		return;
+	}
+	uint64_t id = p_camera->get_instance_id();
+	for (int i = 0; i < _views.size(); i++) {
+		CameraView &view = _views.write[i];
+		if (view.camera_id == id) {
+			LOG(INFO, "Setting extra camera ", p_camera, " layers: ", p_layers);
+			view.layers = p_layers;
+			if (view.instances.cross.is_valid()) {
+				_update_instances(view.instances, view.scenario, view.layers, _cast_shadows, is_visible_in_tree());
+			}
+			return;
+		}
+	}
+	LOG(INFO, "Adding extra camera ", p_camera, " on layers: ", p_layers);
+	CameraView view;
+	view.camera = p_camera;
+	view.camera_id = id;
+	view.layers = p_layers;
+	_views.push_back(view);
+	// Show MMIs occluded from the main camera, as the new one may see them
+	if (_occlusion_culling) {
+		_update_occlusion();
+	}
+}
+
+void Terrain3D::remove_camera(Camera3D *p_camera) {
+	if (p_camera == nullptr) {
+		return;
+	}
+	uint64_t id = p_camera->get_instance_id();
+	for (int i = 0; i < _views.size(); i++) {
+		if (_views[i].camera_id == id) {
+			LOG(INFO, "Removing extra camera ", p_camera);
+			_free_instances(_views.write[i].instances);
+			_views.remove_at(i);
+			return;
+		}
+	}
+}
+
+TypedArray<Camera3D> Terrain3D::get_cameras() const {
+	TypedArray<Camera3D> cameras;
+	for (const CameraView &view : _views) {
+		if (is_instance_valid(view.camera_id, view.camera)) {
+			cameras.push_back(view.camera);
+		}
+	}
+	return cameras;
+}
+
 void Terrain3D::set_region_size(const RegionSize p_size) {
 	LOG(INFO, "Setting region size: ", p_size);
 	ERR_FAIL_COND(p_size < SIZE_64);
@@ -828,6 +905,27 @@ void Terrain3D::set_save_16_bit(const bool p_enabled) {
 	_save_16_bit = p_enabled;
 }
 
+void Terrain3D::set_texture_streaming(const bool p_enabled) {
+	if (_texture_streaming != p_enabled) {
+		LOG(INFO, "Setting texture streaming: ", p_enabled);
+		_texture_streaming = p_enabled;
+		if (_data) {
+			_data->force_update_maps();
+		}
+	}
+}
+
+void Terrain3D::set_texture_streaming_radius(const int p_radius) {
+	int radius = CLAMP(p_radius, 1, 7);
+	if (_texture_streaming_radius != radius) {
+		LOG(INFO, "Setting texture streaming radius: ", radius);
+		_texture_streaming_radius = radius;
+		if (_data && _texture_streaming) {
+			_data->force_update_maps();
+		}
+	}
+}
+
 void Terrain3D::set_label_distance(const real_t p_distance) {
 	real_t distance = CLAMP(p_distance, 0.f, 100000.f);
 	LOG(INFO, "Setting region label distance: ", distance);
@@ -900,73 +998,81 @@ void Terrain3D::set_collision_mode(CollisionMode p_mode) {
 void Terrain3D::set_collision_layer(const uint32_t p_layers) {
 	LOG(INFO, "Setting collision layers: ", p_layers);
 	_collision_layer = p_layers;
-	if (_is_collision_editor()) {
-		if (_debug_static_body != nullptr) {
-			_debug_static_body->set_collision_layer(_collision_layer);
-		}
-	} else {
-		if (_static_body.is_valid()) {
-			PhysicsServer3D::get_singleton()->body_set_collision_layer(_static_body, _collision_layer);
-		}
-	}
+	_collision.update_settings();
 }
 
 void Terrain3D::set_collision_mask(const uint32_t p_mask) {
 	LOG(INFO, "Setting collision mask: ", p_mask);
 	_collision_mask = p_mask;
-	if (_is_collision_editor()) {
-		if (_debug_static_body != nullptr) {
-			_debug_static_body->set_collision_mask(_collision_mask);
-		}
-	} else {
-		if (_static_body.is_valid()) {
-			PhysicsServer3D::get_singleton()->body_set_collision_mask(_static_body, _collision_mask);
-		}
-	}
+	_collision.update_settings();
 }
 
 void Terrain3D::set_collision_priority(const real_t p_priority) {
 	LOG(INFO, "Setting collision priority: ", p_priority);
 	_collision_priority = p_priority;
-	if (_is_collision_editor()) {
-		if (_debug_static_body != nullptr) {
-			_debug_static_body->set_collision_priority(_collision_priority);
-		}
-	} else {
-		if (_static_body.is_valid()) {
-			PhysicsServer3D::get_singleton()->body_set_collision_priority(_static_body, _collision_priority);
-		}
+	_collision.update_settings();
+}
+
+void Terrain3D::set_collision_shape_size(const int p_size) {
+	if (p_size < 32 || p_size > 512 || (p_size & (p_size - 1)) != 0) {
+		LOG(ERROR, "Collision shape size must be a power of 2 from 32 to 512: ", p_size);
+		return;
+	}
+	if (_collision_shape_size != p_size) {
+		LOG(INFO, "Setting collision shape size: ", p_size);
+		_collision_shape_size = p_size;
+		_build_collision();
 	}
 }
 
-RID Terrain3D::get_collision_rid() const {
-	if (!_is_collision_editor()) {
-		return _static_body;
-	} else {
-		if (_debug_static_body != nullptr) {
-			return _debug_static_body->get_rid();
+void Terrain3D::set_collision_radius(const real_t p_radius) {
+	real_t radius = MAX(p_radius, 0.f);
+	if (_collision_radius != radius) {
+		LOG(INFO, "Setting collision radius: ", radius);
+		_collision_radius = radius;
+		if (_collision_mode == DYNAMIC_GAME || _collision_mode == DYNAMIC_EDITOR) {
+			_build_collision();
 		}
 	}
-	return RID();
+}
+
+void Terrain3D::set_collision_lod_distances(const Vector3 &p_distances) {
+	Vector3 distances = p_distances.clamp(V3_ZERO, V3_MAX);
+	if (_collision_lod_distances != distances) {
+		LOG(INFO, "Setting collision LOD distances: ", distances);
+		_collision_lod_distances = distances;
+		_build_collision();
+	}
+}
+
+// Dynamic collision is kept around these nodes, or the camera if there are none
+void Terrain3D::add_collision_target(Node3D *p_node) {
+	_collision.add_target(p_node);
+	_collision.update();
+}
+
+void Terrain3D::remove_collision_target(Node3D *p_node) {
+	_collision.remove_target(p_node);
+}
+
+// Applies queued collision edits and target moves now rather than on the next physics frame
+void Terrain3D::update_collision() {
+	_collision.update();
 }
 
 void Terrain3D::set_mesh_lods(const int p_count) {
 	if (_mesh_lods != p_count) {
-		_clear_meshes();
-		_destroy_collision();
 		LOG(INFO, "Setting mesh levels: ", p_count);
 		_mesh_lods = p_count;
-		_initialize();
+		_rebuild_meshes();
 	}
 }
 
 void Terrain3D::set_mesh_size(const int p_size) {
 	if (_mesh_size != p_size) {
-		_clear_meshes();
-		_destroy_collision();
 		LOG(INFO, "Setting mesh size: ", p_size);
 		_mesh_size = p_size;
-		_initialize();
+		_rebuild_meshes();
 	}
 }
 
@@ -1018,8 +1124,43 @@ void Terrain3D::set_mouse_layer(const uint32_t p_layer) {
 }
 
 void Terrain3D::set_cast_shadows(const RenderingServer::ShadowCastingSetting p_cast_shadows) {
+	bool was_shadow_clipmap = _is_shadow_clipmap_active();
 	_cast_shadows = p_cast_shadows;
-	_update_mesh_instances();
+	if (was_shadow_clipmap != _is_shadow_clipmap_active()) {
+		_rebuild_meshes();
+	} else {
+		_update_mesh_instances();
+	}
+}
+
+void Terrain3D::set_shadow_clipmap_enabled(const bool p_enabled) {
+	if (_shadow_clipmap_enabled != p_enabled) {
+		LOG(INFO, "Setting shadow clipmap enabled: ", p_enabled);
+		_shadow_clipmap_enabled = p_enabled;
+		_rebuild_meshes();
+	}
+}
+
+void Terrain3D::set_shadow_lod_bias(const int p_bias) {
+	int bias = CLAMP(p_bias, 0, 4);
+	if (_shadow_lod_bias != bias) {
+		LOG(INFO, "Setting shadow lod bias: ", bias);
+		_shadow_lod_bias = bias;
+		if (_shadow_clipmap_enabled) {
+			_rebuild_meshes();
+		}
+	}
+}
+
+void Terrain3D::set_shadow_mesh_size(const int p_size) {
+	int size = CLAMP(p_size, 8, 64);
+	if (_shadow_mesh_size != size) {
+		LOG(INFO, "Setting shadow mesh size: ", size);
+		_shadow_mesh_size = size;
+		if (_shadow_clipmap_enabled) {
+			_rebuild_meshes();
+		}
+	}
 }
 
 void Terrain3D::set_gi_mode(const GeometryInstance3D::GIMode p_gi_mode) {
@@ -1033,26 +1174,141 @@ void Terrain3D::set_cull_margin(const real_t p_margin) {
 	update_aabbs();
 }
 
+void Terrain3D::set_height_pyramids(const bool p_enabled) {
+	if (_height_pyramids != p_enabled) {
+		LOG(INFO, "Setting height pyramids: ", p_enabled);
+		_height_pyramids = p_enabled;
+		if (_data) {
+			_data->update_height_mips();
+		}
+		update_aabbs();
+	}
+}
+
+void Terrain3D::set_occlusion_culling(const bool p_enabled) {
+	if (_occlusion_culling != p_enabled) {
+		LOG(INFO, "Setting occlusion culling: ", p_enabled);
+		_occlusion_culling = p_enabled;
+		_occlusion.clear();
+		if (!p_enabled) {
+			_update_occlusion();
+		}
+	}
+}
+
+void Terrain3D::set_instancer_mode(const InstancerMode p_mode) {
+	if (_instancer_mode != p_mode) {
+		LOG(INFO, "Setting instancer mode: ", p_mode);
+		_instancer_mode = p_mode;
+		if (_instancer != nullptr) {
+			_instancer->force_update_mmis();
+		}
+	}
+}
+
+void Terrain3D::set_instancer_streaming(const bool p_enabled) {
+	if (_instancer_streaming != p_enabled) {
+		LOG(INFO, "Setting instancer streaming: ", p_enabled);
+		_instancer_streaming = p_enabled;
+		if (_instancer != nullptr) {
+			_instancer->force_update_mmis();
+		}
+	}
+}
+
+void Terrain3D::set_instancer_streaming_budget(const real_t p_budget) {
+	LOG(INFO, "Setting instancer streaming budget: ", p_budget, " ms");
+	_instancer_streaming_budget = CLAMP(p_budget, 0.f, 100.f);
+}
+
 /**
  * Centers the terrain and LODs on a provided position. Y height is ignored.
  */
 void Terrain3D::snap(const Vector3 &p_cam_pos) {
+	LOG(EXTREME, "Snapping terrain to: ", String(p_cam_pos));
+	if (_data) {
+		_data->update_streaming(p_cam_pos);
+	}
+	_snap_rs_calls = _snap_instances(_mesh_data, p_cam_pos);
+	if (_shadow_data.cross.is_valid()) {
+		_snap_rs_calls += _snap_instances(_shadow_data, p_cam_pos);
+	}
+	if (_occlusion_culling) {
+		_occlusion.update(p_cam_pos);
+		_update_occlusion();
+	}
+	LOG(EXTREME, "Snap RenderingServer calls: ", _snap_rs_calls);
+}
+
+// Moves a set of clipmap meshes to the camera. Each LOD only moves when the camera crosses a cell of
+// its snap grid, which is twice as large as the previous level's, so outer levels rarely need updates.
+// All transforms of a level depend only on its cell, so unchanged levels are skipped. Moved meshes
+// get an AABB fit to the heights under their new footprint. If p_refit_area is given, meshes of
+// unmoved levels over it are refit in place. Returns the RenderingServer calls made.
+int Terrain3D::_snap_instances(Instances &r_instances, const Vector3 &p_cam_pos, const Rect2 &p_refit_area) {
 	Vector3 cam_pos = p_cam_pos;
 	cam_pos.y = 0;
-	LOG(EXTREME, "Snapping terrain to: ", String(cam_pos));
-	Vector3 snapped_pos = (cam_pos / _vertex_spacing).floor() * _vertex_spacing;
-	Transform3D t = Transform3D().scaled(Vector3(_vertex_spacing, 1, _vertex_spacing));
-	t.origin = snapped_pos;
-	RS->instance_set_transform(_mesh_data.cross, t);
+	if (r_instances.snapped_cells.size() != r_instances.lods) {
+		r_instances.snapped_cells.resize(r_instances.lods);
+		r_instances.snapped_cells.fill(Vector2i(INT32_MAX, INT32_MAX));
+	}
+	r_instances.snapped_position = p_cam_pos;
+	const bool refit = p_refit_area.has_area();
+	int rs_calls = 0;
 
 	int edge = 0;
 	int tile = 0;
 
-	for (int l = 0; l < _mesh_lods; l++) {
-		real_t scale = real_t(1 << l) * _vertex_spacing;
-		snapped_pos = (cam_pos / scale).floor() * scale;
-		Vector3 tile_size = Vector3(real_t(_mesh_size << l), 0, real_t(_mesh_size << l)) * _vertex_spacing;
-		Vector3 base = snapped_pos - Vector3(real_t(_mesh_size << (l + 1)), 0.f, real_t(_mesh_size << (l + 1))) * _vertex_spacing;
+	const int mesh_size = r_instances.mesh_set.mesh_size;
+	const Vector<AABB> &aabbs = r_instances.mesh_set.aabbs;
+
+	// Moves a mesh instance, or in a refit, updates its AABB only if over the refit area. Returns
+	// true and the global AABB in r_aabb if set.
+	bool moved = false;
+	auto place = [&](const RID &p_instance, const AABB &p_mesh_aabb, const Transform3D &p_xform, AABB *r_aabb = nullptr) -> bool {
+		if (!moved) {
+			AABB global_aabb = p_xform.xform(p_mesh_aabb);
+			Rect2 area = Rect2(global_aabb.position.x, global_aabb.position.z, global_aabb.size.x, global_aabb.size.z);
+			if (!area.grow(p_xform.basis.get_scale().x).intersects(p_refit_area)) {
+				return false;
+			}
+		} else {
+			RS->instance_set_transform(p_instance, p_xform);
+			rs_calls++;
+		}
+		AABB aabb = _set_instance_aabb(p_instance, p_mesh_aabb, p_xform);
+		rs_calls++;
+		if (r_aabb) {
+			*r_aabb = aabb;
+		}
+		return true;
+	};
+
+	for (int l = 0; l < r_instances.lods; l++) {
+		int lb = l + r_instances.lod_bias; // Level of detail for sizes, l for indices
+		real_t scale = real_t(1 << lb) * _vertex_spacing;
+		Vector3 cell = (cam_pos / scale).floor();
+		Vector3 tile_size = Vector3(real_t(mesh_size << lb), 0, real_t(mesh_size << lb)) * _vertex_spacing;
+		moved = r_instances.snapped_cells[l] != Vector2i(cell.x, cell.z);
+		if (!moved) {
+			// The level spans 4 tiles plus a vertex each side of its snapped position
+			Vector2 level_pos = Vector2(r_instances.snapped_cells[l]) * scale;
+			Vector2 half = Vector2(tile_size.x, tile_size.z) * 2.f + Vector2(scale, scale) * 2.f;
+			if (!refit || !Rect2(level_pos - half, half * 2.f).intersects(p_refit_area)) {
+				tile += (l == 0) ? 16 : 12;
+				edge += (l != r_instances.lods - 1) ? 1 : 0;
+				continue;
+			}
+		}
+		r_instances.snapped_cells.write[l] = Vector2i(cell.x, cell.z);
+		Vector3 snapped_pos = cell * scale;
+		Vector3 base = snapped_pos - Vector3(real_t(mesh_size << (lb + 1)), 0.f, real_t(mesh_size << (lb + 1))) * _vertex_spacing;
+
+		if (l == 0) {
+			Transform3D t = Transform3D().scaled(Vector3(scale, 1, scale));
+			t.origin = snapped_pos;
+			place(r_instances.cross, aabbs[GeoClipMap::CROSS], t);
+		}
 
 		// Position tiles
 		for (int x = 0; x < 4; x++) {
@@ -1068,7 +1324,7 @@ void Terrain3D::snap(const Vector3 &p_cam_pos) {
 				Transform3D t = Transform3D().scaled(Vector3(scale, 1.f, scale));
 				t.origin = tile_tl;
 
-				RS->instance_set_transform(_mesh_data.tiles[tile], t);
+				place(r_instances.tiles[tile], aabbs[GeoClipMap::TILE], t, &r_instances.tile_aabbs.write[tile]);
 
 				tile++;
 			}
@@ -1076,10 +1332,10 @@ void Terrain3D::snap(const Vector3 &p_cam_pos) {
 		{
 			Transform3D t = Transform3D().scaled(Vector3(scale, 1.f, scale));
 			t.origin = snapped_pos;
-			RS->instance_set_transform(_mesh_data.fillers[l], t);
+			place(r_instances.fillers[l], aabbs[GeoClipMap::FILLER], t);
 		}
 
-		if (l != _mesh_lods - 1) {
+		if (l != r_instances.lods - 1) {
 			real_t next_scale = scale * 2.0f;
 			Vector3 next_snapped_pos = (cam_pos / next_scale).floor() * next_scale;
 
@@ -1098,63 +1354,115 @@ void Terrain3D::snap(const Vector3 &p_cam_pos) {
 				Transform3D t = Transform3D().rotated(Vector3(0.f, 1.f, 0.f), -angle);
 				t = t.scaled(Vector3(scale, 1.f, scale));
 				t.origin = tile_center;
-				RS->instance_set_transform(_mesh_data.trims[edge], t);
+				place(r_instances.trims[edge], aabbs[GeoClipMap::TRIM], t);
 			}
 
 			// Position seams
 			{
-				Vector3 next_base = next_snapped_pos - Vector3(real_t(_mesh_size << (l + 1)), 0.f, real_t(_mesh_size << (l + 1))) * _vertex_spacing;
+				Vector3 next_base = next_snapped_pos - Vector3(real_t(mesh_size << (lb + 1)), 0.f, real_t(mesh_size << (lb + 1))) * _vertex_spacing;
 				Transform3D t = Transform3D().scaled(Vector3(scale, 1.f, scale));
 				t.origin = next_base;
-				RS->instance_set_transform(_mesh_data.seams[edge], t);
+				place(r_instances.seams[edge], aabbs[GeoClipMap::SEAM], t);
 			}
 			edge++;
 		}
 	}
+	return rs_calls;
 }
 
-void Terrain3D::update_aabbs() {
-	if (_meshes.is_empty() || _data == nullptr) {
-		LOG(DEBUG, "Update AABB called before terrain meshes built. Returning.");
-		return;
+// Refits the AABBs of a set of clipmap meshes over a changed area, where they were last snapped
+int Terrain3D::_refit_instances(Instances &r_instances, const Rect2 &p_area) {
+	if (r_instances.snapped_cells.size() != r_instances.lods) {
+		return 0; // Not snapped yet, AABBs are fit when it is
 	}
+	return _snap_instances(r_instances, r_instances.snapped_position, p_area);
+}
 
-	Vector2 height_range = _data->get_height_range();
-	LOG(EXTREME, "Updating AABBs. Total height range: ", height_range, ", extra cull margin: ", _cull_margin);
-	height_range.y += abs(height_range.x); // Add below zero to total size
-
-	AABB aabb = RS->mesh_get_custom_aabb(_meshes[GeoClipMap::CROSS]);
+// Sets the custom AABB of a mesh instance to the terrain height range under its footprint, so
+// tiles over flat ground aren't stretched by distant mountains, and can be culled from the camera
+// and shadow frustums. Returns the global AABB.
+AABB Terrain3D::_set_instance_aabb(const RID &p_instance, const AABB &p_mesh_aabb, const Transform3D &p_xform) {
+	AABB aabb = p_mesh_aabb;
+	AABB global_aabb = p_xform.xform(aabb);
+	// Grow by a vertex of this LOD for vertices morphing towards the next
+	real_t margin = p_xform.basis.get_scale().x;
+	Rect2 area = Rect2(global_aabb.position.x, global_aabb.position.z, global_aabb.size.x, global_aabb.size.z).grow(margin);
+	Vector2 height_range = _data->get_area_height_range(area);
 	aabb.position.y = height_range.x - _cull_margin;
-	aabb.size.y = height_range.y + _cull_margin * 2.f;
-	RS->instance_set_custom_aabb(_mesh_data.cross, aabb);
+	aabb.size.y = height_range.y - height_range.x + _cull_margin * 2.f;
+	RS->instance_set_custom_aabb(p_instance, aabb);
+	return p_xform.xform(aabb);
+}
 
-	aabb = RS->mesh_get_custom_aabb(_meshes[GeoClipMap::TILE]);
-	aabb.position.y = height_range.x - _cull_margin;
-	aabb.size.y = height_range.y + _cull_margin * 2.f;
+// Hides the clipmap tiles and instancer cells the terrain occludes from the camera, or shows all if
+// occlusion culling is disabled. Only tiles are tested. Fillers, trims and seams are thin rings
+// around the camera, which are rarely hidden entirely. The main tiles are only drawn for the main
+// camera, but MMIs are shared by every camera, so they aren't culled while there are extra cameras.
+void Terrain3D::_update_occlusion() {
+	bool visible = is_visible_in_tree();
+	RenderingServer::ShadowCastingSetting cast_shadows = _get_main_cast_shadows();
+	_occluded_tiles = 0;
 	for (int i = 0; i < _mesh_data.tiles.size(); i++) {
-		RS->instance_set_custom_aabb(_mesh_data.tiles[i], aabb);
+		bool occluded = _occlusion_culling && _occlusion.is_occluded(_mesh_data.tile_aabbs[i]);
+		if (occluded != _mesh_data.tiles_occluded[i]) {
+			_mesh_data.tiles_occluded.write[i] = occluded;
+			_apply_tile_occlusion(_mesh_data, i, cast_shadows, visible);
+		}
+		_occluded_tiles += occluded ? 1 : 0;
 	}
-
-	aabb = RS->mesh_get_custom_aabb(_meshes[GeoClipMap::FILLER]);
-	aabb.position.y = height_range.x - _cull_margin;
-	aabb.size.y = height_range.y + _cull_margin * 2.f;
-	for (int i = 0; i < _mesh_data.fillers.size(); i++) {
-		RS->instance_set_custom_aabb(_mesh_data.fillers[i], aabb);
+	_occluded_mmis = 0;
+	if (_instancer != nullptr) {
+		_occluded_mmis = _instancer->_update_occlusion((_occlusion_culling && _views.is_empty()) ? &_occlusion : nullptr);
 	}
+	LOG(EXTREME, "Occluded tiles: ", _occluded_tiles, ", MMIs: ", _occluded_mmis);
+}
 
-	aabb = RS->mesh_get_custom_aabb(_meshes[GeoClipMap::TRIM]);
-	aabb.position.y = height_range.x - _cull_margin;
-	aabb.size.y = height_range.y + _cull_margin * 2.f;
-	for (int i = 0; i < _mesh_data.trims.size(); i++) {
-		RS->instance_set_custom_aabb(_mesh_data.trims[i], aabb);
+// Shows or hides a clipmap tile per its occlusion. Occluded tiles are hidden from the camera, but keep
+// casting shadows into what it can see, such as a ridge shading the valley behind it.
+void Terrain3D::_apply_tile_occlusion(const Instances &p_instances, const int p_index,
+		const RenderingServer::ShadowCastingSetting p_cast_shadows, const bool p_visible) {
+	const RID rid = p_instances.tiles[p_index];
+	bool occluded = p_instances.tiles_occluded[p_index];
+	bool shadows = p_cast_shadows != RenderingServer::SHADOW_CASTING_SETTING_OFF;
+	RS->instance_set_visible(rid, p_visible && (!occluded || shadows));
+	RS->instance_geometry_set_cast_shadows_setting(rid,
+			(occluded && shadows) ? RenderingServer::SHADOW_CASTING_SETTING_SHADOWS_ONLY : p_cast_shadows);
+}
+
+// Mesh AABBs are fit to the heights under them as they snap. Force all levels to snap again.
+void Terrain3D::update_aabbs() {
+	if (_mesh_data.mesh_set.meshes.is_empty() || _data == nullptr) {
+		LOG(DEBUG, "Update AABB called before terrain meshes built. Returning.");
+		return;
 	}
+	LOG(EXTREME, "Updating AABBs on next snap, extra cull margin: ", _cull_margin);
+	_mesh_data.snapped_cells.clear();
+	_shadow_data.snapped_cells.clear();
+	_occlusion.clear();
+	_camera_last_position = V2_MAX;
+	for (int i = 0; i < _views.size(); i++) {
+		_views.write[i].instances.snapped_cells.clear();
+		_views.write[i].last_position = V2_MAX;
+	}
+}
 
-	aabb = RS->mesh_get_custom_aabb(_meshes[GeoClipMap::SEAM]);
-	aabb.position.y = height_range.x - _cull_margin;
-	aabb.size.y = height_range.y + _cull_margin * 2.f;
-	for (int i = 0; i < _mesh_data.seams.size(); i++) {
-		RS->instance_set_custom_aabb(_mesh_data.seams[i], aabb);
+// Connected to Terrain3DData::maps_edited. Refits only the mesh AABBs and occlusion cells over the
+// edited area, as it's called for every brush stroke.
+void Terrain3D::_update_aabbs_area(const AABB &p_area) {
+	if (_mesh_data.mesh_set.meshes.is_empty() || _data == nullptr) {
+		return;
+	}
+	// Heights change the quads on either side of a pixel
+	Rect2 area = Rect2(p_area.position.x, p_area.position.z, p_area.size.x, p_area.size.z).grow(_vertex_spacing);
+	int rs_calls = _refit_instances(_mesh_data, area);
+	if (_shadow_data.cross.is_valid()) {
+		rs_calls += _refit_instances(_shadow_data, area);
 	}
+	for (int i = 0; i < _views.size(); i++) {
+		rs_calls += _refit_instances(_views.write[i].instances, area);
+	}
+	_occlusion.update_area(area);
+	LOG(EXTREME, "Refit AABBs over: ", area, ", RenderingServer calls: ", rs_calls);
 }
 
 /* Returns the point a ray intersects the ground using either raymarching or the GPU depth texture
@@ -1164,23 +1472,30 @@ void Terrain3D::update_aabbs() {
  * Returns Vec3(NAN) on error or vec3(3.402823466e+38F) on no intersection. Test w/ if (var.x < 3.4e38)
  */
 Vector3 Terrain3D::get_intersection(const Vector3 &p_src_pos, const Vector3 &p_direction, const bool p_gpu_mode) {
-	if (!is_instance_valid(_camera_instance_id)) {
-		LOG(ERROR, "Invalid camera");
-		return Vector3(NAN, NAN, NAN);
-	}
-	if (_mouse_cam == nullptr) {
-		LOG(ERROR, "Invalid mouse camera");
-		return Vector3(NAN, NAN, NAN);
+	if (p_gpu_mode) {
+		if (!is_instance_valid(_camera_instance_id)) {
+			LOG(ERROR, "Invalid camera");
+			return Vector3(NAN, NAN, NAN);
+		}
+		if (_mouse_cam == nullptr) {
+			LOG(ERROR, "Invalid mouse camera");
+			return Vector3(NAN, NAN, NAN);
+		}
 	}
 	Vector3 direction = p_direction.normalized();
 	Vector3 point;
 
-	// Position mouse cam one unit behind the requested position
-	_mouse_cam->set_global_position(p_src_pos - direction);
+	// Position mouse cam one unit behind the requested position. CPU mode doesn't need it,
+	// so works without a camera, such as in headless builds
+	if (_mouse_cam != nullptr) {
+		_mouse_cam->set_global_position(p_src_pos - direction);
+	}
 
 	// If looking straight down (eg orthogonal camera), just return height. look_at won't work
 	if ((direction - Vector3(0.f, -1.f, 0.f)).length_squared() < 0.00001f) {
-		_mouse_cam->set_rotation_degrees(Vector3(-90.f, 0.f, 0.f));
+		if (_mouse_cam != nullptr) {
+			_mouse_cam->set_rotation_degrees(Vector3(-90.f, 0.f, 0.f));
+		}
 		point = p_src_pos;
 		point.y = _data->get_height(p_src_pos);
 		if (std::isnan(point.y)) {
@@ -1188,14 +1503,11 @@ Vector3 Terrain3D::get_intersection(const Vector3 &p_src_pos, const Vector3 &p_d
 		}
 
 	} else if (!p_gpu_mode) {
-		// Else if not gpu mode, use raymarching mode
-		point = p_src_pos;
-		for (int i = 0; i < 4000; i++) {
-			real_t height = _data->get_height(point);
-			if (point.y - height <= 0) {
-				return point;
-			}
-			point += direction;
+		// Else if not gpu mode, trace the height pyramid
+		_data->update_height_mips();
+		real_t distance;
+		if (_data->intersect_ray(p_src_pos, direction, FLT_MAX, distance)) {
+			return p_src_pos + direction * distance;
 		}
 		return V3_MAX;
 
@@ -1239,6 +1551,52 @@ Vector3 Terrain3D::get_intersection(const Vector3 &p_src_pos, const Vector3 &p_d
 	return point;
 }
 
+/**
+ * Casts many rays against the terrain on the CPU, the same as get_intersection() without gpu_mode.
+ * Rays are split into groups spread across the WorkerThreadPool. It needs no camera or viewport.
+ * p_max_distances may be empty for unlimited distance, or hold one distance per ray.
+ * Returns [ PackedVector3Array positions, PackedVector3Array normals, PackedFloat32Array distances ].
+ * Misses return V3_MAX, V3_ZERO, and -1 respectively.
+ */
+Array Terrain3D::intersect_rays(const PackedVector3Array &p_origins, const PackedVector3Array &p_directions,
+		const PackedFloat32Array &p_max_distances) {
+	int count = p_origins.size();
+	if (p_directions.size() != count || (!p_max_distances.is_empty() && p_max_distances.size() != count)) {
+		LOG(ERROR, "Origins, directions and max_distances must have the same size, or max_distances be empty");
+		return Array();
+	}
+	PackedVector3Array positions;
+	PackedVector3Array normals;
+	PackedFloat32Array distances;
+	positions.resize(count);
+	normals.resize(count);
+	distances.resize(count);
+	if (count == 0 || _data == nullptr) {
+		return Array::make(positions, normals, distances);
+	}
+
+	// Workers only read the maps, so bring the height pyramids up to date here
+	_data->update_height_mips();
+	RayBatch batch;
+	batch.data = _data;
+	batch.origins = p_origins.ptr();
+	batch.directions = p_directions.ptr();
+	batch.max_distances = p_max_distances.is_empty() ? nullptr : p_max_distances.ptr();
+	batch.positions = positions.ptrw();
+	batch.normals = normals.ptrw();
+	batch.distances = distances.ptrw();
+	batch.count = count;
+	int groups = (count + RAY_GROUP_SIZE - 1) / RAY_GROUP_SIZE;
+	if (groups == 1) {
+		_intersect_ray_group(&batch, 0);
+	} else {
+		WorkerThreadPool *wtp = WorkerThreadPool::get_singleton();
+		int64_t task_id = wtp->add_native_group_task(&Terrain3D::_intersect_ray_group, &batch, groups, -1, true, "Terrain3D::intersect_rays");
+		wtp->wait_for_group_task_completion(task_id);
+	}
+	return Array::make(positions, normals, distances);
+}
+
 /**
  * Generates a static ArrayMesh for the terrain.
  * p_lod (0-8): Determines the granularity of the generated mesh.
@@ -1325,6 +1683,10 @@ void Terrain3D::_notification(const int p_what) {
 			LOG(INFO, "NOTIFICATION_ENTER_WORLD");
 			_is_inside_world = true;
 			_update_mesh_instances();
+			// Server MMIs kept from a previous world. Nodes follow the tree.
+			if (_instancer != nullptr) {
+				_instancer->_update_scenario(get_world_3d()->get_scenario(), is_visible_in_tree());
+			}
 			break;
 		}
 
@@ -1338,6 +1700,7 @@ void Terrain3D::_notification(const int p_what) {
 			_setup_mouse_picking();
 			_initialize(); // Rebuild anything freed: meshes, collision, instancer
 			set_process(true);
+			set_physics_process(true);
 			break;
 		}
 
@@ -1355,6 +1718,12 @@ void Terrain3D::_notification(const int p_what) {
 			break;
 		}
 
+		case NOTIFICATION_PHYSICS_PROCESS: {
+			// Node is processing one physics frame
+			_collision.update();
+			break;
+		}
+
 		case NOTIFICATION_TRANSFORM_CHANGED: {
 			// Node3D or parent transform changed
 			if (get_transform() != Transform3D()) {
@@ -1418,6 +1787,7 @@ void Terrain3D::_notification(const int p_what) {
 			// Sent on scene changes
 			LOG(INFO, "NOTIFICATION_EXIT_TREE");
 			set_process(false);
+			set_physics_process(false);
 			_clear_meshes();
 			_destroy_mouse_picking();
 			break;
@@ -1428,6 +1798,10 @@ void Terrain3D::_notification(const int p_what) {
 			// Sent on scene changes
 			LOG(INFO, "NOTIFICATION_EXIT_WORLD");
 			_is_inside_world = false;
+			// Take server MMIs out of the world, as MMI nodes leave it with the tree
+			if (_instancer != nullptr) {
+				_instancer->_update_scenario(RID(), false);
+			}
 			break;
 		}
 
@@ -1436,6 +1810,7 @@ void Terrain3D::_notification(const int p_what) {
 			LOG(INFO, "NOTIFICATION_PREDELETE");
 			_destroy_collision();
 			_destroy_instancer();
+			_clear_mesh_cache();
 			_destroy_labels();
 			_destroy_containers();
 			memdelete_safely(_data);
@@ -1457,6 +1832,11 @@ void Terrain3D::_bind_methods() {
 
 	BIND_ENUM_CONSTANT(FULL_GAME);
 	BIND_ENUM_CONSTANT(FULL_EDITOR);
+	BIND_ENUM_CONSTANT(DYNAMIC_GAME);
+	BIND_ENUM_CONSTANT(DYNAMIC_EDITOR);
+
+	BIND_ENUM_CONSTANT(INSTANCER_NODES);
+	BIND_ENUM_CONSTANT(INSTANCER_SERVER);
 
 	ClassDB::bind_method(D_METHOD("get_version"), &Terrain3D::get_version);
 	ClassDB::bind_method(D_METHOD("set_debug_level", "level"), &Terrain3D::set_debug_level);
@@ -1477,12 +1857,19 @@ void Terrain3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_plugin"), &Terrain3D::get_plugin);
 	ClassDB::bind_method(D_METHOD("set_camera", "camera"), &Terrain3D::set_camera);
 	ClassDB::bind_method(D_METHOD("get_camera"), &Terrain3D::get_camera);
+	ClassDB::bind_method(D_METHOD("add_camera", "camera", "layers"), &Terrain3D::add_camera);
+	ClassDB::bind_method(D_METHOD("remove_camera", "camera"), &Terrain3D::remove_camera);
+	ClassDB::bind_method(D_METHOD("get_cameras"), &Terrain3D::get_cameras);
 
 	//Regions
 	ClassDB::bind_method(D_METHOD("change_region_size", "size"), &Terrain3D::change_region_size);
 	ClassDB::bind_method(D_METHOD("get_region_size"), &Terrain3D::get_region_size);
 	ClassDB::bind_method(D_METHOD("set_save_16_bit", "enabled"), &Terrain3D::set_save_16_bit);
 	ClassDB::bind_method(D_METHOD("get_save_16_bit"), &Terrain3D::get_save_16_bit);
+	ClassDB::bind_method(D_METHOD("set_texture_streaming", "enabled"), &Terrain3D::set_texture_streaming);
+	ClassDB::bind_method(D_METHOD("get_texture_streaming"), &Terrain3D::get_texture_streaming);
+	ClassDB::bind_method(D_METHOD("set_texture_streaming_radius", "radius"), &Terrain3D::set_texture_streaming_radius);
+	ClassDB::bind_method(D_METHOD("get_texture_streaming_radius"), &Terrain3D::get_texture_streaming_radius);
 	ClassDB::bind_method(D_METHOD("set_label_distance", "distance"), &Terrain3D::set_label_distance);
 	ClassDB::bind_method(D_METHOD("get_label_distance"), &Terrain3D::get_label_distance);
 	ClassDB::bind_method(D_METHOD("set_label_size", "size"), &Terrain3D::set_label_size);
@@ -1499,7 +1886,17 @@ void Terrain3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_collision_mask"), &Terrain3D::get_collision_mask);
 	ClassDB::bind_method(D_METHOD("set_collision_priority", "priority"), &Terrain3D::set_collision_priority);
 	ClassDB::bind_method(D_METHOD("get_collision_priority"), &Terrain3D::get_collision_priority);
+	ClassDB::bind_method(D_METHOD("set_collision_shape_size", "size"), &Terrain3D::set_collision_shape_size);
+	ClassDB::bind_method(D_METHOD("get_collision_shape_size"), &Terrain3D::get_collision_shape_size);
+	ClassDB::bind_method(D_METHOD("set_collision_radius", "radius"), &Terrain3D::set_collision_radius);
+	ClassDB::bind_method(D_METHOD("get_collision_radius"), &Terrain3D::get_collision_radius);
+	ClassDB::bind_method(D_METHOD("set_collision_lod_distances", "distances"), &Terrain3D::set_collision_lod_distances);
+	ClassDB::bind_method(D_METHOD("get_collision_lod_distances"), &Terrain3D::get_collision_lod_distances);
 	ClassDB::bind_method(D_METHOD("get_collision_rid"), &Terrain3D::get_collision_rid);
+	ClassDB::bind_method(D_METHOD("add_collision_target", "node"), &Terrain3D::add_collision_target);
+	ClassDB::bind_method(D_METHOD("remove_collision_target", "node"), &Terrain3D::remove_collision_target);
+	ClassDB::bind_method(D_METHOD("update_collision"), &Terrain3D::update_collision);
+	ClassDB::bind_method(D_METHOD("get_collision_targets"), &Terrain3D::get_collision_targets);
 
 	// Meshes
 	ClassDB::bind_method(D_METHOD("set_mesh_lods", "count"), &Terrain3D::set_mesh_lods);
@@ -1516,10 +1913,26 @@ void Terrain3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_mouse_layer"), &Terrain3D::get_mouse_layer);
 	ClassDB::bind_method(D_METHOD("set_cast_shadows", "shadow_casting_setting"), &Terrain3D::set_cast_shadows);
 	ClassDB::bind_method(D_METHOD("get_cast_shadows"), &Terrain3D::get_cast_shadows);
+	ClassDB::bind_method(D_METHOD("set_shadow_clipmap_enabled", "enabled"), &Terrain3D::set_shadow_clipmap_enabled);
+	ClassDB::bind_method(D_METHOD("get_shadow_clipmap_enabled"), &Terrain3D::get_shadow_clipmap_enabled);
+	ClassDB::bind_method(D_METHOD("set_shadow_lod_bias", "bias"), &Terrain3D::set_shadow_lod_bias);
+	ClassDB::bind_method(D_METHOD("get_shadow_lod_bias"), &Terrain3D::get_shadow_lod_bias);
+	ClassDB::bind_method(D_METHOD("set_shadow_mesh_size", "size"), &Terrain3D::set_shadow_mesh_size);
+	ClassDB::bind_method(D_METHOD("get_shadow_mesh_size"), &Terrain3D::get_shadow_mesh_size);
 	ClassDB::bind_method(D_METHOD("set_gi_mode", "gi_mode"), &Terrain3D::set_gi_mode);
 	ClassDB::bind_method(D_METHOD("get_gi_mode"), &Terrain3D::get_gi_mode);
 	ClassDB::bind_method(D_METHOD("set_cull_margin", "margin"), &Terrain3D::set_cull_margin);
 	ClassDB::bind_method(D_METHOD("get_cull_margin"), &Terrain3D::get_cull_margin);
+	ClassDB::bind_method(D_METHOD("set_height_pyramids", "enabled"), &Terrain3D::set_height_pyramids);
+	ClassDB::bind_method(D_METHOD("get_height_pyramids"), &Terrain3D::get_height_pyramids);
+	ClassDB::bind_method(D_METHOD("set_occlusion_culling", "enabled"), &Terrain3D::set_occlusion_culling);
+	ClassDB::bind_method(D_METHOD("get_occlusion_culling"), &Terrain3D::get_occlusion_culling);
+	ClassDB::bind_method(D_METHOD("set_instancer_mode", "mode"), &Terrain3D::set_instancer_mode);
+	ClassDB::bind_method(D_METHOD("get_instancer_mode"), &Terrain3D::get_instancer_mode);
+	ClassDB::bind_method(D_METHOD("set_instancer_streaming", "enabled"), &Terrain3D::set_instancer_streaming);
+	ClassDB::bind_method(D_METHOD("get_instancer_streaming"), &Terrain3D::get_instancer_streaming);
+	ClassDB::bind_method(D_METHOD("set_instancer_streaming_budget", "milliseconds"), &Terrain3D::set_instancer_streaming_budget);
+	ClassDB::bind_method(D_METHOD("get_instancer_streaming_budget"), &Terrain3D::get_instancer_streaming_budget);
 	ClassDB::bind_method(D_METHOD("is_compatibility_mode"), &Terrain3D::is_compatibility_mode);
 
 	// Debug Views
@@ -1558,8 +1971,14 @@ void Terrain3D::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_show_vertex_grid", "enabled"), &Terrain3D::set_show_vertex_grid);
 	ClassDB::bind_method(D_METHOD("get_show_vertex_grid"), &Terrain3D::get_show_vertex_grid);
 
+	// Processing
+	ClassDB::bind_method(D_METHOD("get_snap_rs_calls"), &Terrain3D::get_snap_rs_calls);
+	ClassDB::bind_method(D_METHOD("get_occluded_tile_count"), &Terrain3D::get_occluded_tile_count);
+	ClassDB::bind_method(D_METHOD("get_occluded_mmi_count"), &Terrain3D::get_occluded_mmi_count);
+
 	// Utility
 	ClassDB::bind_method(D_METHOD("get_intersection", "src_pos", "direction", "gpu_mode"), &Terrain3D::get_intersection, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("intersect_rays", "origins", "directions", "max_distances"), &Terrain3D::intersect_rays, DEFVAL(PackedFloat32Array()));
 	ClassDB::bind_method(D_METHOD("bake_mesh", "lod", "filter"), &Terrain3D::bake_mesh);
 	ClassDB::bind_method(D_METHOD("generate_nav_mesh_source_geometry", "global_aabb", "require_nav"), &Terrain3D::generate_nav_mesh_source_geometry, DEFVAL(true));
 
@@ -1576,16 +1995,21 @@ void Terrain3D::_bind_methods() {
 	ADD_GROUP("Regions", "");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "region_size", PROPERTY_HINT_ENUM, "64:64,128:128,256:256,512:512,1024:1024,2048:2048", PROPERTY_USAGE_EDITOR), "change_region_size", "get_region_size");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "save_16_bit"), "set_save_16_bit", "get_save_16_bit");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "texture_streaming"), "set_texture_streaming", "get_texture_streaming");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "texture_streaming_radius", PROPERTY_HINT_RANGE, "1,7,1"), "set_texture_streaming_radius", "get_texture_streaming_radius");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "label_distance", PROPERTY_HINT_RANGE, "0.0,10000.0,0.5,or_greater"), "set_label_distance", "get_label_distance");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "label_size", PROPERTY_HINT_RANGE, "24,128,1"), "set_label_size", "get_label_size");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "show_grid"), "set_show_region_grid", "get_show_region_grid");
 
 	ADD_GROUP("Collision", "");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "collision_enabled"), "set_collision_enabled", "get_collision_enabled");
-	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_mode", PROPERTY_HINT_ENUM, "Full / Game,Full / Editor"), "set_collision_mode", "get_collision_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_mode", PROPERTY_HINT_ENUM, "Full / Game,Full / Editor,Dynamic / Game,Dynamic / Editor"), "set_collision_mode", "get_collision_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_layer", PROPERTY_HINT_LAYERS_3D_PHYSICS), "set_collision_layer", "get_collision_layer");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_mask", PROPERTY_HINT_LAYERS_3D_PHYSICS), "set_collision_mask", "get_collision_mask");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "collision_priority"), "set_collision_priority", "get_collision_priority");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_shape_size", PROPERTY_HINT_ENUM, "32:32,64:64,128:128,256:256,512:512"), "set_collision_shape_size", "get_collision_shape_size");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "collision_radius", PROPERTY_HINT_RANGE, "0.0,1024.0,1.0,or_greater"), "set_collision_radius", "get_collision_radius");
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "collision_lod_distances"), "set_collision_lod_distances", "get_collision_lod_distances");
 
 	ADD_GROUP("Mesh", "");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "mesh_lods", PROPERTY_HINT_RANGE, "1,10,1"), "set_mesh_lods", "get_mesh_lods");
@@ -1596,8 +2020,16 @@ void Terrain3D::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "render_layers", PROPERTY_HINT_LAYERS_3D_RENDER), "set_render_layers", "get_render_layers");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "mouse_layer", PROPERTY_HINT_RANGE, "21, 32"), "set_mouse_layer", "get_mouse_layer");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "cast_shadows", PROPERTY_HINT_ENUM, "Off,On,Double-Sided,Shadows Only"), "set_cast_shadows", "get_cast_shadows");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "shadow_clipmap_enabled"), "set_shadow_clipmap_enabled", "get_shadow_clipmap_enabled");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "shadow_lod_bias", PROPERTY_HINT_RANGE, "0,4,1"), "set_shadow_lod_bias", "get_shadow_lod_bias");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "shadow_mesh_size", PROPERTY_HINT_RANGE, "8,64,1"), "set_shadow_mesh_size", "get_shadow_mesh_size");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "gi_mode", PROPERTY_HINT_ENUM, "Disabled,Static,Dynamic"), "set_gi_mode", "get_gi_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "cull_margin", PROPERTY_HINT_RANGE, "0.0,10000.0,.5,or_greater"), "set_cull_margin", "get_cull_margin");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "height_pyramids"), "set_height_pyramids", "get_height_pyramids");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "occlusion_culling"), "set_occlusion_culling", "get_occlusion_culling");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "instancer_mode", PROPERTY_HINT_ENUM, "Nodes,Server"), "set_instancer_mode", "get_instancer_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "instancer_streaming"), "set_instancer_streaming", "get_instancer_streaming");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "instancer_streaming_budget", PROPERTY_HINT_RANGE, "0.0,16.0,0.1,or_greater"), "set_instancer_streaming_budget", "get_instancer_streaming_budget");
 
 	ADD_GROUP("Debug Views", "show_");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "show_checkered", PROPERTY_HINT_NONE), "set_show_checkered", "get_show_checkered");
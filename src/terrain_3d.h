@@ -14,16 +14,19 @@
 
 #include "constants.h"
 #include "terrain_3d_assets.h"
+#include "terrain_3d_collision.h"
 #include "terrain_3d_data.h"
 #include "terrain_3d_editor.h"
 #include "terrain_3d_instancer.h"
 #include "terrain_3d_material.h"
+#include "terrain_3d_occlusion.h"
 
 using namespace godot;
 
 class Terrain3D : public Node3D {
 	GDCLASS(Terrain3D, Node3D);
 	CLASS_NAME();
+	friend class Terrain3DCollision;
 
 public: // Constants
 	enum RegionSize {
@@ -36,10 +39,15 @@ public: // Constants
 	};
 
 	enum CollisionMode {
-		//DYNAMIC_GAME,
-		//DYNAMIC_EDITOR,
 		FULL_GAME,
 		FULL_EDITOR,
+		DYNAMIC_GAME,
+		DYNAMIC_EDITOR,
+	};
+
+	enum InstancerMode {
+		INSTANCER_NODES,
+		INSTANCER_SERVER,
 	};
 
 private:
@@ -66,35 +74,79 @@ private:
 	bool _save_16_bit = false;
 	real_t _label_distance = 0.f;
 	int _label_size = 48;
+	bool _texture_streaming = false;
+	int _texture_streaming_radius = 2;
 
 	// Collision
-	RID _static_body;
-	StaticBody3D *_debug_static_body = nullptr;
+	Terrain3DCollision _collision;
 	bool _collision_enabled = true;
 	CollisionMode _collision_mode = FULL_GAME;
 	uint32_t _collision_layer = 1;
 	uint32_t _collision_mask = 1;
 	real_t _collision_priority = 1.0f;
+	int _collision_shape_size = 64;
+	real_t _collision_radius = 64.f;
+	Vector3 _collision_lod_distances = V3_ZERO;
 
 	// Meshes
 	int _mesh_lods = 7;
 	int _mesh_size = 48;
 	real_t _vertex_spacing = 1.0f;
 
-	Vector<RID> _meshes;
+	// Generated clipmap meshes of one size, indexed by GeoClipMap::MeshType
+	struct MeshSet {
+		int mesh_size = 0;
+		Vector<RID> meshes;
+		Vector<AABB> aabbs; // Custom AABBs of the meshes, with their full height
+	};
+	// Generated meshes by mesh size, most recently used first. Owns the mesh RIDs.
+	static inline const int MESH_CACHE_SIZE = 4;
+	Vector<MeshSet> _mesh_cache;
+	// A clipmap of mesh instances, snapped around a camera
 	struct Instances {
+		MeshSet mesh_set;
+		int lods = 0;
+		int lod_bias = 0; // The finest LOD has quads of 2^lod_bias vertex spacings
 		RID cross;
 		Vector<RID> tiles;
+		Vector<AABB> tile_aabbs; // Global AABBs of the tiles, set as they snap
+		Vector<bool> tiles_occluded; // Tiles hidden by occlusion culling
 		Vector<RID> fillers;
 		Vector<RID> trims;
 		Vector<RID> seams;
+		Vector<Vector2i> snapped_cells; // Grid cell each LOD was last snapped to, to skip unmoved levels
+		Vector3 snapped_position = V3_MAX; // Camera position of the last snap
 	} _mesh_data;
+	Instances _shadow_data; // Coarse shadow only clipmap, see shadow_clipmap_enabled
+	int _snap_rs_calls = 0; // RenderingServer calls made by the last snap()
+
+	// Extra cameras, each with its own instance set sharing the main meshes, eg for split screen
+	struct CameraView {
+		Camera3D *camera = nullptr;
+		uint64_t camera_id = 0;
+		uint32_t layers = 0;
+		RID scenario; // Scenario the instances are in, from the camera's world
+		Vector2 last_position = V2_MAX; // As _camera_last_position
+		Instances instances; // Created on the first _process() with the camera in the tree
+	};
+	Vector<CameraView> _views;
 
 	// Rendering
 	uint32_t _render_layers = 1 | (1 << 31); // Bit 1 and 32 for the cursor
 	RenderingServer::ShadowCastingSetting _cast_shadows = RenderingServer::SHADOW_CASTING_SETTING_ON;
+	bool _shadow_clipmap_enabled = false;
+	int _shadow_lod_bias = 1;
+	int _shadow_mesh_size = 16;
 	GeometryInstance3D::GIMode _gi_mode = GeometryInstance3D::GI_MODE_STATIC;
 	real_t _cull_margin = 0.0f;
+	bool _height_pyramids = true;
+	Terrain3DOcclusion _occlusion;
+	bool _occlusion_culling = false;
+	int _occluded_tiles = 0;
+	int _occluded_mmis = 0;
+	InstancerMode _instancer_mode = INSTANCER_NODES;
+	bool _instancer_streaming = false;
+	real_t _instancer_streaming_budget = 2.f; // Milliseconds per frame
 	bool _compatibility = false;
 
 	// Mouse cursor
@@ -107,6 +159,19 @@ private:
 	Node3D *_label_parent;
 	Node3D *_mmi_parent;
 
+	// Batch raycasts, shared by the worker groups of intersect_rays()
+	static inline const int RAY_GROUP_SIZE = 64;
+	struct RayBatch {
+		const Terrain3DData *data = nullptr;
+		const Vector3 *origins = nullptr;
+		const Vector3 *directions = nullptr;
+		const float *max_distances = nullptr; // Unlimited if null
+		Vector3 *positions = nullptr;
+		Vector3 *normals = nullptr;
+		float *distances = nullptr;
+		int count = 0;
+	};
+
 	void _initialize();
 	void __process(const double p_delta);
 	void _grab_camera();
@@ -117,17 +182,34 @@ private:
 
 	void _destroy_instancer();
 
-	bool _is_collision_editor() const { return _collision_mode == FULL_EDITOR; }
 	void _build_collision();
-	void _update_collision();
+	void _queue_collision_update(const AABB &p_area);
 	void _destroy_collision();
 
+	MeshSet _get_mesh_set(const int p_mesh_size, const int p_mesh_lods);
+	void _clear_mesh_cache();
 	void _build_meshes(const int p_mesh_lods, const int p_mesh_size);
+	void _rebuild_meshes();
+	bool _is_shadow_clipmap_active() const;
+	RenderingServer::ShadowCastingSetting _get_main_cast_shadows() const;
+	void _create_instances(Instances &r_instances, const RID &p_scenario, const uint32_t p_layers,
+			const RenderingServer::ShadowCastingSetting p_cast_shadows);
+	void _update_instances(const Instances &p_instances, const RID &p_scenario, const uint32_t p_layers,
+			const RenderingServer::ShadowCastingSetting p_cast_shadows, const bool p_visible);
+	void _free_instances(Instances &r_instances);
+	int _snap_instances(Instances &r_instances, const Vector3 &p_cam_pos, const Rect2 &p_refit_area = Rect2());
+	int _refit_instances(Instances &r_instances, const Rect2 &p_area);
+	AABB _set_instance_aabb(const RID &p_instance, const AABB &p_mesh_aabb, const Transform3D &p_xform);
+	void _update_occlusion();
+	void _apply_tile_occlusion(const Instances &p_instances, const int p_index,
+			const RenderingServer::ShadowCastingSetting p_cast_shadows, const bool p_visible);
+	void _update_aabbs_area(const AABB &p_area);
 	void _update_mesh_instances();
 	void _clear_meshes();
 
 	void _setup_mouse_picking();
 	void _destroy_mouse_picking();
+	static void _intersect_ray_group(void *p_batch, uint32_t p_group);
 
 	void _generate_triangles(PackedVector3Array &p_vertices, PackedVector2Array *p_uvs, const int32_t p_lod,
 			const Terrain3DData::HeightFilter p_filter, const bool require_nav, const AABB &p_global_aabb) const;
@@ -161,6 +243,9 @@ public:
 	EditorPlugin *get_plugin() const { return _plugin; }
 	void set_camera(Camera3D *p_camera);
 	Camera3D *get_camera() const { return _camera; }
+	void add_camera(Camera3D *p_camera, const uint32_t p_layers);
+	void remove_camera(Camera3D *p_camera);
+	TypedArray<Camera3D> get_cameras() const;
 
 	// Regions
 	void set_region_size(const RegionSize p_size);
@@ -173,6 +258,10 @@ public:
 	void set_label_size(const int p_size);
 	int get_label_size() const { return _label_size; }
 	void update_region_labels();
+	void set_texture_streaming(const bool p_enabled);
+	bool get_texture_streaming() const { return _texture_streaming; }
+	void set_texture_streaming_radius(const int p_radius);
+	int get_texture_streaming_radius() const { return _texture_streaming_radius; }
 
 	// Collision
 	void set_collision_enabled(const bool p_enabled);
@@ -185,7 +274,17 @@ public:
 	uint32_t get_collision_mask() const { return _collision_mask; };
 	void set_collision_priority(const real_t p_priority);
 	real_t get_collision_priority() const { return _collision_priority; }
-	RID get_collision_rid() const;
+	void set_collision_shape_size(const int p_size);
+	int get_collision_shape_size() const { return _collision_shape_size; }
+	void set_collision_radius(const real_t p_radius);
+	real_t get_collision_radius() const { return _collision_radius; }
+	void set_collision_lod_distances(const Vector3 &p_distances);
+	Vector3 get_collision_lod_distances() const { return _collision_lod_distances; }
+	RID get_collision_rid() const { return _collision.get_rid(); }
+	void add_collision_target(Node3D *p_node);
+	void remove_collision_target(Node3D *p_node);
+	TypedArray<Node3D> get_collision_targets() const { return _collision.get_targets(); }
+	void update_collision();
 
 	// Meshes
 	void set_mesh_lods(const int p_count);
@@ -202,10 +301,26 @@ public:
 	uint32_t get_mouse_layer() const { return _mouse_layer; };
 	void set_cast_shadows(const RenderingServer::ShadowCastingSetting p_cast_shadows);
 	RenderingServer::ShadowCastingSetting get_cast_shadows() const { return _cast_shadows; };
+	void set_shadow_clipmap_enabled(const bool p_enabled);
+	bool get_shadow_clipmap_enabled() const { return _shadow_clipmap_enabled; }
+	void set_shadow_lod_bias(const int p_bias);
+	int get_shadow_lod_bias() const { return _shadow_lod_bias; }
+	void set_shadow_mesh_size(const int p_size);
+	int get_shadow_mesh_size() const { return _shadow_mesh_size; }
 	void set_gi_mode(const GeometryInstance3D::GIMode p_gi_mode);
 	GeometryInstance3D::GIMode get_gi_mode() const { return _gi_mode; }
 	void set_cull_margin(const real_t p_margin);
 	real_t get_cull_margin() const { return _cull_margin; };
+	void set_height_pyramids(const bool p_enabled);
+	bool get_height_pyramids() const { return _height_pyramids; }
+	void set_occlusion_culling(const bool p_enabled);
+	bool get_occlusion_culling() const { return _occlusion_culling; }
+	void set_instancer_mode(const InstancerMode p_mode);
+	InstancerMode get_instancer_mode() const { return _instancer_mode; }
+	void set_instancer_streaming(const bool p_enabled);
+	bool get_instancer_streaming() const { return _instancer_streaming; }
+	void set_instancer_streaming_budget(const real_t p_budget);
+	real_t get_instancer_streaming_budget() const { return _instancer_streaming_budget; }
 	bool is_compatibility_mode() const { return _compatibility; };
 
 	// Debug Views
@@ -246,10 +361,15 @@ public:
 
 	// Processing
 	void snap(const Vector3 &p_cam_pos);
+	int get_snap_rs_calls() const { return _snap_rs_calls; }
+	int get_occluded_tile_count() const { return _occluded_tiles; }
+	int get_occluded_mmi_count() const { return _occluded_mmis; }
 	void update_aabbs();
 
 	// Utility
 	Vector3 get_intersection(const Vector3 &p_src_pos, const Vector3 &p_direction, const bool p_gpu_mode = false);
+	Array intersect_rays(const PackedVector3Array &p_origins, const PackedVector3Array &p_directions,
+			const PackedFloat32Array &p_max_distances = PackedFloat32Array());
 	Ref<Mesh> bake_mesh(const int p_lod, const Terrain3DData::HeightFilter p_filter = Terrain3DData::HEIGHT_FILTER_NEAREST) const;
 	PackedVector3Array generate_nav_mesh_source_geometry(const AABB &p_global_aabb, const bool p_require_nav = true) const;
 
@@ -263,5 +383,6 @@ protected:
 
 VARIANT_ENUM_CAST(Terrain3D::RegionSize);
 VARIANT_ENUM_CAST(Terrain3D::CollisionMode);
+VARIANT_ENUM_CAST(Terrain3D::InstancerMode);
 
 #endif // TERRAIN3D_CLASS_H
@@ -0,0 +1,660 @@
+// Copyright © 2025 Cory Petkovsek, Roope Palmroos, and Contributors.
+
+#include <godot_cpp/classes/collision_shape3d.hpp>
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/height_map_shape3d.hpp>
+#include <godot_cpp/classes/physics_server3d.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/classes/world3d.hpp>
+
+#include "logger.h"
+#include "terrain_3d.h"
+#include "terrain_3d_collision.h"
+#include "terrain_3d_util.h"
+
+///////////////////////////
+// Private Functions
+///////////////////////////
+
+bool Terrain3DCollision::_is_editor_mode() const {
+	Terrain3D::CollisionMode mode = _terrain->get_collision_mode();
+	return mode == Terrain3D::FULL_EDITOR || mode == Terrain3D::DYNAMIC_EDITOR;
+}
+
+bool Terrain3DCollision::_is_dynamic_mode() const {
+	Terrain3D::CollisionMode mode = _terrain->get_collision_mode();
+	return mode == Terrain3D::DYNAMIC_GAME || mode == Terrain3D::DYNAMIC_EDITOR;
+}
+
+void Terrain3DCollision::_create_body() {
+	if (!_is_editor_mode()) {
+		LOG(INFO, "Building collision with physics server");
+		_static_body = PhysicsServer3D::get_singleton()->body_create();
+		PhysicsServer3D::get_singleton()->body_set_mode(_static_body, PhysicsServer3D::BODY_MODE_STATIC);
+		PhysicsServer3D::get_singleton()->body_attach_object_instance_id(_static_body, _terrain->get_instance_id());
+	} else {
+		LOG(WARN, "Building editor collision. Disable this mode for releases");
+		_debug_static_body = memnew(StaticBody3D);
+		_debug_static_body->set_name("StaticBody3D");
+		_debug_static_body->set_as_top_level(true);
+		_terrain->add_child(_debug_static_body, true);
+	}
+	update_settings();
+}
+
+// Adds an empty shape to the body and returns its index. Set it with _set_shape() before use.
+int Terrain3DCollision::_create_shape() {
+	if (!_is_editor_mode()) {
+		RID shape = PhysicsServer3D::get_singleton()->heightmap_shape_create();
+		int index = PhysicsServer3D::get_singleton()->body_get_shape_count(_static_body);
+		PhysicsServer3D::get_singleton()->body_add_shape(_static_body, shape);
+		return index;
+	} else {
+		CollisionShape3D *debug_col_shape = memnew(CollisionShape3D);
+		debug_col_shape->set_name("CollisionShape3D");
+		_debug_static_body->add_child(debug_col_shape, true);
+		debug_col_shape->set_owner(_debug_static_body);
+		Ref<HeightMapShape3D> hshape;
+		hshape.instantiate();
+		debug_col_shape->set_shape(hshape);
+		return debug_col_shape->get_index();
+	}
+}
+
+// Uploads the heights and places the shape over its pixels
+void Terrain3DCollision::_set_shape(const int p_index, const ShapeJob &p_job) {
+	int step = 1 << p_job.lod;
+	int shape_size = p_job.quads / step + 1;
+	real_t vertex_spacing = _terrain->get_vertex_spacing();
+	Vector3 global_pos = Vector3(p_job.global_pixel.x, 0.f, p_job.global_pixel.y);
+
+	// Non rotated shape for normal array index
+	//Transform3D xform = Transform3D(Basis(), global_pos);
+	// Rotated shape Y=90 for -90 rotated array index, see _generate_heights()
+	// The origin is in LOD vertices, so scaling by the LOD vertex spacing lands it in world units
+	Transform3D xform = Transform3D(Basis(Vector3(0.f, 1.f, 0.f), Math_PI * .5f),
+			(global_pos + Vector3(p_job.quads, 0.f, p_job.quads) * .5f) / real_t(step));
+	xform.scale(Vector3(vertex_spacing * step, 1.f, vertex_spacing * step));
+
+	if (!_is_editor_mode()) {
+		RID shape = PhysicsServer3D::get_singleton()->body_get_shape(_static_body, p_index);
+		Dictionary shape_data;
+		shape_data["width"] = shape_size;
+		shape_data["depth"] = shape_size;
+		shape_data["heights"] = p_job.heights;
+		shape_data["min_height"] = p_job.height_range.x;
+		shape_data["max_height"] = p_job.height_range.y;
+		PhysicsServer3D::get_singleton()->shape_set_data(shape, shape_data);
+		PhysicsServer3D::get_singleton()->body_set_shape_transform(_static_body, p_index, xform);
+	} else {
+		CollisionShape3D *debug_col_shape = Object::cast_to<CollisionShape3D>(_debug_static_body->get_child(p_index));
+		Ref<HeightMapShape3D> hshape = debug_col_shape->get_shape();
+		hshape->set_map_width(shape_size);
+		hshape->set_map_depth(shape_size);
+		hshape->set_map_data(p_job.heights);
+		debug_col_shape->set_global_transform(xform);
+	}
+}
+
+void Terrain3DCollision::_set_shape_enabled(const int p_index, const bool p_enabled) {
+	if (!_is_editor_mode()) {
+		PhysicsServer3D::get_singleton()->body_set_shape_disabled(_static_body, p_index, !p_enabled);
+	} else {
+		CollisionShape3D *debug_col_shape = Object::cast_to<CollisionShape3D>(_debug_static_body->get_child(p_index));
+		debug_col_shape->set_disabled(!p_enabled);
+		debug_col_shape->set_visible(p_enabled);
+	}
+}
+
+// Fills r_heights with the heightmap shape data of p_quads x p_quads quads from p_global_pixel,
+// which must lie within one region. The last row and column are stitched from this region or the
+// neighbors in +X, +Z and +XZ, or are 0 without one. Holes are NAN. Returns the min/max height.
+// Only reads the map buffers, so can run on worker threads.
+Vector2 Terrain3DCollision::_generate_heights(const Vector2i &p_global_pixel, const int p_quads, real_t *r_heights) const {
+	const Terrain3DData *data = _terrain->get_data();
+	int region_size = _terrain->get_region_size();
+	int shape_size = p_quads + 1;
+	Vector2i region_loc = V2I_DIVIDE_FLOOR(p_global_pixel, region_size);
+	const Terrain3DRegion *region = data->_get_region_ptr(region_loc);
+	if (region == nullptr) {
+		memset(r_heights, 0, sizeof(real_t) * shape_size * shape_size);
+		return V2_ZERO;
+	}
+	const float *map = reinterpret_cast<const float *>(region->get_map_ptr(TYPE_HEIGHT)->ptr());
+	const uint32_t *cmap = reinterpret_cast<const uint32_t *>(region->get_map_ptr(TYPE_CONTROL)->ptr());
+	Vector2i local = p_global_pixel - region_loc * region_size;
+	real_t min_height = FLT_MAX;
+	real_t max_height = -FLT_MAX;
+
+	// Choose array indexing to match triangulation of heightmapshape with the mesh
+	// https://stackoverflow.com/questions/16684856/rotating-a-2d-pixel-array-by-90-degrees
+	// Normal array index rotated Y=0 - shape rotation Y=0 (xform in _set_shape)
+	// int index = z * shape_size + x;
+	// Array Index Rotated Y=-90 - must rotate shape Y=+90 (xform in _set_shape)
+	// int index = shape_size - 1 - z + x * shape_size;
+	// Map rows become shape columns, so the interior is transposed in blocks that keep both the
+	// reads and the strided writes in cache. The control bits of each block are OR'd while copying,
+	// and the hole mask is only applied to blocks that have any.
+	for (int bz = 0; bz < p_quads; bz += KERNEL_BLOCK) {
+		int bz_end = MIN(bz + KERNEL_BLOCK, p_quads);
+		for (int bx = 0; bx < p_quads; bx += KERNEL_BLOCK) {
+			int bx_end = MIN(bx + KERNEL_BLOCK, p_quads);
+			uint32_t control = 0;
+			real_t block_min = FLT_MAX;
+			real_t block_max = -FLT_MAX;
+			for (int z = bz; z < bz_end; z++) {
+				int row = (local.y + z) * region_size + local.x;
+				const float *src = map + row;
+				const uint32_t *csrc = cmap + row;
+				real_t *dst = r_heights + shape_size - 1 - z;
+				for (int x = bx; x < bx_end; x++) {
+					real_t height = src[x];
+					dst[x * shape_size] = height;
+					block_min = MIN(block_min, height);
+					block_max = MAX(block_max, height);
+					control |= csrc[x];
+				}
+			}
+			if (is_hole(control)) {
+				block_min = FLT_MAX;
+				block_max = -FLT_MAX;
+				for (int z = bz; z < bz_end; z++) {
+					int row = (local.y + z) * region_size + local.x;
+					const float *src = map + row;
+					const uint32_t *csrc = cmap + row;
+					real_t *dst = r_heights + shape_size - 1 - z;
+					for (int x = bx; x < bx_end; x++) {
+						if (is_hole(csrc[x])) {
+							dst[x * shape_size] = NAN;
+						} else {
+							block_min = MIN(block_min, src[x]);
+							block_max = MAX(block_max, src[x]);
+						}
+					}
+				}
+			}
+			min_height = MIN(min_height, block_min);
+			max_height = MAX(max_height, block_max);
+		}
+	}
+
+	// Stitch the last column and row. They are in this region unless the shape reaches its edge.
+	Vector2i edge = local + Vector2i(p_quads, p_quads);
+	Vector2i offset = Vector2i(edge.x >= region_size ? 1 : 0, edge.y >= region_size ? 1 : 0);
+	edge -= offset * region_size;
+	auto stitch = [&](const Vector2i &p_offset, const Vector2i &p_pixel, const Vector2i &p_step, const int p_count,
+						  const int p_index, const int p_index_step) {
+		const Terrain3DRegion *edge_region = (p_offset == V2I_ZERO) ? region : data->_get_region_ptr(region_loc + p_offset);
+		if (edge_region == nullptr) {
+			for (int i = 0; i < p_count; i++) {
+				r_heights[p_index + i * p_index_step] = 0.f; // No neighbor
+			}
+			return;
+		}
+		const float *edge_map = reinterpret_cast<const float *>(edge_region->get_map_ptr(TYPE_HEIGHT)->ptr());
+		const uint32_t *edge_cmap = reinterpret_cast<const uint32_t *>(edge_region->get_map_ptr(TYPE_CONTROL)->ptr());
+		for (int i = 0; i < p_count; i++) {
+			int pixel = (p_pixel.y + p_step.y * i) * region_size + p_pixel.x + p_step.x * i;
+			if (is_hole(edge_cmap[pixel])) {
+				r_heights[p_index + i * p_index_step] = NAN;
+			} else {
+				real_t height = edge_map[pixel];
+				r_heights[p_index + i * p_index_step] = height;
+				min_height = MIN(min_height, height);
+				max_height = MAX(max_height, height);
+			}
+		}
+	};
+	// Column x = p_quads, z = 0..p_quads-1
+	stitch(Vector2i(offset.x, 0), Vector2i(edge.x, local.y), Vector2i(0, 1), p_quads, shape_size - 1 + p_quads * shape_size, -1);
+	// Row z = p_quads, x = 0..p_quads-1
+	stitch(Vector2i(0, offset.y), Vector2i(local.x, edge.y), Vector2i(1, 0), p_quads, 0, shape_size);
+	// Corner x = z = p_quads
+	stitch(offset, edge, V2I_ZERO, 1, p_quads * shape_size, 0);
+
+	return (min_height <= max_height) ? Vector2(min_height, max_height) : V2_ZERO;
+}
+
+// Reduces shape heights from p_size to (p_size - 1) / p_step + 1 vertices per side. Each vertex takes
+// the max of the source vertices within p_step of it, so the coarse surface is never below the
+// full resolution one and nothing falls through. Holes stay holes. Works on either array rotation.
+void Terrain3DCollision::_downsample_heights(const real_t *p_heights, const int p_size, const int p_step, real_t *r_heights) {
+	int lod_size = (p_size - 1) / p_step + 1;
+	// Max along rows, then along columns
+	PackedRealArray row_max;
+	row_max.resize(p_size * lod_size);
+	real_t *rows = row_max.ptrw();
+	for (int r = 0; r < p_size; r++) {
+		const real_t *src = p_heights + r * p_size;
+		for (int j = 0; j < lod_size; j++) {
+			int center = j * p_step;
+			real_t height = -FLT_MAX;
+			for (int k = MAX(0, center - p_step); k <= MIN(p_size - 1, center + p_step); k++) {
+				if (!std::isnan(src[k])) {
+					height = MAX(height, src[k]);
+				}
+			}
+			rows[r * lod_size + j] = height;
+		}
+	}
+	for (int i = 0; i < lod_size; i++) {
+		int center = i * p_step;
+		for (int j = 0; j < lod_size; j++) {
+			real_t height = -FLT_MAX;
+			for (int k = MAX(0, center - p_step); k <= MIN(p_size - 1, center + p_step); k++) {
+				height = MAX(height, rows[k * lod_size + j]);
+			}
+			r_heights[i * lod_size + j] = std::isnan(p_heights[center * p_size + j * p_step]) ? NAN : height;
+		}
+	}
+}
+
+// Returns the collision LOD for an area, from its distance to the nearest target
+int Terrain3DCollision::_get_lod(const Rect2 &p_rect) const {
+	Vector3 distances = _terrain->get_collision_lod_distances();
+	if (_target_positions.is_empty() || distances == V3_ZERO) {
+		return 0;
+	}
+	real_t distance = FLT_MAX;
+	for (int i = 0; i < _target_positions.size(); i++) {
+		Vector2 pos = _target_positions[i];
+		Vector2 gap = Vector2(MAX(0.f, MAX(p_rect.position.x - pos.x, pos.x - p_rect.get_end().x)),
+				MAX(0.f, MAX(p_rect.position.y - pos.y, pos.y - p_rect.get_end().y)));
+		distance = MIN(distance, gap.length());
+	}
+	int lod = 0;
+	for (int i = 0; i < 3; i++) {
+		if (distances[i] > 0.f && distance >= distances[i]) {
+			lod = i + 1;
+		}
+	}
+	return lod;
+}
+
+// Updates the target positions, falling back to the camera, and the tiles they're on.
+// Returns true if any target moved to another tile.
+bool Terrain3DCollision::_update_targets() {
+	real_t tile_width = real_t(_tile_size) * _terrain->get_vertex_spacing();
+	_target_positions.clear();
+	for (int i = _targets.size() - 1; i >= 0; i--) {
+		Node3D *node = Object::cast_to<Node3D>(ObjectDB::get_instance(_targets[i]));
+		if (node == nullptr) {
+			_targets.remove_at(i);
+			continue;
+		}
+		if (node->is_inside_tree()) {
+			Vector3 pos = node->get_global_position();
+			_target_positions.push_back(Vector2(pos.x, pos.z));
+		}
+	}
+	if (_targets.is_empty() && is_instance_valid(_terrain->_camera_instance_id, _terrain->_camera) &&
+			_terrain->_camera->is_inside_tree()) {
+		Vector3 pos = _terrain->_camera->get_global_position();
+		_target_positions.push_back(Vector2(pos.x, pos.z));
+	}
+	bool moved = _target_positions.size() != _target_tiles.size();
+	_target_tiles.resize(_target_positions.size());
+	for (int i = 0; i < _target_positions.size(); i++) {
+		Vector2i tile = Vector2i((_target_positions[i] / tile_width).floor());
+		moved = moved || tile != _target_tiles[i];
+		_target_tiles.write[i] = tile;
+	}
+	return moved;
+}
+
+Rect2 Terrain3DCollision::_get_tile_rect(const Vector2i &p_tile_loc) const {
+	real_t tile_width = real_t(_tile_size) * _terrain->get_vertex_spacing();
+	return Rect2(Vector2(p_tile_loc) * tile_width, Vector2(tile_width, tile_width));
+}
+
+// Fills the heights of all jobs, spread across the WorkerThreadPool
+void Terrain3DCollision::_generate_jobs(Vector<ShapeJob> &p_jobs) const {
+	JobBatch batch;
+	batch.collision = this;
+	batch.jobs = p_jobs.ptrw();
+	if (p_jobs.size() == 1) {
+		_generate_job(&batch, 0);
+	} else if (p_jobs.size() > 1) {
+		WorkerThreadPool *wtp = WorkerThreadPool::get_singleton();
+		int64_t task_id = wtp->add_native_group_task(&Terrain3DCollision::_generate_job, &batch, p_jobs.size(), -1, true, "Terrain3DCollision");
+		wtp->wait_for_group_task_completion(task_id);
+	}
+}
+
+void Terrain3DCollision::_generate_job(void *p_batch, uint32_t p_index) {
+	const JobBatch *batch = static_cast<const JobBatch *>(p_batch);
+	ShapeJob &job = batch->jobs[p_index];
+	int shape_size = job.quads + 1;
+	if (job.lod == 0) {
+		job.heights.resize(shape_size * shape_size);
+		job.height_range = batch->collision->_generate_heights(job.global_pixel, job.quads, job.heights.ptrw());
+		return;
+	}
+	// The full resolution range still bounds the downsampled heights
+	int step = 1 << job.lod;
+	int lod_size = job.quads / step + 1;
+	PackedRealArray heights;
+	heights.resize(shape_size * shape_size);
+	job.height_range = batch->collision->_generate_heights(job.global_pixel, job.quads, heights.ptrw());
+	job.heights.resize(lod_size * lod_size);
+	_downsample_heights(heights.ptr(), shape_size, step, job.heights.ptrw());
+}
+
+// Builds every tile of every region for the full modes. Heights are generated on worker threads,
+// then only the shapes are submitted here.
+void Terrain3DCollision::_build_regions() {
+	uint64_t time = Time::get_singleton()->get_ticks_usec();
+	int tiles_per_region = _terrain->get_region_size() / _tile_size;
+	TypedArray<Vector2i> region_locations = _terrain->get_data()->get_region_locations();
+	Vector<ShapeJob> jobs;
+	jobs.resize(region_locations.size() * tiles_per_region * tiles_per_region);
+	int count = 0;
+	for (int i = 0; i < region_locations.size(); i++) {
+		Vector2i first_tile = Vector2i(region_locations[i]) * tiles_per_region;
+		for (int z = 0; z < tiles_per_region; z++) {
+			for (int x = 0; x < tiles_per_region; x++) {
+				ShapeJob &job = jobs.write[count++];
+				job.location = first_tile + Vector2i(x, z);
+				job.global_pixel = job.location * _tile_size;
+				job.quads = _tile_size;
+				job.lod = _get_lod(_get_tile_rect(job.location));
+			}
+		}
+	}
+	_generate_jobs(jobs);
+	for (int i = 0; i < jobs.size(); i++) {
+		int index = _create_shape();
+		_set_shape(index, jobs[i]);
+		_tiles[jobs[i].location] = index;
+		_shape_lods[jobs[i].location] = jobs[i].lod;
+	}
+	LOG(DEBUG, "Collision creation time for ", region_locations.size(), " regions, ", jobs.size(), " shapes: ",
+			(Time::get_singleton()->get_ticks_usec() - time) / 1000.f, " ms");
+}
+
+// Regenerates the active tiles that were edited or changed LOD in place
+void Terrain3DCollision::_update_tiles() {
+	uint64_t time = Time::get_singleton()->get_ticks_usec();
+	Array tiles = _dirty_tiles.keys();
+	_dirty_tiles.clear();
+	Vector<ShapeJob> jobs;
+	for (int i = 0; i < tiles.size(); i++) {
+		Vector2i tile = tiles[i];
+		if (!_tiles.has(tile)) {
+			continue;
+		}
+		ShapeJob job;
+		job.location = tile;
+		job.global_pixel = tile * _tile_size;
+		job.quads = _tile_size;
+		job.lod = _get_lod(_get_tile_rect(tile));
+		jobs.push_back(job);
+	}
+	_generate_jobs(jobs);
+	for (int i = 0; i < jobs.size(); i++) {
+		_set_shape(_tiles[jobs[i].location], jobs[i]);
+		_shape_lods[jobs[i].location] = jobs[i].lod;
+	}
+	LOG(DEBUG, "Collision update time for ", jobs.size(), " tiles: ",
+			(Time::get_singleton()->get_ticks_usec() - time) / 1000.f, " ms");
+}
+
+///////////////////////////
+// Public Functions
+///////////////////////////
+
+// Rebuilds all collision for the current mode. Called when regions are added or removed,
+// or settings change.
+void Terrain3DCollision::build() {
+	if (_terrain == nullptr) {
+		return;
+	}
+	destroy();
+	if (!_terrain->get_collision_enabled() || !_terrain->is_inside_tree()) {
+		return;
+	}
+	// Create collision only in game, unless showing debug
+	if (IS_EDITOR && !_is_editor_mode()) {
+		return;
+	}
+	if (_terrain->get_data() == nullptr) {
+		LOG(ERROR, "_data missing, cannot create collision");
+		return;
+	}
+	_tile_size = MIN(_terrain->get_collision_shape_size(), _terrain->get_region_size());
+	// Editor shapes are CollisionShape3D nodes. Full editor keeps one per region, so large worlds
+	// don't flood the scene tree.
+	if (_is_editor_mode() && !_is_dynamic_mode()) {
+		_tile_size = _terrain->get_region_size();
+	}
+	_create_body();
+	_update_targets();
+	if (_is_dynamic_mode()) {
+		update();
+	} else {
+		_build_regions();
+	}
+}
+
+/**
+ * Called every physics frame. In full modes, regenerates edited tiles, and swaps tile LODs as the
+ * targets move. In dynamic modes, keeps tiles around the targets, or the camera if there are none.
+ * Each target needs the tiles within collision_radius of any point on the tile it's on, so tiles
+ * only change when a target crosses a tile boundary. Unneeded tiles are disabled and pooled. New,
+ * edited and re-LODed tiles are generated on worker threads, then submitted to the physics server
+ * here.
+ */
+void Terrain3DCollision::update() {
+	if (!_has_body()) {
+		return;
+	}
+	if (!_is_dynamic_mode()) {
+		if (_terrain->get_collision_lod_distances() != V3_ZERO && _update_targets()) {
+			Array tiles = _tiles.keys();
+			for (int i = 0; i < tiles.size(); i++) {
+				Vector2i tile = tiles[i];
+				if (_get_lod(_get_tile_rect(tile)) != int(_shape_lods[tile])) {
+					_dirty_tiles[tile] = true;
+				}
+			}
+		}
+		if (!_dirty_tiles.is_empty()) {
+			_update_tiles();
+		}
+		return;
+	}
+
+	bool moved = _update_targets();
+	if (!moved && !_tiles_dirty && _dirty_tiles.is_empty()) {
+		return;
+	}
+
+	uint64_t time = Time::get_singleton()->get_ticks_usec();
+	const Terrain3DData *data = _terrain->get_data();
+	int region_size = _terrain->get_region_size();
+	real_t tile_width = real_t(_tile_size) * _terrain->get_vertex_spacing();
+	real_t radius = _terrain->get_collision_radius();
+	int range = int(Math::ceil(radius / tile_width));
+	Dictionary needed;
+	for (int i = 0; i < _target_tiles.size(); i++) {
+		for (int dz = -range; dz <= range; dz++) {
+			for (int dx = -range; dx <= range; dx++) {
+				// Closest distance between the target tile and this one
+				Vector2 gap = Vector2(MAX(0, ABS(dx) - 1), MAX(0, ABS(dz) - 1)) * tile_width;
+				if (gap.length() > radius) {
+					continue;
+				}
+				Vector2i tile = _target_tiles[i] + Vector2i(dx, dz);
+				if (data->has_region(V2I_DIVIDE_FLOOR(tile * _tile_size, region_size))) {
+					needed[tile] = true;
+				}
+			}
+		}
+	}
+
+	// Return tiles no longer needed to the pool
+	Array active = _tiles.keys();
+	for (int i = 0; i < active.size(); i++) {
+		Vector2i tile = active[i];
+		if (!needed.has(tile)) {
+			int index = _tiles[tile];
+			_set_shape_enabled(index, false);
+			_free_shapes.push_back(index);
+			_tiles.erase(tile);
+			_shape_lods.erase(tile);
+		}
+	}
+
+	// Generate new and edited tiles, and those that changed LOD
+	Vector<ShapeJob> jobs;
+	Array needed_tiles = needed.keys();
+	for (int i = 0; i < needed_tiles.size(); i++) {
+		Vector2i tile = needed_tiles[i];
+		int lod = _get_lod(_get_tile_rect(tile));
+		if (!_tiles.has(tile) || _dirty_tiles.has(tile) || lod != int(_shape_lods[tile])) {
+			ShapeJob job;
+			job.location = tile;
+			job.global_pixel = tile * _tile_size;
+			job.quads = _tile_size;
+			job.lod = lod;
+			jobs.push_back(job);
+		}
+	}
+	_dirty_tiles.clear();
+	_generate_jobs(jobs);
+
+	for (int i = 0; i < jobs.size(); i++) {
+		const ShapeJob &job = jobs[i];
+		int index;
+		if (_tiles.has(job.location)) {
+			index = _tiles[job.location];
+		} else if (!_free_shapes.is_empty()) {
+			index = _free_shapes[_free_shapes.size() - 1];
+			_free_shapes.remove_at(_free_shapes.size() - 1);
+		} else {
+			index = _create_shape();
+		}
+		_set_shape(index, job);
+		_set_shape_enabled(index, true);
+		_tiles[job.location] = index;
+		_shape_lods[job.location] = job.lod;
+	}
+	_tiles_dirty = false;
+	if (jobs.size() > 0) {
+		LOG(DEBUG, "Collision tiles built: ", jobs.size(), ", active: ", _tiles.size(), ", pooled: ", _free_shapes.size(),
+				", time: ", (Time::get_singleton()->get_ticks_usec() - time) / 1000.f, " ms");
+	}
+}
+
+// Connected to Terrain3DData::maps_edited. Marks the active tiles overlapping the edited area, and
+// those in -X and -Z that share its edge vertices, for regeneration on the next update(). Tiles
+// outside the area keep their shapes.
+void Terrain3DCollision::queue_update(const AABB &p_area) {
+	if (!_has_body()) {
+		return;
+	}
+	real_t vertex_spacing = _terrain->get_vertex_spacing();
+	real_t tile_width = real_t(_tile_size) * vertex_spacing;
+	Vector3 start = p_area.position - Vector3(vertex_spacing, 0.f, vertex_spacing);
+	Vector3 end = p_area.get_end() + Vector3(vertex_spacing, 0.f, vertex_spacing);
+	Vector2i tile_start = Vector2i((Vector2(start.x, start.z) / tile_width).floor());
+	Vector2i tile_end = Vector2i((Vector2(end.x, end.z) / tile_width).floor());
+	for (int z = tile_start.y; z <= tile_end.y; z++) {
+		for (int x = tile_start.x; x <= tile_end.x; x++) {
+			Vector2i tile = Vector2i(x, z);
+			if (_tiles.has(tile)) {
+				_dirty_tiles[tile] = true;
+			}
+		}
+	}
+}
+
+// Applies the space, layers, mask and priority from Terrain3D to the body
+void Terrain3DCollision::update_settings() {
+	if (_static_body.is_valid()) {
+		if (_terrain->is_inside_tree()) {
+			PhysicsServer3D::get_singleton()->body_set_space(_static_body, _terrain->get_world_3d()->get_space());
+		}
+		PhysicsServer3D::get_singleton()->body_set_collision_layer(_static_body, _terrain->get_collision_layer());
+		PhysicsServer3D::get_singleton()->body_set_collision_mask(_static_body, _terrain->get_collision_mask());
+		PhysicsServer3D::get_singleton()->body_set_collision_priority(_static_body, _terrain->get_collision_priority());
+	}
+	if (_debug_static_body != nullptr) {
+		_debug_static_body->set_collision_layer(_terrain->get_collision_layer());
+		_debug_static_body->set_collision_mask(_terrain->get_collision_mask());
+		_debug_static_body->set_collision_priority(_terrain->get_collision_priority());
+	}
+}
+
+void Terrain3DCollision::destroy() {
+	_tiles.clear();
+	_dirty_tiles.clear();
+	_free_shapes.clear();
+	_target_tiles.clear();
+	_target_positions.clear();
+	_shape_lods.clear();
+	_tiles_dirty = true;
+
+	if (_static_body.is_valid()) {
+		LOG(INFO, "Freeing physics body");
+		for (int i = PhysicsServer3D::get_singleton()->body_get_shape_count(_static_body) - 1; i >= 0; i--) {
+			RID shape = PhysicsServer3D::get_singleton()->body_get_shape(_static_body, i);
+			PhysicsServer3D::get_singleton()->free_rid(shape);
+		}
+		PhysicsServer3D::get_singleton()->free_rid(_static_body);
+		_static_body = RID();
+	}
+
+	if (_debug_static_body != nullptr) {
+		LOG(INFO, "Freeing debug static body");
+		for (int i = 0; i < _debug_static_body->get_child_count(); i++) {
+			Node *child = _debug_static_body->get_child(i);
+			LOG(DEBUG, "Freeing dsb child ", i, " ", child->get_name());
+			_debug_static_body->remove_child(child);
+			memdelete(child);
+		}
+
+		LOG(DEBUG, "Freeing static body");
+		_terrain->remove_child(_debug_static_body);
+		memdelete(_debug_static_body);
+		_debug_static_body = nullptr;
+	}
+}
+
+RID Terrain3DCollision::get_rid() const {
+	if (_debug_static_body != nullptr) {
+		return _debug_static_body->get_rid();
+	}
+	return _static_body;
+}
+
+void Terrain3DCollision::add_target(Node3D *p_node) {
+	if (p_node == nullptr) {
+		LOG(ERROR, "Collision target is null");
+		return;
+	}
+	uint64_t id = p_node->get_instance_id();
+	if (!_targets.has(id)) {
+		LOG(INFO, "Adding collision target: ", p_node->get_name());
+		_targets.push_back(id);
+	}
+}
+
+void Terrain3DCollision::remove_target(Node3D *p_node) {
+	if (p_node != nullptr) {
+		LOG(INFO, "Removing collision target: ", p_node->get_name());
+		_targets.erase(p_node->get_instance_id());
+	}
+}
+
+TypedArray<Node3D> Terrain3DCollision::get_targets() const {
+	TypedArray<Node3D> targets;
+	for (int i = 0; i < _targets.size(); i++) {
+		Node3D *node = Object::cast_to<Node3D>(ObjectDB::get_instance(_targets[i]));
+		if (node != nullptr) {
+			targets.push_back(node);
+		}
+	}
+	return targets;
+}
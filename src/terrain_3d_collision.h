@@ -0,0 +1,93 @@
+// Copyright © 2025 Cory Petkovsek, Roope Palmroos, and Contributors.
+
+#ifndef TERRAIN3D_COLLISION_CLASS_H
+#define TERRAIN3D_COLLISION_CLASS_H
+
+#include <godot_cpp/classes/static_body3d.hpp>
+
+#include "constants.h"
+
+class Terrain3D;
+
+using namespace godot;
+
+// Builds and maintains the terrain collision shapes for Terrain3D, which owns the settings.
+// Collision is split into square tiles of collision_shape_size quads, each a heightmap shape with
+// its own height range. Full modes build every tile of every region. Dynamic modes only keep the
+// tiles around the collision targets, recycled through a pool of disabled shapes. Heights are
+// generated on worker threads.
+class Terrain3DCollision {
+	CLASS_NAME_STATIC("Terrain3DCollision");
+
+public: // Constants
+	static inline const int KERNEL_BLOCK = 32; // Pixels per side of the blocks transposed by _generate_heights()
+
+private:
+	Terrain3D *_terrain = nullptr;
+
+	// Game modes use a physics server body. Editor modes use a StaticBody3D with CollisionShape3D
+	// children, so the shapes are visible with View Gizmos. Shapes are referred to by their index
+	// on the body, or child index.
+	RID _static_body;
+	StaticBody3D *_debug_static_body = nullptr;
+
+	int _tile_size = 64; // Quads per side of each shape, set on build()
+	Dictionary _tiles; // Dict[tile_location:Vector2i] -> shape index
+	Dictionary _dirty_tiles; // Set of tile_locations edited since their shapes were built
+	Dictionary _shape_lods; // Dict[tile_location:Vector2i] -> lod the shape was built at
+
+	// Dynamic modes
+	Vector<uint64_t> _targets; // Instance ids of the Node3Ds to keep collision around, also used for LODs
+	Vector<int> _free_shapes; // Disabled shape indices, ready to be reused
+	Vector<Vector2> _target_positions; // XZ positions of the targets, or camera, at the last update
+	Vector<Vector2i> _target_tiles; // Tiles the targets were on during the last update
+	bool _tiles_dirty = true; // Force the next update to recalculate which tiles are needed
+
+	// Heights for one shape, filled on a worker thread
+	struct ShapeJob {
+		Vector2i location; // Tile location
+		Vector2i global_pixel; // Top left pixel of the shape
+		int quads = 0; // Full resolution quads per side
+		int lod = 0; // Built with 1 / 2^lod of the vertices per side
+		PackedRealArray heights;
+		Vector2 height_range;
+	};
+	struct JobBatch {
+		const Terrain3DCollision *collision = nullptr;
+		ShapeJob *jobs = nullptr;
+	};
+
+	bool _is_editor_mode() const;
+	bool _is_dynamic_mode() const;
+	bool _has_body() const { return _static_body.is_valid() || _debug_static_body != nullptr; }
+	void _create_body();
+	int _create_shape();
+	void _set_shape(const int p_index, const ShapeJob &p_job);
+	void _set_shape_enabled(const int p_index, const bool p_enabled);
+	Vector2 _generate_heights(const Vector2i &p_global_pixel, const int p_quads, real_t *r_heights) const;
+	static void _downsample_heights(const real_t *p_heights, const int p_size, const int p_step, real_t *r_heights);
+	int _get_lod(const Rect2 &p_rect) const;
+	bool _update_targets();
+	Rect2 _get_tile_rect(const Vector2i &p_tile_loc) const;
+	void _generate_jobs(Vector<ShapeJob> &p_jobs) const;
+	static void _generate_job(void *p_batch, uint32_t p_index);
+	void _build_regions();
+	void _update_tiles();
+
+public:
+	Terrain3DCollision() {}
+	void initialize(Terrain3D *p_terrain) { _terrain = p_terrain; }
+
+	void build();
+	void update();
+	void queue_update(const AABB &p_area);
+	void update_settings();
+	void destroy();
+	RID get_rid() const;
+
+	void add_target(Node3D *p_node);
+	void remove_target(Node3D *p_node);
+	TypedArray<Node3D> get_targets() const;
+};
+
+#endif // TERRAIN3D_COLLISION_CLASS_H
@@ -6,6 +6,7 @@
 #include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/file_access.hpp>
 #include <godot_cpp/classes/resource_saver.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
 
 #include "logger.h"
 #include "terrain_3d_data.h"
@@ -19,12 +20,20 @@ void Terrain3DData::_clear() {
 	_region_map_dirty = true;
 	_region_map.clear();
 	_region_map.resize(REGION_MAP_SIZE * REGION_MAP_SIZE);
+	_region_table.clear();
+	_height_mips_dirty = Rect2i();
 	_regions.clear();
 	_region_locations.clear();
 	_master_height_range = V2_ZERO;
+	_discard_map_build();
+	_generate_color_mipmaps = false;
+	_texture_region_map.clear();
+	_texture_region_locations.clear();
+	_texture_summary_layer = -2;
 	_generated_height_maps.clear();
 	_generated_control_maps.clear();
 	_generated_color_maps.clear();
+	_clear_streaming();
 }
 
 // Structured to work with do_for_regions. Should be renamed when copy_paste is expanded
@@ -41,6 +50,832 @@ void Terrain3DData::_copy_paste_dfr(const Terrain3DRegion *p_src_region, const R
 	_terrain->get_instancer()->copy_paste_dfr(p_src_region, p_src_rect, p_dst_region);
 }
 
+// Syncs the region table with `_region_locations`, which defines region_id. Also picks up regions
+// swapped in `_regions` directly, such as by undo, which doesn't dirty the region map.
+void Terrain3DData::_update_region_table() {
+	_region_table.resize(_region_locations.size());
+	for (int i = 0; i < _region_locations.size(); i++) {
+		Vector2i region_loc = _region_locations[i];
+		Ref<Terrain3DRegion> region = get_region(region_loc);
+		if (region == _region_table[i]) {
+			continue;
+		}
+		// Pixel reads index the maps directly, so only accept sanitized maps of the current size
+		for (int type = 0; region.is_valid() && type < TYPE_MAX; type++) {
+			Image *map = region->get_map_ptr(MapType(type));
+			if (!map || map->get_width() != _region_size || map->get_height() != _region_size ||
+					map->get_format() != FORMAT[type]) {
+				LOG(ERROR, "Region ", region_loc, " ", TYPESTR[type], " is not a ", _region_sizev,
+						" image of format ", FORMAT[type], ". Region excluded from pixel access");
+				region.unref();
+			}
+		}
+		_region_table.write[i] = region;
+	}
+}
+
+// Uploads a map of an edited region to its texture array layer. If the editor tracked the pixels it
+// changed, only that rectangle is uploaded, or nothing if it didn't change this map. When streaming,
+// regions that aren't resident update their tile of the summary layer instead.
+void Terrain3DData::_update_layer(const MapType p_map_type, Terrain3DRegion *p_region, const int p_region_id) {
+	GeneratedTexture *gen_tex = _get_generated_maps(p_map_type);
+	if (gen_tex == nullptr) {
+		return;
+	}
+	Rect2i rect = p_region->_dirty_rects[p_map_type];
+	if (p_region->_dirty_rects_tracked) {
+		if (!rect.has_area()) {
+			return;
+		}
+		p_region->_dirty_rects[p_map_type] = Rect2i();
+	}
+	int layer = p_region_id;
+	if (_is_streaming()) {
+		layer = _get_resident_slot(p_region->get_location());
+		if (layer < 0) {
+			_update_summary_tile(p_map_type, p_region);
+			gen_tex->update(_get_summary_layer(_summary_maps[p_map_type], p_map_type), _get_slot_count());
+			return;
+		}
+		_summary_stale.set(get_region_map_index(p_region->get_location()), 1);
+	}
+	gen_tex->update(p_region->get_map(p_map_type), layer, rect);
+}
+
+GeneratedTexture *Terrain3DData::_get_generated_maps(const MapType p_map_type) {
+	switch (p_map_type) {
+		case TYPE_HEIGHT:
+			return &_generated_height_maps;
+		case TYPE_CONTROL:
+			return &_generated_control_maps;
+		case TYPE_COLOR:
+			return &_generated_color_maps;
+		default:
+			return nullptr;
+	}
+}
+
+bool Terrain3DData::_is_streaming() const {
+	return _terrain != nullptr && _terrain->get_texture_streaming();
+}
+
+// Slots cover the square of regions within the streaming radius of the camera region
+int Terrain3DData::_get_slot_count() const {
+	int width = _terrain->get_texture_streaming_radius() * 2 + 1;
+	return width * width;
+}
+
+int Terrain3DData::_get_resident_slot(const Vector2i &p_region_loc) const {
+	int map_index = get_region_map_index(p_region_loc);
+	if (map_index < 0 || map_index >= _resident_map.size()) {
+		return -1;
+	}
+	int slot = _resident_map[map_index] - 1;
+	return (slot >= 0 && slot < _slot_locations.size()) ? slot : -1;
+}
+
+// Frees the slots of regions that left the streaming radius, and assigns free slots to regions
+// that entered it. Regions keep their slots while in range, so only those changing are uploaded.
+// Without p_upload, only the slots are assigned, for the texture arrays about to be rebuilt.
+void Terrain3DData::_update_residency(const bool p_upload) {
+	const int radius = _terrain->get_texture_streaming_radius();
+	const int slot_count = _get_slot_count();
+	if (_slot_locations.size() != slot_count) {
+		_slot_locations.resize(slot_count);
+		_slot_locations.fill(V2I_MAX);
+	}
+	if (_summary_stale.size() != REGION_MAP_SIZE * REGION_MAP_SIZE) {
+		_summary_stale.resize(REGION_MAP_SIZE * REGION_MAP_SIZE);
+		_summary_stale.fill(0);
+	}
+
+	// Evict regions out of range or no longer active. Their summary tiles are refreshed if they were
+	// edited while resident.
+	bool summary_changed = false;
+	for (int slot = 0; slot < slot_count; slot++) {
+		Vector2i region_loc = _slot_locations[slot];
+		if (region_loc == V2I_MAX) {
+			continue;
+		}
+		Vector2i dist = (region_loc - _streaming_center).abs();
+		if (MAX(dist.x, dist.y) <= radius && has_region(region_loc)) {
+			continue;
+		}
+		LOG(EXTREME, "Evicting region ", region_loc, " from slot ", slot);
+		_slot_locations.write[slot] = V2I_MAX;
+		int map_index = get_region_map_index(region_loc);
+		if (map_index >= 0 && _summary_stale[map_index]) {
+			_summary_stale.set(map_index, 0);
+			const Terrain3DRegion *region = _get_region_ptr(region_loc);
+			if (p_upload && region) {
+				for (int type = 0; type < TYPE_MAX; type++) {
+					_update_summary_tile(MapType(type), region);
+				}
+				summary_changed = true;
+			}
+		}
+	}
+
+	// Page in regions that entered the radius
+	int free_slot = 0;
+	for (int z = -radius; z <= radius; z++) {
+		for (int x = -radius; x <= radius; x++) {
+			Vector2i region_loc = _streaming_center + Vector2i(x, z);
+			if (!has_region(region_loc) || _slot_locations.has(region_loc)) {
+				continue;
+			}
+			while (free_slot < slot_count && _slot_locations[free_slot] != V2I_MAX) {
+				free_slot++;
+			}
+			if (free_slot >= slot_count) {
+				break;
+			}
+			LOG(EXTREME, "Paging in region ", region_loc, " to slot ", free_slot);
+			_slot_locations.write[free_slot] = region_loc;
+			const Terrain3DRegion *region = _get_region_ptr(region_loc);
+			if (p_upload && region) {
+				for (int type = 0; type < TYPE_MAX; type++) {
+					_get_generated_maps(MapType(type))->update(region->get_map(MapType(type)), free_slot);
+				}
+			}
+		}
+	}
+	if (summary_changed) {
+		for (int type = 0; type < TYPE_MAX; type++) {
+			_get_generated_maps(MapType(type))->update(_get_summary_layer(_summary_maps[type], MapType(type)), slot_count);
+		}
+	}
+
+	// Point the shader at the slots of resident regions and the summary for the rest
+	_resident_map.resize(REGION_MAP_SIZE * REGION_MAP_SIZE);
+	_resident_map.fill(0);
+	for (int i = 0; i < _region_locations.size(); i++) {
+		int map_index = get_region_map_index(_region_locations[i]);
+		if (map_index >= 0) {
+			_resident_map.set(map_index, slot_count + 1);
+		}
+	}
+	_resident_locations = TypedArray<Vector2i>(); // enforce new pointer
+	for (int slot = 0; slot < slot_count; slot++) {
+		Vector2i region_loc = _slot_locations[slot];
+		int map_index = get_region_map_index(region_loc);
+		if (map_index >= 0) {
+			_resident_map.set(map_index, slot + 1);
+		}
+		_resident_locations.push_back(map_index >= 0 ? region_loc : V2I_ZERO);
+	}
+	_resident_locations.push_back(V2I_ZERO); // Summary
+}
+
+void Terrain3DData::_clear_streaming() {
+	_slot_locations.clear();
+	_resident_map.clear();
+	_resident_locations.clear();
+	_summary_stale.clear();
+	for (int type = 0; type < TYPE_MAX; type++) {
+		_summary_maps[type].unref();
+	}
+}
+
+void Terrain3DData::_update_summary_tile(const MapType p_map_type, const Terrain3DRegion *p_region) {
+	_blit_summary_tile(_summary_maps[p_map_type].ptr(), p_region->get_map(p_map_type), p_map_type,
+			get_region_map_index(p_region->get_location()));
+}
+
+// Downsamples a region map into its tile of the summary, at region_size / REGION_MAP_SIZE, at its
+// location in the region map. Control maps are bit fields, so are point sampled. Heights are too, so
+// far terrain isn't lowered by averaging peaks into valleys. Safe on worker threads.
+void Terrain3DData::_blit_summary_tile(Image *p_summary, const Ref<Image> &p_map, const MapType p_map_type, const int p_map_index) {
+	if (p_summary == nullptr || p_map.is_null() || p_map_index < 0) {
+		return;
+	}
+	const int tile_size = MAX(p_summary->get_width() / REGION_MAP_SIZE, 1);
+	Ref<Image> tile;
+	tile.instantiate();
+	tile->copy_from(p_map);
+	tile->resize(tile_size, tile_size, (p_map_type == TYPE_COLOR) ? Image::INTERPOLATE_TRILINEAR : Image::INTERPOLATE_NEAREST);
+	tile->clear_mipmaps();
+	Vector2i position = Vector2i(p_map_index % REGION_MAP_SIZE, p_map_index / REGION_MAP_SIZE) * tile_size;
+	p_summary->blit_rect(tile, Rect2i(V2I_ZERO, Vector2i(tile_size, tile_size)), position);
+}
+
+// Returns the summary as a texture layer. Color layers need mipmaps to match the region maps.
+Ref<Image> Terrain3DData::_get_summary_layer(const Ref<Image> &p_summary, const MapType p_map_type) {
+	if (p_map_type != TYPE_COLOR || p_summary.is_null()) {
+		return p_summary;
+	}
+	Ref<Image> layer;
+	layer.instantiate();
+	layer->copy_from(p_summary);
+	layer->generate_mipmaps();
+	return layer;
+}
+
+// Snapshots the region maps for the arrays being rebuilt and hands them to a worker thread. Image
+// copies share their data until written, so this is cheap, and edits made meanwhile on the main
+// thread don't reach the worker.
+void Terrain3DData::_start_map_build(const bool *p_types) {
+	_discard_map_build();
+	MapBuild *build = memnew(MapBuild);
+	build->data = this;
+	build->id = ++_map_build_count;
+	build->region_size = _region_size;
+	build->streaming = _is_streaming();
+	build->slot_locations = _slot_locations;
+	build->generate_mipmaps = _generate_color_mipmaps && p_types[TYPE_COLOR];
+	_generate_color_mipmaps = false;
+	for (int i = 0; i < _region_locations.size(); i++) {
+		build->locations.push_back(_region_locations[i]);
+	}
+	for (int type = 0; type < TYPE_MAX; type++) {
+		build->types[type] = p_types[type];
+		if (!p_types[type]) {
+			continue;
+		}
+		if (build->streaming && _summary_maps[type].is_valid()) {
+			build->summaries[type] = _summary_maps[type];
+		}
+		TypedArray<Image> maps = get_maps(MapType(type));
+		for (int i = 0; i < maps.size(); i++) {
+			Ref<Image> map = maps[i];
+			Ref<Image> snapshot;
+			snapshot.instantiate();
+			snapshot->copy_from(map);
+			build->maps[type].push_back(snapshot);
+			if (type == TYPE_COLOR && build->generate_mipmaps) {
+				build->color_maps.push_back(map);
+				build->color_data.push_back(map->get_data());
+			}
+		}
+	}
+	_map_build = build;
+	LOG(DEBUG, "Rebuilding texture arrays on a worker thread, build: ", build->id);
+	WorkerThreadPool *wtp = WorkerThreadPool::get_singleton();
+	build->task_id = wtp->add_native_task(&Terrain3DData::_run_map_build, build, true, "Terrain3DData::update_maps");
+}
+
+// Runs on a worker thread. Only touches the build.
+void Terrain3DData::_run_map_build(void *p_build) {
+	MapBuild *build = static_cast<MapBuild *>(p_build);
+	if (build->generate_mipmaps) {
+		for (const Ref<Image> &map : build->maps[TYPE_COLOR]) {
+			map->generate_mipmaps();
+		}
+	}
+
+	// Region id by region map index, to fill the streaming slots
+	PackedInt32Array region_ids;
+	if (build->streaming) {
+		region_ids.resize(REGION_MAP_SIZE * REGION_MAP_SIZE);
+		region_ids.fill(-1);
+		for (int i = 0; i < build->locations.size(); i++) {
+			int map_index = get_region_map_index(build->locations[i]);
+			if (map_index >= 0) {
+				region_ids.set(map_index, i);
+			}
+		}
+	}
+
+	Vector2i size = Vector2i(build->region_size, build->region_size);
+	for (int type = 0; type < TYPE_MAX; type++) {
+		if (!build->types[type]) {
+			continue;
+		}
+		const Vector<Ref<Image>> &maps = build->maps[type];
+		TypedArray<Image> &layers = build->layers[type];
+		if (!build->streaming) {
+			for (const Ref<Image> &map : maps) {
+				layers.push_back(map);
+			}
+			continue;
+		}
+		if (maps.is_empty()) {
+			continue; // Empty without regions, like the regular arrays
+		}
+
+		// Resident regions in their slots, a blank map in free slots, and the summary last
+		Ref<Image> &summary = build->summaries[type];
+		if (summary.is_null()) {
+			summary = Util::get_filled_image(size, COLOR[type], false, FORMAT[type]);
+			for (int i = 0; i < maps.size(); i++) {
+				_blit_summary_tile(summary.ptr(), maps[i], MapType(type), get_region_map_index(build->locations[i]));
+			}
+		}
+		Ref<Image> blank;
+		for (const Vector2i &slot_loc : build->slot_locations) {
+			int map_index = get_region_map_index(slot_loc);
+			int region_id = (map_index >= 0) ? region_ids[map_index] : -1;
+			if (region_id >= 0) {
+				layers.push_back(maps[region_id]);
+				continue;
+			}
+			if (blank.is_null()) {
+				blank = Util::get_filled_image(size, COLOR[type], type == TYPE_COLOR, FORMAT[type]);
+			}
+			layers.push_back(blank);
+		}
+		layers.push_back(_get_summary_layer(summary, MapType(type)));
+	}
+	callable_mp(build->data, &Terrain3DData::_apply_map_build).bind(build->id).call_deferred();
+}
+
+// Swaps in the arrays of a finished build on the main thread. Called deferred by the worker, or
+// directly to wait for it. Builds replaced by a newer one are ignored.
+void Terrain3DData::_apply_map_build(const uint64_t p_id) {
+	MapBuild *build = _map_build;
+	if (build == nullptr || build->id != p_id) {
+		return;
+	}
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(build->task_id);
+	_map_build = nullptr;
+
+	// Write regenerated mipmaps back to color maps that haven't been edited since the snapshot
+	for (int i = 0; i < build->color_maps.size(); i++) {
+		const Ref<Image> &map = build->color_maps[i];
+		if (map->get_data().ptr() == build->color_data[i].ptr()) {
+			map->copy_from(build->maps[TYPE_COLOR][i]);
+		}
+	}
+	// Arrays are only updated in sub-rects while editing
+	bool updatable = IS_EDITOR || (_terrain != nullptr && _terrain->get_editor() != nullptr);
+	for (int type = 0; type < TYPE_MAX; type++) {
+		if (build->types[type]) {
+			_get_generated_maps(MapType(type))->create(build->layers[type], updatable);
+			if (build->streaming) {
+				_summary_maps[type] = build->summaries[type];
+			}
+		}
+	}
+	LOG(DEBUG, "Swapped in rebuilt texture arrays, build: ", build->id);
+	memdelete(build);
+	if (_is_streaming() && !_slot_locations.is_empty()) {
+		_update_residency(true); // Catch up if the camera moved during the build
+	}
+	_bind_texture_maps();
+	emit_signal("maps_changed");
+	emit_signal("maps_rebuilt");
+}
+
+// Waits for a build in progress and drops it
+void Terrain3DData::_discard_map_build() {
+	if (_map_build != nullptr) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(_map_build->task_id);
+		memdelete(_map_build);
+		_map_build = nullptr;
+	}
+}
+
+// Sets the region map the shader uses to the one the bound texture arrays were built for
+void Terrain3DData::_bind_texture_maps() {
+	if (_is_streaming() && !_resident_map.is_empty()) {
+		_texture_region_map = _resident_map;
+		_texture_region_locations = _resident_locations;
+		_texture_summary_layer = _slot_locations.size();
+	} else {
+		_texture_region_map = _region_map;
+		_texture_region_locations = _region_locations;
+		_texture_summary_layer = -2;
+	}
+}
+
+// Resolves the raw height, control and, if requested, color buffers of the region at the map index
+// the first time a batch query samples it. Samples read the region maps in place, skipping the
+// Dictionary lookup, Ref counting and Image::get_pixelv() of get_pixel(). Like get_pixel(), deleted
+// regions are treated as missing.
+void Terrain3DData::_resolve_batch_region(BatchMaps &r_maps, const int p_map_index) const {
+	r_maps.resolved[p_map_index] = true;
+	Vector2i region_loc = Vector2i(p_map_index % REGION_MAP_SIZE, p_map_index / REGION_MAP_SIZE) - REGION_MAP_VSIZE / 2;
+	const Terrain3DRegion *region = _get_region_ptr(region_loc);
+	if (!region) {
+		return;
+	}
+	// Color maps have mipmaps, but only the first level is read
+	auto get_buffer = [&](const MapType p_map_type) -> const uint8_t * {
+		Image *map = region->get_map_ptr(p_map_type);
+		if (map == nullptr || map->get_width() != _region_size || map->get_height() != _region_size) {
+			return nullptr;
+		}
+		if (map->get_format() != FORMAT[p_map_type]) {
+			Ref<Image> copy = map->duplicate();
+			copy->convert(FORMAT[p_map_type]);
+			r_maps.converted.push_back(copy);
+			map = copy.ptr();
+		}
+		return map->ptr();
+	};
+	r_maps.height[p_map_index] = reinterpret_cast<const float *>(get_buffer(TYPE_HEIGHT));
+	r_maps.control[p_map_index] = reinterpret_cast<const float *>(get_buffer(TYPE_CONTROL));
+	if (r_maps.use_color) {
+		r_maps.color[p_map_index] = get_buffer(TYPE_COLOR);
+	}
+}
+
+// Returns the region map index and pixel index within the region maps of the global position,
+// as get_pixel() would read it. Returns false if out of bounds.
+bool Terrain3DData::_get_batch_location(const Vector3 &p_global_position, int &r_map_index, int &r_pixel) const {
+	Vector2i region_loc = get_region_location(p_global_position);
+	r_map_index = get_region_map_index(region_loc);
+	if (r_map_index < 0) {
+		return false;
+	}
+	Vector2i global_offset = region_loc * _region_size;
+	Vector3 descaled_pos = p_global_position / _vertex_spacing;
+	Vector2i img_pos = Vector2i(descaled_pos.x - global_offset.x, descaled_pos.z - global_offset.y);
+	img_pos = img_pos.clamp(V2I_ZERO, Vector2i(_region_size - 1, _region_size - 1));
+	r_pixel = img_pos.y * _region_size + img_pos.x;
+	return true;
+}
+
+// Same as get_pixel(p_map_type, p_global_position).r for the height and control maps, reading from
+// the buffers of p_maps
+float Terrain3DData::_get_batch_pixel(BatchMaps &p_maps, const MapType p_map_type, const Vector3 &p_global_position) const {
+	int map_index, pixel;
+	if (!_get_batch_location(p_global_position, map_index, pixel)) {
+		return NAN;
+	}
+	if (!p_maps.resolved[map_index]) {
+		_resolve_batch_region(p_maps, map_index);
+	}
+	const float *map = (p_map_type == TYPE_HEIGHT) ? p_maps.height[map_index] : p_maps.control[map_index];
+	return map ? map[pixel] : NAN;
+}
+
+// Batched get_height() of each position + p_offset. It follows get_height() and calls the same
+// bilerp(), so results are bit identical, including NAN for holes and missing regions.
+void Terrain3DData::_get_batch_heights(BatchMaps &p_maps, const Vector3 *p_positions, const int p_count,
+		const Vector3 &p_offset, float *r_heights) const {
+	const real_t &step = _vertex_spacing;
+	for (int i = 0; i < p_count; i++) {
+		Vector3 pos = p_positions[i] + p_offset;
+		real_t control = _get_batch_pixel(p_maps, TYPE_CONTROL, pos);
+		if (is_hole(std::isnan(control) ? UINT32_MAX : as_uint(control))) {
+			r_heights[i] = NAN;
+			continue;
+		}
+		pos.y = 0.f;
+		Vector3 pos_round = pos.snapped(Vector3(step, 0.f, step));
+		if ((pos - pos_round).length() < 0.01f) {
+			r_heights[i] = _get_batch_pixel(p_maps, TYPE_HEIGHT, pos);
+			continue;
+		}
+		Vector3 pos00 = Vector3(floor(pos.x / step) * step, 0.f, floor(pos.z / step) * step);
+		Vector3 pos11 = pos00 + Vector3(step, 0.f, step);
+		real_t ht00 = _get_batch_pixel(p_maps, TYPE_HEIGHT, pos00);
+		real_t ht01 = _get_batch_pixel(p_maps, TYPE_HEIGHT, pos00 + Vector3(0.f, 0.f, step));
+		real_t ht10 = _get_batch_pixel(p_maps, TYPE_HEIGHT, pos00 + Vector3(step, 0.f, 0.f));
+		real_t ht11 = _get_batch_pixel(p_maps, TYPE_HEIGHT, pos11);
+		r_heights[i] = bilerp(ht00, ht01, ht10, ht11, pos00, pos11, pos);
+	}
+}
+
+// Batched get_normal(). Fills r_heights with get_height() of each position as a byproduct.
+void Terrain3DData::_get_batch_normals(BatchMaps &p_maps, const Vector3 *p_positions, const int p_count,
+		float *r_heights, Vector3 *r_normals) const {
+	PackedFloat32Array offset_heights;
+	offset_heights.resize(p_count * 2);
+	float *heights_x = offset_heights.ptrw();
+	float *heights_z = heights_x + p_count;
+	_get_batch_heights(p_maps, p_positions, p_count, V3_ZERO, r_heights);
+	_get_batch_heights(p_maps, p_positions, p_count, Vector3(_vertex_spacing, 0.f, 0.f), heights_x);
+	_get_batch_heights(p_maps, p_positions, p_count, Vector3(0.f, 0.f, _vertex_spacing), heights_z);
+
+	for (int i = 0; i < p_count; i++) {
+		const Vector3 &pos = p_positions[i];
+		real_t control = _get_batch_pixel(p_maps, TYPE_CONTROL, pos);
+		if (get_region_idp(pos) < 0 || is_hole(std::isnan(control) ? UINT32_MAX : as_uint(control))) {
+			r_normals[i] = Vector3(NAN, NAN, NAN);
+			continue;
+		}
+		real_t height = r_heights[i];
+		real_t u = height - heights_x[i];
+		real_t v = height - heights_z[i];
+		Vector3 normal = Vector3(u, _vertex_spacing, v);
+		normal.normalize();
+		r_normals[i] = normal;
+	}
+}
+
+// Recalculates the height pyramid cells covering the given region local quads, then propagates
+// them up through the coarser levels. A quad spans from its pixel to the next pixel in +X and +Z,
+// which may be in a neighboring region. Holes and quads missing a corner have no surface and are
+// excluded, as get_height() returns NAN there. Cells with any quad the shader doesn't draw, as a
+// corner is a hole or missing, are also flagged in the hole pyramid.
+void Terrain3DData::_update_height_mips(Terrain3DRegion *p_region, const Rect2i &p_quads) {
+	Vector<PackedVector2Array> &mips = p_region->_height_mips;
+	Vector<PackedByteArray> &hole_mips = p_region->_hole_mips;
+	if (mips.is_empty() || !p_quads.has_area()) {
+		return;
+	}
+	const int cells = _region_size / HEIGHT_MIP_CELL_SIZE;
+	const Vector2i region_offset = p_region->get_location() * _region_size;
+	const float *heights = reinterpret_cast<const float *>(p_region->get_map_ptr(TYPE_HEIGHT)->ptr());
+	const float *controls = reinterpret_cast<const float *>(p_region->get_map_ptr(TYPE_CONTROL)->ptr());
+	auto get_quad_height = [&](const int p_x, const int p_z) -> real_t {
+		if (p_x < _region_size && p_z < _region_size) {
+			return heights[p_z * _region_size + p_x];
+		}
+		return _get_map_pixel(TYPE_HEIGHT, region_offset + Vector2i(p_x, p_z));
+	};
+	auto is_quad_hole = [&](const int p_x, const int p_z) -> bool {
+		if (p_x < _region_size && p_z < _region_size) {
+			return is_hole(controls[p_z * _region_size + p_x]);
+		}
+		return is_hole(float(_get_map_pixel(TYPE_CONTROL, region_offset + Vector2i(p_x, p_z))));
+	};
+
+	// Finest level, from the height map
+	Rect2i cell_rect;
+	cell_rect.position = p_quads.position / HEIGHT_MIP_CELL_SIZE;
+	cell_rect.size = (p_quads.get_end() - Vector2i(1, 1)) / HEIGHT_MIP_CELL_SIZE + Vector2i(1, 1) - cell_rect.position;
+	Vector2 *leaves = mips.write[0].ptrw();
+	uint8_t *hole_leaves = hole_mips.write[0].ptrw();
+	for (int cz = cell_rect.position.y; cz < cell_rect.get_end().y; cz++) {
+		for (int cx = cell_rect.position.x; cx < cell_rect.get_end().x; cx++) {
+			Vector2 range = Vector2(FLT_MAX, -FLT_MAX);
+			bool holes = false;
+			for (int z = cz * HEIGHT_MIP_CELL_SIZE; z < (cz + 1) * HEIGHT_MIP_CELL_SIZE; z++) {
+				for (int x = cx * HEIGHT_MIP_CELL_SIZE; x < (cx + 1) * HEIGHT_MIP_CELL_SIZE; x++) {
+					if (is_hole(controls[z * _region_size + x])) {
+						holes = true;
+						continue;
+					}
+					real_t h00 = heights[z * _region_size + x];
+					real_t h10 = get_quad_height(x + 1, z);
+					real_t h01 = get_quad_height(x, z + 1);
+					real_t h11 = get_quad_height(x + 1, z + 1);
+					if (std::isnan(h00) || std::isnan(h10) || std::isnan(h01) || std::isnan(h11)) {
+						holes = true;
+						continue;
+					}
+					holes = holes || is_quad_hole(x + 1, z) || is_quad_hole(x, z + 1) || is_quad_hole(x + 1, z + 1);
+					range.x = MIN(range.x, MIN(MIN(h00, h10), MIN(h01, h11)));
+					range.y = MAX(range.y, MAX(MAX(h00, h10), MAX(h01, h11)));
+				}
+			}
+			leaves[cz * cells + cx] = range;
+			hole_leaves[cz * cells + cx] = holes ? 1 : 0;
+		}
+	}
+
+	// Coarser levels, from the 4 children below
+	for (int level = 1; level < mips.size(); level++) {
+		Vector2i end = (cell_rect.get_end() - Vector2i(1, 1)) / 2 + Vector2i(1, 1);
+		cell_rect.position = cell_rect.position / 2;
+		cell_rect.size = end - cell_rect.position;
+		const int child_cells = cells >> (level - 1);
+		const int parent_cells = cells >> level;
+		const Vector2 *children = mips[level - 1].ptr();
+		Vector2 *parents = mips.write[level].ptrw();
+		const uint8_t *hole_children = hole_mips[level - 1].ptr();
+		uint8_t *hole_parents = hole_mips.write[level].ptrw();
+		for (int cz = cell_rect.position.y; cz < end.y; cz++) {
+			for (int cx = cell_rect.position.x; cx < end.x; cx++) {
+				const int child = cz * 2 * child_cells + cx * 2;
+				const Vector2 *c = children + child;
+				parents[cz * parent_cells + cx] = Vector2(
+						MIN(MIN(c[0].x, c[1].x), MIN(c[child_cells].x, c[child_cells + 1].x)),
+						MAX(MAX(c[0].y, c[1].y), MAX(c[child_cells].y, c[child_cells + 1].y)));
+				const uint8_t *h = hole_children + child;
+				hole_parents[cz * parent_cells + cx] = h[0] | h[1] | h[child_cells] | h[child_cells + 1];
+			}
+		}
+	}
+}
+
+// Updates the height pyramids of all regions with quads touching the changed global pixels
+void Terrain3DData::_update_height_mips_area(const Rect2i &p_pixels) {
+	// Quads using the changed pixels as their +X or +Z corners begin one pixel earlier
+	Rect2i quads = p_pixels.grow_individual(1, 1, 0, 0);
+	Vector2i loc_start = V2I_DIVIDE_FLOOR(quads.position, _region_size);
+	Vector2i loc_end = V2I_DIVIDE_FLOOR(quads.get_end() - Vector2i(1, 1), _region_size);
+	loc_start = loc_start.clamp(-REGION_MAP_VSIZE / 2, REGION_MAP_VSIZE / 2 - Vector2i(1, 1));
+	loc_end = loc_end.clamp(-REGION_MAP_VSIZE / 2, REGION_MAP_VSIZE / 2 - Vector2i(1, 1));
+	for (int y = loc_start.y; y <= loc_end.y; y++) {
+		for (int x = loc_start.x; x <= loc_end.x; x++) {
+			Vector2i region_loc = Vector2i(x, y);
+			Terrain3DRegion *region = _get_region_ptr(region_loc);
+			if (!region) {
+				continue;
+			}
+			Rect2i region_quads = Rect2i(region_loc * _region_size, _region_sizev);
+			Rect2i local_quads = quads.intersection(region_quads);
+			local_quads.position -= region_quads.position;
+			_update_height_mips(region, local_quads);
+		}
+	}
+}
+
+// Intersects the ray with the bilinear surface of one quad, as interpolated by get_height(),
+// between ray distances p_t0 and p_t1. Ray and quad are in region pixel space on XZ and world
+// units on Y. Returns the first distance where the ray is at or below the surface.
+bool Terrain3DData::_intersect_quad(const Terrain3DRegion *p_region, const Vector3 &p_origin, const Vector3 &p_dir,
+		const Vector2i &p_quad, const real_t p_t0, const real_t p_t1, real_t &r_t) const {
+	const Vector2i pixel = p_region->get_location() * _region_size + p_quad;
+	if (is_hole(float(_get_map_pixel(TYPE_CONTROL, pixel)))) {
+		return false;
+	}
+	const real_t h00 = _get_map_pixel(TYPE_HEIGHT, pixel);
+	const real_t h10 = _get_map_pixel(TYPE_HEIGHT, pixel + Vector2i(1, 0));
+	const real_t h01 = _get_map_pixel(TYPE_HEIGHT, pixel + Vector2i(0, 1));
+	const real_t h11 = _get_map_pixel(TYPE_HEIGHT, pixel + Vector2i(1, 1));
+	if (std::isnan(h00) || std::isnan(h10) || std::isnan(h01) || std::isnan(h11)) {
+		return false;
+	}
+
+	// With s = t - p_t0, the ray is at quad coordinates u + dir.x * s, v + dir.z * s. The surface
+	// there is h00 + b*u + c*v + d*u*v, so ray height minus surface height is c0 + c1*s + c2*s^2
+	const real_t u = p_origin.x + p_dir.x * p_t0 - p_quad.x;
+	const real_t v = p_origin.z + p_dir.z * p_t0 - p_quad.y;
+	const real_t y = p_origin.y + p_dir.y * p_t0;
+	const real_t b = h10 - h00;
+	const real_t c = h01 - h00;
+	const real_t d = h00 - h10 - h01 + h11;
+	const real_t c0 = y - (h00 + b * u + c * v + d * u * v);
+	const real_t c1 = p_dir.y - (b * p_dir.x + c * p_dir.z + d * (u * p_dir.z + v * p_dir.x));
+	const real_t c2 = -d * p_dir.x * p_dir.z;
+	const real_t length = p_t1 - p_t0;
+	if (c0 <= 0.f) {
+		r_t = p_t0; // Entered the quad at or below the surface
+		return true;
+	}
+	real_t s = -1.f;
+	if (Math::abs(c2) < CMP_EPSILON2) {
+		if (c1 < 0.f) {
+			s = -c0 / c1;
+		}
+	} else {
+		const real_t discriminant = c1 * c1 - 4.f * c2 * c0;
+		if (discriminant >= 0.f) {
+			// Numerically stable form, avoiding cancellation between c1 and the root
+			const real_t q = -0.5f * (c1 + (c1 < 0.f ? -1.f : 1.f) * Math::sqrt(discriminant));
+			real_t s1 = q / c2;
+			real_t s2 = (q != 0.f) ? c0 / q : s1;
+			if (s1 > s2) {
+				std::swap(s1, s2);
+			}
+			s = (s1 >= 0.f) ? s1 : s2;
+		}
+	}
+	if (s >= 0.f && s <= length) {
+		r_t = p_t0 + s;
+		return true;
+	}
+	// Catch grazing hits lost to precision at the exit edge
+	if (c0 + (c1 + c2 * length) * length <= 0.f) {
+		r_t = p_t1;
+		return true;
+	}
+	return false;
+}
+
+// Walks the ray through the region local quads in order with a 2D DDA, intersecting each one
+bool Terrain3DData::_intersect_quads(const Terrain3DRegion *p_region, const Vector3 &p_origin, const Vector3 &p_dir,
+		const Rect2i &p_quads, const real_t p_t0, const real_t p_t1, real_t &r_t) const {
+	Vector2i quad = Vector2i(Math::floor(p_origin.x + p_dir.x * p_t0), Math::floor(p_origin.z + p_dir.z * p_t0));
+	quad = quad.clamp(p_quads.position, p_quads.get_end() - Vector2i(1, 1));
+	const Vector2i step = Vector2i(p_dir.x > 0.f ? 1 : -1, p_dir.z > 0.f ? 1 : -1);
+	const Vector2 delta = Vector2(p_dir.x != 0.f ? Math::abs(1.f / p_dir.x) : FLT_MAX,
+			p_dir.z != 0.f ? Math::abs(1.f / p_dir.z) : FLT_MAX);
+	Vector2 next = Vector2(p_dir.x != 0.f ? (quad.x + (step.x > 0 ? 1 : 0) - p_origin.x) / p_dir.x : FLT_MAX,
+			p_dir.z != 0.f ? (quad.y + (step.y > 0 ? 1 : 0) - p_origin.z) / p_dir.z : FLT_MAX);
+	real_t t = p_t0;
+	while (true) {
+		real_t t_exit = CLAMP(MIN(next.x, next.y), t, p_t1);
+		if (_intersect_quad(p_region, p_origin, p_dir, quad, t, t_exit, r_t)) {
+			return true;
+		}
+		if (t_exit >= p_t1) {
+			return false;
+		}
+		t = t_exit;
+		if (next.x < next.y) {
+			quad.x += step.x;
+			next.x += delta.x;
+		} else {
+			quad.y += step.y;
+			next.y += delta.y;
+		}
+		if (!p_quads.has_point(quad)) {
+			return false;
+		}
+	}
+}
+
+// Tests the ray against a height pyramid cell, skipping it if the ray stays above its height
+// range, otherwise descends into its children front to back, down to the quads.
+bool Terrain3DData::_intersect_height_mip(const Terrain3DRegion *p_region, const Vector3 &p_origin, const Vector3 &p_dir,
+		const int p_level, const Vector2i &p_cell, const real_t p_t0, const real_t p_t1, real_t &r_t) const {
+	const int cells = (_region_size / HEIGHT_MIP_CELL_SIZE) >> p_level;
+	const Vector2 range = p_region->_height_mips[p_level][p_cell.y * cells + p_cell.x];
+	const real_t y0 = p_origin.y + p_dir.y * p_t0;
+	const real_t y1 = p_origin.y + p_dir.y * p_t1;
+	// Also skips empty cells, which have an inverted range. Rays below the surface still descend,
+	// as being at or below it counts as a hit.
+	if (MIN(y0, y1) > range.y) {
+		return false;
+	}
+	const int quads = HEIGHT_MIP_CELL_SIZE << p_level;
+	if (p_level == 0) {
+		return _intersect_quads(p_region, p_origin, p_dir, Rect2i(p_cell * quads, Vector2i(quads, quads)), p_t0, p_t1, r_t);
+	}
+
+	struct Child {
+		Vector2i cell;
+		real_t t0;
+		real_t t1;
+	};
+	Child children[4];
+	int count = 0;
+	const real_t child_size = real_t(quads / 2);
+	for (int i = 0; i < 4; i++) {
+		Child child = { p_cell * 2 + Vector2i(i & 1, i >> 1), p_t0, p_t1 };
+		Rect2 area = Rect2(Vector2(child.cell) * child_size, Vector2(child_size, child_size));
+		if (!clip_ray_to_rect(p_origin, p_dir, area, child.t0, child.t1)) {
+			continue;
+		}
+		int j = count++;
+		for (; j > 0 && children[j - 1].t0 > child.t0; j--) {
+			children[j] = children[j - 1];
+		}
+		children[j] = child;
+	}
+	for (int i = 0; i < count; i++) {
+		if (_intersect_height_mip(p_region, p_origin, p_dir, p_level - 1, children[i].cell, children[i].t0, children[i].t1, r_t)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// See get_area_height_range(). If given, r_gaps is set if any of the area is outside of regions or
+// over holes, or none of it has a surface, so the terrain there doesn't hide what's behind it.
+Vector2 Terrain3DData::_get_area_height_range(const Rect2 &p_global_area, bool *r_gaps) const {
+	Vector2i pixel_start = Vector2i((p_global_area.position / _vertex_spacing).floor());
+	Vector2i pixel_end = Vector2i((p_global_area.get_end() / _vertex_spacing).ceil()) + Vector2i(1, 1); // Exclusive
+	Vector2i loc_start = V2I_DIVIDE_FLOOR(pixel_start, _region_size);
+	Vector2i loc_end = V2I_DIVIDE_FLOOR(pixel_end - Vector2i(1, 1), _region_size);
+	int span = MAX(pixel_end.x - pixel_start.x, pixel_end.y - pixel_start.y);
+	Vector2 range = Vector2(FLT_MAX, -FLT_MAX);
+	bool outside = false;
+	bool holes = false;
+	bool background_edge = false; // Area includes a region edge the world background blends into
+	Ref<Terrain3DMaterial> material = _terrain ? _terrain->get_material() : Ref<Terrain3DMaterial>();
+	Vector2 background = material.is_valid() ? material->get_background_height_range() : V2_ZERO;
+	for (int rz = loc_start.y; rz <= loc_end.y; rz++) {
+		for (int rx = loc_start.x; rx <= loc_end.x; rx++) {
+			Vector2i region_loc = Vector2i(rx, rz);
+			const Terrain3DRegion *region = _get_region_ptr(region_loc);
+			if (region == nullptr) {
+				outside = true;
+				continue;
+			}
+			if (background != V2_ZERO && !background_edge) {
+				for (int i = 0; i < 9 && !background_edge; i++) {
+					background_edge = _get_region_ptr(region_loc + Vector2i(i % 3 - 1, i / 3 - 1)) == nullptr;
+				}
+			}
+			const Vector<PackedVector2Array> &mips = region->_height_mips;
+			if (mips.is_empty()) {
+				Vector2 region_range = region->get_height_range();
+				range = Vector2(MIN(range.x, region_range.x), MAX(range.y, region_range.y));
+				holes = true; // Unknown
+				continue;
+			}
+			int level = 0;
+			while (level < mips.size() - 1 && (HEIGHT_MIP_CELL_SIZE << level) * 2 < span) {
+				level++;
+			}
+			int cell_size = HEIGHT_MIP_CELL_SIZE << level;
+			int cells = (_region_size / HEIGHT_MIP_CELL_SIZE) >> level;
+			Vector2i offset = region_loc * _region_size;
+			Vector2i last = Vector2i(_region_size - 1, _region_size - 1);
+			Vector2i cell_start = (pixel_start - offset).clamp(V2I_ZERO, last) / cell_size;
+			Vector2i cell_end = (pixel_end - Vector2i(1, 1) - offset).clamp(V2I_ZERO, last) / cell_size;
+			const Vector2 *level_cells = mips[level].ptr();
+			const uint8_t *hole_cells = region->_hole_mips[level].ptr();
+			for (int cz = cell_start.y; cz <= cell_end.y; cz++) {
+				for (int cx = cell_start.x; cx <= cell_end.x; cx++) {
+					Vector2 cell_range = level_cells[cz * cells + cx];
+					if (cell_range.x <= cell_range.y) {
+						range = Vector2(MIN(range.x, cell_range.x), MAX(range.y, cell_range.y));
+					}
+					holes = holes || hole_cells[cz * cells + cx];
+				}
+			}
+		}
+	}
+	if (background_edge && range.x <= range.y) {
+		range += background;
+	}
+	if (outside) {
+		range = Vector2(MIN(range.x, background.x), MAX(range.y, background.y));
+	}
+	if (r_gaps) {
+		*r_gaps = outside || holes || range.x > range.y;
+	}
+	return (range.x <= range.y) ? range : V2_ZERO;
+}
+
 ///////////////////////////
 // Public Functions
 ///////////////////////////
@@ -449,34 +1284,31 @@ void Terrain3DData::force_update_maps(const MapType p_map_type, const bool p_gen
 	LOG(EXTREME, "Regenerating maps of type: ", p_map_type);
 	switch (p_map_type) {
 		case TYPE_HEIGHT:
-			_generated_height_maps.clear();
+			_generated_height_maps.set_dirty();
 			break;
 		case TYPE_CONTROL:
-			_generated_control_maps.clear();
+			_generated_control_maps.set_dirty();
 			break;
 		case TYPE_COLOR:
-			_generated_color_maps.clear();
+			_generated_color_maps.set_dirty();
 			break;
 		default:
-			_generated_height_maps.clear();
-			_generated_control_maps.clear();
-			_generated_color_maps.clear();
+			_generated_height_maps.set_dirty();
+			_generated_control_maps.set_dirty();
+			_generated_color_maps.set_dirty();
 			_region_map_dirty = true;
 			break;
 	}
 	if (p_generate_mipmaps && (p_map_type == TYPE_COLOR || p_map_type == TYPE_MAX)) {
-		LOG(EXTREME, "Regenerating color mipmaps");
-		for (int i = 0; i < _region_locations.size(); i++) {
-			Vector2i region_loc = _region_locations[i];
-			Ref<Terrain3DRegion> region = get_region(region_loc);
-			region->get_color_map()->generate_mipmaps();
-		}
+		_generate_color_mipmaps = true; // On the worker thread, with the color array
 	}
 	update_maps();
 }
 
 void Terrain3DData::update_maps(const MapType p_map_type) {
 	bool any_changed = false;
+	// Layers are updated below in the bound arrays, so a pending build must be in place first
+	wait_for_maps();
 
 	if (_region_map_dirty) {
 		LOG(EXTREME, "Regenerating ", REGION_MAP_VSIZE, " region map array from active regions");
@@ -497,10 +1329,37 @@ void Terrain3DData::update_maps(const MapType p_map_type) {
 				}
 			}
 		}
+		_update_region_table();
 		any_changed = true;
 		emit_signal("region_map_changed");
 	}
 
+	// When streaming, the arrays share slot assignments, so they're rebuilt together. They only hold
+	// the regions near the camera, so this is cheap. Summaries are rebuilt for the dirty maps, or all
+	// if the region map changed.
+	const bool streaming = _is_streaming();
+	if (streaming) {
+		bool rebuild = any_changed;
+		for (int type = 0; type < TYPE_MAX; type++) {
+			if (any_changed || _get_generated_maps(MapType(type))->is_dirty()) {
+				_summary_maps[type].unref();
+				rebuild = true;
+			}
+		}
+		if (rebuild) {
+			_generated_height_maps.set_dirty();
+			_generated_control_maps.set_dirty();
+			_generated_color_maps.set_dirty();
+			_slot_locations.clear();
+			_update_region_table();
+			_update_residency(false);
+		}
+	} else if (!_slot_locations.is_empty()) {
+		_clear_streaming();
+	}
+
+	// The CPU side arrays are updated now, the texture arrays on a worker thread
+	bool rebuild_types[TYPE_MAX] = {};
 	if (_generated_height_maps.is_dirty()) {
 		LOG(EXTREME, "Regenerating height texture array from regions");
 		_height_maps.clear();
@@ -515,7 +1374,7 @@ void Terrain3DData::update_maps(const MapType p_map_type) {
 				return;
 			}
 		}
-		_generated_height_maps.create(_height_maps);
+		rebuild_types[TYPE_HEIGHT] = true;
 		calc_height_range();
 		any_changed = true;
 		emit_signal("height_maps_changed");
@@ -529,7 +1388,7 @@ void Terrain3DData::update_maps(const MapType p_map_type) {
 			Ref<Terrain3DRegion> region = get_region(region_loc);
 			_control_maps.push_back(region->get_control_map());
 		}
-		_generated_control_maps.create(_control_maps);
+		rebuild_types[TYPE_CONTROL] = true;
 		any_changed = true;
 		emit_signal("control_maps_changed");
 	}
@@ -542,7 +1401,7 @@ void Terrain3DData::update_maps(const MapType p_map_type) {
 			Ref<Terrain3DRegion> region = get_region(region_loc);
 			_color_maps.push_back(region->get_color_map());
 		}
-		_generated_color_maps.create(_color_maps);
+		rebuild_types[TYPE_COLOR] = true;
 		any_changed = true;
 		emit_signal("color_maps_changed");
 	}
@@ -550,61 +1409,95 @@ void Terrain3DData::update_maps(const MapType p_map_type) {
 	if (!any_changed) {
 		// If no maps have been rebuilt, it's safe to update individual layers. Regions marked Edited
 		// have either been recently changed by Terrain3DEditor::_operate_map or were marked by undo / redo.
+		bool edited = false;
 		for (int i = 0; i < _region_locations.size(); i++) {
 			Vector2i region_loc = _region_locations[i];
 			Ref<Terrain3DRegion> region = _regions[region_loc];
 			if (region->is_edited()) {
+				edited = true;
 				int region_id = get_region_id(region_loc);
 				switch (p_map_type) {
 					case TYPE_HEIGHT:
-						_generated_height_maps.update(region->get_height_map(), region_id);
-						emit_signal("height_maps_changed");
-						break;
 					case TYPE_CONTROL:
-						_generated_control_maps.update(region->get_control_map(), region_id);
-						emit_signal("control_maps_changed");
-						break;
 					case TYPE_COLOR:
-						_generated_color_maps.update(region->get_color_map(), region_id);
-						emit_signal("color_maps_changed");
+						_update_layer(p_map_type, region.ptr(), region_id);
 						break;
 					default:
-						_generated_height_maps.update(region->get_height_map(), region_id);
-						_generated_control_maps.update(region->get_control_map(), region_id);
-						_generated_color_maps.update(region->get_color_map(), region_id);
-						emit_signal("height_maps_changed");
-						emit_signal("control_maps_changed");
-						emit_signal("color_maps_changed");
+						_update_layer(TYPE_HEIGHT, region.ptr(), region_id);
+						_update_layer(TYPE_CONTROL, region.ptr(), region_id);
+						_update_layer(TYPE_COLOR, region.ptr(), region_id);
 						break;
 				}
 			}
 		}
+		if (edited) {
+			if (p_map_type == TYPE_HEIGHT || p_map_type == TYPE_MAX) {
+				emit_signal("height_maps_changed");
+			}
+			if (p_map_type == TYPE_CONTROL || p_map_type == TYPE_MAX) {
+				emit_signal("control_maps_changed");
+			}
+			if (p_map_type == TYPE_COLOR || p_map_type == TYPE_MAX) {
+				emit_signal("color_maps_changed");
+			}
+		}
+	}
+	_update_region_table();
+	update_height_mips();
+	if (rebuild_types[TYPE_HEIGHT] || rebuild_types[TYPE_CONTROL] || rebuild_types[TYPE_COLOR]) {
+		_start_map_build(rebuild_types);
+	} else {
+		_bind_texture_maps();
 	}
 	emit_signal("maps_changed");
 }
 
+/**
+ * Blocks until texture arrays being rebuilt on a worker thread are ready, then swaps them in.
+ * Use before reading the texture arrays or their RIDs right after changing regions.
+ */
+void Terrain3DData::wait_for_maps() {
+	if (_map_build != nullptr) {
+		_apply_map_build(_map_build->id);
+	}
+}
+
+// Pages regions in and out of the texture arrays as the camera crosses region boundaries. The
+// location is kept while streaming is disabled, so enabling it starts around the camera.
+void Terrain3DData::update_streaming(const Vector3 &p_cam_pos) {
+	Vector2i center = get_region_location(p_cam_pos);
+	if (center == _streaming_center) {
+		return;
+	}
+	_streaming_center = center;
+	if (!_is_streaming() || _map_build != nullptr || _region_map_dirty || _slot_locations.is_empty() ||
+			_generated_height_maps.is_dirty() || _generated_control_maps.is_dirty() || _generated_color_maps.is_dirty()) {
+		return; // Slots are assigned when the maps are next updated
+	}
+	LOG(DEBUG, "Streaming region textures around region: ", center);
+	_update_residency(true);
+	_bind_texture_maps();
+	emit_signal("maps_changed");
+}
+
 void Terrain3DData::set_pixel(const MapType p_map_type, const Vector3 &p_global_position, const Color &p_pixel) {
 	if (p_map_type < 0 || p_map_type >= TYPE_MAX) {
 		LOG(ERROR, "Specified map type out of range");
 		return;
 	}
 	Vector2i region_loc = get_region_location(p_global_position);
-	Ref<Terrain3DRegion> region = get_region(region_loc);
-	if (region.is_null()) {
+	Terrain3DRegion *region = _get_region_ptr(region_loc);
+	if (!region) {
 		LOG(ERROR, "No active region found at: ", p_global_position);
 		return;
 	}
-	if (region->is_deleted()) {
-		LOG(ERROR, "No active region found at: ", p_global_position);
-		return;
-	}
-	Vector2i global_offset = region_loc * _region_size;
-	Vector3 descaled_pos = p_global_position / _vertex_spacing;
-	Vector2i img_pos = Vector2i(descaled_pos.x - global_offset.x, descaled_pos.z - global_offset.y);
-	img_pos = img_pos.clamp(V2I_ZERO, Vector2i(_region_size - 1, _region_size - 1));
-	Ref<Image> map = region->get_map(p_map_type);
-	map->set_pixelv(img_pos, p_pixel);
+	Vector2i img_pos = _get_pixel_position(region_loc, p_global_position);
+	region->get_map_ptr(p_map_type)->set_pixelv(img_pos, p_pixel);
 	region->set_modified(true);
+	if (p_map_type != TYPE_COLOR) {
+		Rect2i pixel = Rect2i(region_loc * _region_size + img_pos, Vector2i(1, 1));
+		_height_mips_dirty = _height_mips_dirty.has_area() ? _height_mips_dirty.merge(pixel) : pixel;
+	}
 }
 
 Color Terrain3DData::get_pixel(const MapType p_map_type, const Vector3 &p_global_position) const {
@@ -613,19 +1506,12 @@ Color Terrain3DData::get_pixel(const MapType p_map_type, const Vector3 &p_global
 		return COLOR_NAN;
 	}
 	Vector2i region_loc = get_region_location(p_global_position);
-	Ref<Terrain3DRegion> region = get_region(region_loc);
-	if (region.is_null()) {
+	const Terrain3DRegion *region = _get_region_ptr(region_loc);
+	if (!region) {
 		return COLOR_NAN;
 	}
-	if (region->is_deleted()) {
-		return COLOR_NAN;
-	}
-	Vector2i global_offset = region_loc * _region_size;
-	Vector3 descaled_pos = p_global_position / _vertex_spacing;
-	Vector2i img_pos = Vector2i(descaled_pos.x - global_offset.x, descaled_pos.z - global_offset.y);
-	img_pos = img_pos.clamp(V2I_ZERO, Vector2i(_region_size - 1, _region_size - 1));
-	Ref<Image> map = region->get_map(p_map_type);
-	return map->get_pixelv(img_pos);
+	Vector2i img_pos = _get_pixel_position(region_loc, p_global_position);
+	return region->get_map_ptr(p_map_type)->get_pixelv(img_pos);
 }
 
 real_t Terrain3DData::get_height(const Vector3 &p_global_position) const {
@@ -639,17 +1525,17 @@ real_t Terrain3DData::get_height(const Vector3 &p_global_position) const {
 	Vector3 pos_round = pos.snapped(Vector3(step, 0.f, step));
 	// If requested position is close to a vertex, return its height
 	if ((pos - pos_round).length() < 0.01f) {
-		return get_pixel(TYPE_HEIGHT, pos).r;
+		return _get_pixel_r(TYPE_HEIGHT, pos);
 	} else {
 		// Otherwise, bilinearly interpolate 4 surrounding vertices
 		Vector3 pos00 = Vector3(floor(pos.x / step) * step, 0.f, floor(pos.z / step) * step);
-		real_t ht00 = get_pixel(TYPE_HEIGHT, pos00).r;
+		real_t ht00 = _get_pixel_r(TYPE_HEIGHT, pos00);
 		Vector3 pos01 = pos00 + Vector3(0.f, 0.f, step);
-		real_t ht01 = get_pixel(TYPE_HEIGHT, pos01).r;
+		real_t ht01 = _get_pixel_r(TYPE_HEIGHT, pos01);
 		Vector3 pos10 = pos00 + Vector3(step, 0.f, 0.f);
-		real_t ht10 = get_pixel(TYPE_HEIGHT, pos10).r;
+		real_t ht10 = _get_pixel_r(TYPE_HEIGHT, pos10);
 		Vector3 pos11 = pos00 + Vector3(step, 0.f, step);
-		real_t ht11 = get_pixel(TYPE_HEIGHT, pos11).r;
+		real_t ht11 = _get_pixel_r(TYPE_HEIGHT, pos11);
 		return bilerp(ht00, ht01, ht10, ht11, pos00, pos11, pos);
 	}
 }
@@ -666,6 +1552,46 @@ Vector3 Terrain3DData::get_normal(const Vector3 &p_global_position) const {
 	return normal;
 }
 
+PackedFloat32Array Terrain3DData::get_heights(const PackedVector3Array &p_global_positions) const {
+	PackedFloat32Array heights;
+	int count = p_global_positions.size();
+	if (count == 0) {
+		return heights;
+	}
+	heights.resize(count);
+	BatchMaps maps;
+	_get_batch_heights(maps, p_global_positions.ptr(), count, V3_ZERO, heights.ptrw());
+	return heights;
+}
+
+PackedVector3Array Terrain3DData::get_normals(const PackedVector3Array &p_global_positions) const {
+	PackedVector3Array normals;
+	int count = p_global_positions.size();
+	if (count == 0) {
+		return normals;
+	}
+	normals.resize(count);
+	PackedFloat32Array heights;
+	heights.resize(count);
+	BatchMaps maps;
+	_get_batch_normals(maps, p_global_positions.ptr(), count, heights.ptrw(), normals.ptrw());
+	return normals;
+}
+
+// Returns [ PackedFloat32Array heights, PackedVector3Array normals ]
+Array Terrain3DData::get_heights_and_normals(const PackedVector3Array &p_global_positions) const {
+	PackedFloat32Array heights;
+	PackedVector3Array normals;
+	int count = p_global_positions.size();
+	if (count > 0) {
+		heights.resize(count);
+		normals.resize(count);
+		BatchMaps maps;
+		_get_batch_normals(maps, p_global_positions.ptr(), count, heights.ptrw(), normals.ptrw());
+	}
+	return Array::make(heights, normals);
+}
+
 bool Terrain3DData::is_in_slope(const Vector3 &p_global_position, const Vector2 &p_slope_range, const bool p_invert) const {
 	// If slope is full range, it's disabled
 	const Vector2 slope_range = CLAMP(p_slope_range, V2_ZERO, Vector2(90.f, 90.f));
@@ -754,6 +1680,132 @@ Vector3 Terrain3DData::get_texture_id(const Vector3 &p_global_position) const {
 	return Vector3(real_t(base_id), real_t(overlay_id), blend);
 }
 
+/**
+ * Batched get_texture_id(), get_color() and get_roughness(), such as for footsteps or audio.
+ * The auto shader settings are read once per batch, and only the regions the positions fall in
+ * are looked up. Returns a Dictionary of packed arrays with one entry per position:
+ *  base_id, overlay_id: PackedInt32Array. -1 in holes or outside of regions
+ *  blend: PackedFloat32Array. 0-1 blend of the overlay over the base texture, NAN where the ids are -1
+ *  color: PackedColorArray. Color map RGB with alpha 1, COLOR_NAN outside of regions
+ *  roughness: PackedFloat32Array. Color map alpha, where 0.5 is unchanged, NAN outside of regions
+ *  wetness: PackedFloat32Array. 0-1 as painted by the wetness tool, which lowers roughness below 0.5
+ */
+Dictionary Terrain3DData::get_surface_samples(const PackedVector3Array &p_global_positions) const {
+	int count = p_global_positions.size();
+	PackedInt32Array base_ids;
+	PackedInt32Array overlay_ids;
+	PackedFloat32Array blends;
+	PackedColorArray colors;
+	PackedFloat32Array roughnesses;
+	PackedFloat32Array wetnesses;
+	base_ids.resize(count);
+	overlay_ids.resize(count);
+	blends.resize(count);
+	colors.resize(count);
+	roughnesses.resize(count);
+	wetnesses.resize(count);
+
+	if (count > 0) {
+		BatchMaps maps;
+		maps.use_color = true;
+		const Vector3 *positions = p_global_positions.ptr();
+		int32_t *base_id = base_ids.ptrw();
+		int32_t *overlay_id = overlay_ids.ptrw();
+		float *blend = blends.ptrw();
+		Color *color = colors.ptrw();
+		float *roughness = roughnesses.ptrw();
+		float *wetness = wetnesses.ptrw();
+
+		// Auto shader settings
+		bool auto_enabled = false;
+		real_t auto_slope = 0.f;
+		real_t auto_height_reduction = 0.f;
+		int32_t auto_base_id = 0;
+		int32_t auto_overlay_id = 0;
+		if (_terrain != nullptr && _terrain->get_material().is_valid()) {
+			Ref<Terrain3DMaterial> t_material = _terrain->get_material();
+			auto_enabled = t_material->get_auto_shader();
+			if (auto_enabled) {
+				auto_slope = real_t(t_material->get_shader_param("auto_slope")) * 2.f - 1.f;
+				auto_height_reduction = real_t(t_material->get_shader_param("auto_height_reduction"));
+				auto_base_id = int32_t(t_material->get_shader_param("auto_base_texture"));
+				auto_overlay_id = int32_t(t_material->get_shader_param("auto_overlay_texture"));
+			}
+		}
+
+		Vector<int> auto_indices;
+		for (int i = 0; i < count; i++) {
+			int map_index, pixel;
+			if (_get_batch_location(positions[i], map_index, pixel) && !maps.resolved[map_index]) {
+				_resolve_batch_region(maps, map_index);
+			}
+			if (map_index < 0 || maps.control[map_index] == nullptr) {
+				base_id[i] = -1;
+				overlay_id[i] = -1;
+				blend[i] = NAN;
+				color[i] = COLOR_NAN;
+				roughness[i] = NAN;
+				wetness[i] = NAN;
+				continue;
+			}
+			const uint8_t *texel = maps.color[map_index] ? maps.color[map_index] + pixel * 4 : nullptr;
+			if (texel) {
+				color[i] = Color(texel[0] / 255.f, texel[1] / 255.f, texel[2] / 255.f, 1.f);
+				roughness[i] = texel[3] / 255.f;
+				wetness[i] = CLAMP((.5f - roughness[i]) * 2.f, 0.f, 1.f);
+			} else {
+				color[i] = COLOR_NAN;
+				roughness[i] = NAN;
+				wetness[i] = NAN;
+			}
+			uint32_t control = as_uint(maps.control[map_index][pixel]);
+			if (is_hole(control)) {
+				base_id[i] = -1;
+				overlay_id[i] = -1;
+				blend[i] = NAN;
+			} else if (auto_enabled && is_auto(control)) {
+				auto_indices.push_back(i);
+			} else {
+				base_id[i] = get_base(control);
+				overlay_id[i] = get_overlay(control);
+				blend[i] = float(get_blend(control)) / 255.f;
+			}
+		}
+
+		// Auto shader pixels blend by slope and height, as in get_texture_id()
+		if (!auto_indices.is_empty()) {
+			int auto_count = auto_indices.size();
+			Vector<Vector3> auto_positions;
+			Vector<float> heights;
+			Vector<Vector3> normals;
+			auto_positions.resize(auto_count);
+			heights.resize(auto_count);
+			normals.resize(auto_count);
+			for (int j = 0; j < auto_count; j++) {
+				auto_positions.write[j] = positions[auto_indices[j]];
+			}
+			_get_batch_normals(maps, auto_positions.ptr(), auto_count, heights.ptrw(), normals.ptrw());
+			for (int j = 0; j < auto_count; j++) {
+				const int index = auto_indices[j];
+				base_id[index] = auto_base_id;
+				overlay_id[index] = auto_overlay_id;
+				blend[index] = CLAMP(normals[j].y * auto_slope * 2.f - auto_slope -
+								auto_height_reduction * .01f * heights[j],
+						0.f, 1.f);
+			}
+		}
+	}
+
+	Dictionary samples;
+	samples["base_id"] = base_ids;
+	samples["overlay_id"] = overlay_ids;
+	samples["blend"] = blends;
+	samples["color"] = colors;
+	samples["roughness"] = roughnesses;
+	samples["wetness"] = wetnesses;
+	return samples;
+}
+
 /**
  * Returns the location of a terrain vertex at a certain LOD. If there is a hole at the position, it returns
  * NAN in the vector's Y coordinate.
@@ -796,12 +1848,125 @@ Vector3 Terrain3DData::get_mesh_vertex(const int32_t p_lod, const HeightFilter p
 	return Vector3(p_global_position.x, height, p_global_position.z);
 }
 
+// Brings the min/max height pyramids used by intersect_ray() up to date. Regions that are new or had
+// their maps replaced are built in full, edited areas are updated incrementally. If disabled with
+// Terrain3D.height_pyramids, any built are freed instead.
+void Terrain3DData::update_height_mips() {
+	if (_terrain != nullptr && !_terrain->get_height_pyramids()) {
+		for (int i = 0; i < _region_table.size(); i++) {
+			Terrain3DRegion *region = _region_table[i].ptr();
+			if (region) {
+				region->_height_mips.clear();
+				region->_hole_mips.clear();
+			}
+		}
+		_height_mips_dirty = Rect2i();
+		return;
+	}
+	if (_region_map_dirty) {
+		return; // Called again at the end of update_maps()
+	}
+	const int cells = _region_size / HEIGHT_MIP_CELL_SIZE;
+	Vector<Terrain3DRegion *> new_regions;
+	for (int i = 0; i < _region_table.size(); i++) {
+		Terrain3DRegion *region = _region_table[i].ptr();
+		if (!region || (!region->_height_mips.is_empty() && region->_height_mips[0].size() == cells * cells)) {
+			continue;
+		}
+		region->_height_mips.clear();
+		region->_hole_mips.clear();
+		for (int n = cells; n > 0; n /= 2) {
+			PackedVector2Array level;
+			level.resize(n * n);
+			region->_height_mips.push_back(level);
+			PackedByteArray hole_level;
+			hole_level.resize(n * n);
+			region->_hole_mips.push_back(hole_level);
+		}
+		new_regions.push_back(region);
+	}
+	// Allocate all first, as quads on the -X and -Z neighbors reach into the new regions
+	for (int i = 0; i < new_regions.size(); i++) {
+		_update_height_mips_area(Rect2i(new_regions[i]->get_location() * _region_size, _region_sizev));
+	}
+	if (_height_mips_dirty.has_area()) {
+		_update_height_mips_area(_height_mips_dirty);
+		_height_mips_dirty = Rect2i();
+	}
+}
+
+// Casts a ray against the terrain surface as interpolated by get_height(), and returns the distance
+// to the first hit in r_distance. Walks the regions along the ray, then descends each region's
+// min/max height pyramid, intersecting only the quads the ray may touch. Holes and areas without
+// regions are not hit. Call update_height_mips() first if the maps have changed.
+bool Terrain3DData::intersect_ray(const Vector3 &p_origin, const Vector3 &p_direction, const real_t p_max_distance, real_t &r_distance) const {
+	const Vector3 direction = p_direction.normalized();
+	if (direction == V3_ZERO || _region_size <= 0 || p_max_distance <= 0.f) {
+		return false;
+	}
+	// Work in pixel space on XZ and world units on Y, so distances remain in world units
+	const Vector3 origin = Vector3(p_origin.x / _vertex_spacing, p_origin.y, p_origin.z / _vertex_spacing);
+	const Vector3 dir = Vector3(direction.x / _vertex_spacing, direction.y, direction.z / _vertex_spacing);
+
+	// Clip to the bounds of the region map
+	const real_t world_size = real_t(REGION_MAP_SIZE * _region_size);
+	real_t t0 = 0.f;
+	real_t t1 = p_max_distance;
+	if (!clip_ray_to_rect(origin, dir, Rect2(-world_size * .5f, -world_size * .5f, world_size, world_size), t0, t1)) {
+		return false;
+	}
+
+	// Walk the regions along the ray with a 2D DDA
+	const int cells = _region_size / HEIGHT_MIP_CELL_SIZE;
+	const Vector2i step = Vector2i(dir.x > 0.f ? 1 : -1, dir.z > 0.f ? 1 : -1);
+	Vector2 start = Vector2(origin.x + dir.x * t0, origin.z + dir.z * t0) / real_t(_region_size);
+	Vector2i region_loc = Vector2i(start.floor()).clamp(-REGION_MAP_VSIZE / 2, REGION_MAP_VSIZE / 2 - Vector2i(1, 1));
+	real_t t = t0;
+	while (get_region_map_index(region_loc) >= 0) {
+		Vector2i offset = region_loc * _region_size;
+		real_t exit_x = (dir.x != 0.f) ? (offset.x + (step.x > 0 ? _region_size : 0) - origin.x) / dir.x : FLT_MAX;
+		real_t exit_z = (dir.z != 0.f) ? (offset.y + (step.y > 0 ? _region_size : 0) - origin.z) / dir.z : FLT_MAX;
+		real_t t_exit = CLAMP(MIN(exit_x, exit_z), t, t1);
+
+		const Terrain3DRegion *region = _get_region_ptr(region_loc);
+		if (region) {
+			Vector3 local_origin = origin - Vector3(offset.x, 0.f, offset.y);
+			const Vector<PackedVector2Array> &mips = region->_height_mips;
+			bool hit = false;
+			if (!mips.is_empty() && mips[0].size() == cells * cells) {
+				hit = _intersect_height_mip(region, local_origin, dir, mips.size() - 1, V2I_ZERO, t, t_exit, r_distance);
+			} else {
+				hit = _intersect_quads(region, local_origin, dir, Rect2i(V2I_ZERO, _region_sizev), t, t_exit, r_distance);
+			}
+			if (hit) {
+				return true;
+			}
+		}
+		if (t_exit >= t1) {
+			break;
+		}
+		t = t_exit;
+		if (exit_x < exit_z) {
+			region_loc.x += step.x;
+		} else {
+			region_loc.y += step.y;
+		}
+	}
+	return false;
+}
+
 void Terrain3DData::add_edited_area(const AABB &p_area) {
 	if (_edited_area.has_surface()) {
 		_edited_area = _edited_area.merge(p_area);
 	} else {
 		_edited_area = p_area;
 	}
+	// Padded a pixel each side as brushes round to the nearest pixel
+	Rect2i pixels;
+	pixels.position = Vector2i((Vector2(p_area.position.x, p_area.position.z) / _vertex_spacing).floor()) - Vector2i(1, 1);
+	pixels.size = Vector2i((Vector2(p_area.get_end().x, p_area.get_end().z) / _vertex_spacing).ceil()) + Vector2i(2, 2) - pixels.position;
+	_height_mips_dirty = _height_mips_dirty.has_area() ? _height_mips_dirty.merge(pixels) : pixels;
+	update_height_mips();
 	emit_signal("maps_edited", p_area);
 }
 
@@ -824,6 +1989,18 @@ void Terrain3DData::calc_height_range(const bool p_recursive) {
 	LOG(EXTREME, "Accumulated height range for all regions: ", _master_height_range);
 }
 
+/**
+ * Returns the min/max height of the terrain over a global XZ area, read from the height pyramids
+ * built for get_intersection(). Each region is read at the finest level where the area spans only
+ * a few cells, so the cost doesn't depend on the area size. The range is conservative, up to one
+ * cell larger than the area. Areas outside of regions count as height 0, or the height range of the
+ * world noise if it's the world background, which also extends the range of regions next to them.
+ * Holes are ignored. Without pyramids, the whole height range of each region is used.
+ */
+Vector2 Terrain3DData::get_area_height_range(const Rect2 &p_global_area) const {
+	return _get_area_height_range(p_global_area);
+}
+
 /**
  * Imports an Image set (Height, Control, Color) into Terrain3DData
  * It does NOT normalize values to 0-1. You must do that using get_min_max() and adjusting scale and offset.
@@ -1155,6 +2332,12 @@ void Terrain3DData::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_height_maps_rid"), &Terrain3DData::get_height_maps_rid);
 	ClassDB::bind_method(D_METHOD("get_control_maps_rid"), &Terrain3DData::get_control_maps_rid);
 	ClassDB::bind_method(D_METHOD("get_color_maps_rid"), &Terrain3DData::get_color_maps_rid);
+	ClassDB::bind_method(D_METHOD("is_updating_maps"), &Terrain3DData::is_updating_maps);
+	ClassDB::bind_method(D_METHOD("wait_for_maps"), &Terrain3DData::wait_for_maps);
+	ClassDB::bind_method(D_METHOD("update_streaming", "camera_position"), &Terrain3DData::update_streaming);
+	ClassDB::bind_method(D_METHOD("is_region_resident", "region_location"), &Terrain3DData::is_region_resident);
+	ClassDB::bind_method(D_METHOD("get_resident_region_map"), &Terrain3DData::get_resident_region_map);
+	ClassDB::bind_method(D_METHOD("get_resident_region_locations"), &Terrain3DData::get_resident_region_locations);
 
 	ClassDB::bind_method(D_METHOD("set_pixel", "map_type", "global_position", "pixel"), &Terrain3DData::set_pixel);
 	ClassDB::bind_method(D_METHOD("get_pixel", "map_type", "global_position"), &Terrain3DData::get_pixel);
@@ -1185,12 +2368,18 @@ void Terrain3DData::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_control_auto", "global_position"), &Terrain3DData::get_control_auto);
 
 	ClassDB::bind_method(D_METHOD("get_normal", "global_position"), &Terrain3DData::get_normal);
+	ClassDB::bind_method(D_METHOD("get_heights", "global_positions"), &Terrain3DData::get_heights);
+	ClassDB::bind_method(D_METHOD("get_normals", "global_positions"), &Terrain3DData::get_normals);
+	ClassDB::bind_method(D_METHOD("get_heights_and_normals", "global_positions"), &Terrain3DData::get_heights_and_normals);
 	ClassDB::bind_method(D_METHOD("is_in_slope", "global_position", "slope_range", "invert"), &Terrain3DData::is_in_slope, DEFVAL(false));
 	ClassDB::bind_method(D_METHOD("get_texture_id", "global_position"), &Terrain3DData::get_texture_id);
+	ClassDB::bind_method(D_METHOD("get_surface_samples", "global_positions"), &Terrain3DData::get_surface_samples);
 	ClassDB::bind_method(D_METHOD("get_mesh_vertex", "lod", "filter", "global_position"), &Terrain3DData::get_mesh_vertex);
 
+	ClassDB::bind_method(D_METHOD("add_edited_area", "global_area"), &Terrain3DData::add_edited_area);
 	ClassDB::bind_method(D_METHOD("get_height_range"), &Terrain3DData::get_height_range);
 	ClassDB::bind_method(D_METHOD("calc_height_range", "recursive"), &Terrain3DData::calc_height_range, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("get_area_height_range", "global_area"), &Terrain3DData::get_area_height_range);
 
 	ClassDB::bind_method(D_METHOD("import_images", "images", "global_position", "offset", "scale"), &Terrain3DData::import_images, DEFVAL(Vector3(0, 0, 0)), DEFVAL(0.0), DEFVAL(1.0));
 	ClassDB::bind_method(D_METHOD("export_image", "file_name", "map_type"), &Terrain3DData::export_image);
@@ -1203,6 +2392,7 @@ void Terrain3DData::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "color_maps", PROPERTY_HINT_ARRAY_TYPE, vformat("%tex_size/%tex_size:%tex_size", Variant::OBJECT, PROPERTY_HINT_RESOURCE_TYPE, "Image"), ro_flags), "", "get_color_maps");
 
 	ADD_SIGNAL(MethodInfo("maps_changed"));
+	ADD_SIGNAL(MethodInfo("maps_rebuilt"));
 	ADD_SIGNAL(MethodInfo("region_map_changed"));
 	ADD_SIGNAL(MethodInfo("height_maps_changed"));
 	ADD_SIGNAL(MethodInfo("control_maps_changed"));
@@ -15,11 +15,14 @@ class Terrain3DData : public Object {
 	GDCLASS(Terrain3DData, Object);
 	CLASS_NAME();
 	friend Terrain3D;
+	friend class Terrain3DCollision;
+	friend class Terrain3DOcclusion;
 
 public: // Constants
-	static inline const real_t CURRENT_VERSION = 0.93f;
+	static inline const real_t CURRENT_VERSION = 0.94f;
 	static inline const int REGION_MAP_SIZE = 32;
 	static inline const Vector2i REGION_MAP_VSIZE = Vector2i(REGION_MAP_SIZE, REGION_MAP_SIZE);
+	static inline const int HEIGHT_MIP_CELL_SIZE = 4; // Quads per side in the finest height pyramid cell
 
 	enum HeightFilter {
 		HEIGHT_FILTER_NEAREST,
@@ -35,6 +38,7 @@ private:
 	real_t _vertex_spacing = 1.f; // Set by Terrain3D::set_vertex_spacing
 
 	AABB _edited_area;
+	Rect2i _height_mips_dirty; // Pixels changed since the height pyramids were last updated
 	Vector2 _master_height_range = V2_ZERO;
 
 	/////////
@@ -70,14 +74,104 @@ private:
 	PackedInt32Array _region_map;
 	bool _region_map_dirty = true;
 
+	// Flat table of active regions indexed by region_id, synced with _region_map in update_maps().
+	// Pixel access uses it instead of `_regions` to skip Variant hashing and Ref counting on every
+	// lookup. Only used while _region_map_dirty is false.
+	Vector<Ref<Terrain3DRegion>> _region_table;
+
 	// These contain the TextureArray RIDs from the RenderingServer
 	GeneratedTexture _generated_height_maps;
 	GeneratedTexture _generated_control_maps;
 	GeneratedTexture _generated_color_maps;
 
+	// Texture streaming, enabled on Terrain3D. Only regions within a radius of the camera are resident
+	// in the texture arrays, each in a fixed slot. The layer after the slots holds a low resolution
+	// summary of all active regions, laid out like the region map, which the shader uses for the rest.
+	Vector2i _streaming_center = V2I_ZERO; // Region location of the camera
+	Vector<Vector2i> _slot_locations; // Region location in each slot, V2I_MAX if free
+	PackedInt32Array _resident_map; // As _region_map, but with slot + 1, or summary layer + 1
+	TypedArray<Vector2i> _resident_locations; // Region location of each layer, for the shader
+	Ref<Image> _summary_maps[TYPE_MAX];
+	PackedByteArray _summary_stale; // By region map index, edited while resident
+
+	// Texture arrays are rebuilt on a worker thread from snapshots of the region maps. The current
+	// arrays stay bound, with the region map they were built for, until the new ones are swapped in on
+	// the main thread.
+	struct MapBuild {
+		Terrain3DData *data = nullptr;
+		uint64_t id = 0;
+		int64_t task_id = -1;
+		bool types[TYPE_MAX] = {}; // Arrays being rebuilt
+		bool generate_mipmaps = false; // Of the color maps
+		int region_size = 0;
+		Vector<Vector2i> locations; // Of active regions, by region_id
+		Vector<Ref<Image>> maps[TYPE_MAX]; // Snapshots, by region_id
+		Vector<Ref<Image>> color_maps; // Region color maps the mipmaps are written back to
+		Vector<PackedByteArray> color_data; // Their data at the snapshot, to detect edits since
+		bool streaming = false;
+		Vector<Vector2i> slot_locations;
+		Ref<Image> summaries[TYPE_MAX]; // Reused if valid, else built
+		TypedArray<Image> layers[TYPE_MAX]; // Result
+	};
+	MapBuild *_map_build = nullptr;
+	uint64_t _map_build_count = 0;
+	bool _generate_color_mipmaps = false;
+
+	// The region map and locations sent to the shader, matching the bound texture arrays
+	PackedInt32Array _texture_region_map;
+	TypedArray<Vector2i> _texture_region_locations;
+	int _texture_summary_layer = -2;
+
+	// Raw map buffers for batch queries, indexed by region map index. A region is resolved the first
+	// time a sample falls in it, so a call only visits the regions its positions reach.
+	struct BatchMaps {
+		std::array<const float *, REGION_MAP_SIZE * REGION_MAP_SIZE> height = {};
+		std::array<const float *, REGION_MAP_SIZE * REGION_MAP_SIZE> control = {};
+		std::array<const uint8_t *, REGION_MAP_SIZE * REGION_MAP_SIZE> color = {}; // RGBA8, if requested
+		std::array<bool, REGION_MAP_SIZE * REGION_MAP_SIZE> resolved = {};
+		bool use_color = false;
+		Vector<Ref<Image>> converted; // Copies of maps not in the region format, kept alive
+	};
+
 	// Functions
 	void _clear();
 	void _copy_paste_dfr(const Terrain3DRegion *p_src_region, const Rect2i &p_src_rect, const Rect2i &p_dst_rect, const Terrain3DRegion *p_dst_region);
+	void _update_region_table();
+	void _update_layer(const MapType p_map_type, Terrain3DRegion *p_region, const int p_region_id);
+	GeneratedTexture *_get_generated_maps(const MapType p_map_type);
+	bool _is_streaming() const;
+	int _get_slot_count() const;
+	int _get_resident_slot(const Vector2i &p_region_loc) const;
+	void _update_residency(const bool p_upload);
+	void _clear_streaming();
+	void _update_summary_tile(const MapType p_map_type, const Terrain3DRegion *p_region);
+	static void _blit_summary_tile(Image *p_summary, const Ref<Image> &p_map, const MapType p_map_type, const int p_map_index);
+	static Ref<Image> _get_summary_layer(const Ref<Image> &p_summary, const MapType p_map_type);
+	void _start_map_build(const bool *p_types);
+	static void _run_map_build(void *p_build);
+	void _apply_map_build(const uint64_t p_id);
+	void _discard_map_build();
+	void _bind_texture_maps();
+	Terrain3DRegion *_get_region_ptr(const Vector2i &p_region_loc) const;
+	Vector2i _get_pixel_position(const Vector2i &p_region_loc, const Vector3 &p_global_position) const;
+	real_t _get_pixel_r(const MapType p_map_type, const Vector3 &p_global_position) const;
+	real_t _get_map_pixel(const MapType p_map_type, const Vector2i &p_global_pixel) const;
+	void _update_height_mips(Terrain3DRegion *p_region, const Rect2i &p_quads);
+	void _update_height_mips_area(const Rect2i &p_pixels);
+	Vector2 _get_area_height_range(const Rect2 &p_global_area, bool *r_gaps = nullptr) const;
+	bool _intersect_quad(const Terrain3DRegion *p_region, const Vector3 &p_origin, const Vector3 &p_dir,
+			const Vector2i &p_quad, const real_t p_t0, const real_t p_t1, real_t &r_t) const;
+	bool _intersect_quads(const Terrain3DRegion *p_region, const Vector3 &p_origin, const Vector3 &p_dir,
+			const Rect2i &p_quads, const real_t p_t0, const real_t p_t1, real_t &r_t) const;
+	bool _intersect_height_mip(const Terrain3DRegion *p_region, const Vector3 &p_origin, const Vector3 &p_dir,
+			const int p_level, const Vector2i &p_cell, const real_t p_t0, const real_t p_t1, real_t &r_t) const;
+	void _resolve_batch_region(BatchMaps &r_maps, const int p_map_index) const;
+	bool _get_batch_location(const Vector3 &p_global_position, int &r_map_index, int &r_pixel) const;
+	float _get_batch_pixel(BatchMaps &p_maps, const MapType p_map_type, const Vector3 &p_global_position) const;
+	void _get_batch_heights(BatchMaps &p_maps, const Vector3 *p_positions, const int p_count,
+			const Vector3 &p_offset, float *r_heights) const;
+	void _get_batch_normals(BatchMaps &p_maps, const Vector3 *p_positions, const int p_count,
+			float *r_heights, Vector3 *r_normals) const;
 
 public:
 	Terrain3DData() {}
@@ -136,6 +230,15 @@ public:
 	RID get_height_maps_rid() const { return _generated_height_maps.get_rid(); }
 	RID get_control_maps_rid() const { return _generated_control_maps.get_rid(); }
 	RID get_color_maps_rid() const { return _generated_color_maps.get_rid(); }
+	bool is_updating_maps() const { return _map_build != nullptr; }
+	void wait_for_maps();
+	PackedInt32Array get_texture_region_map() const { return _texture_region_map; }
+	TypedArray<Vector2i> get_texture_region_locations() const { return _texture_region_locations; }
+	int get_texture_summary_layer() const { return _texture_summary_layer; }
+	void update_streaming(const Vector3 &p_cam_pos);
+	bool is_region_resident(const Vector2i &p_region_loc) const { return _get_resident_slot(p_region_loc) >= 0; }
+	PackedInt32Array get_resident_region_map() const { return _resident_map; }
+	TypedArray<Vector2i> get_resident_region_locations() const { return _resident_locations; }
 
 	void set_pixel(const MapType p_map_type, const Vector3 &p_global_position, const Color &p_pixel);
 	Color get_pixel(const MapType p_map_type, const Vector3 &p_global_position) const;
@@ -167,9 +270,15 @@ public:
 	bool get_control_auto(const Vector3 &p_global_position) const;
 
 	Vector3 get_normal(const Vector3 &p_global_position) const;
+	PackedFloat32Array get_heights(const PackedVector3Array &p_global_positions) const;
+	PackedVector3Array get_normals(const PackedVector3Array &p_global_positions) const;
+	Array get_heights_and_normals(const PackedVector3Array &p_global_positions) const;
 	bool is_in_slope(const Vector3 &p_global_position, const Vector2 &p_slope_range, const bool p_invert = false) const;
 	Vector3 get_texture_id(const Vector3 &p_global_position) const;
+	Dictionary get_surface_samples(const PackedVector3Array &p_global_positions) const;
 	Vector3 get_mesh_vertex(const int32_t p_lod, const HeightFilter p_filter, const Vector3 &p_global_position) const;
+	void update_height_mips();
+	bool intersect_ray(const Vector3 &p_origin, const Vector3 &p_direction, const real_t p_max_distance, real_t &r_distance) const;
 
 	void add_edited_area(const AABB &p_area);
 	void clear_edited_area() { _edited_area = AABB(); }
@@ -179,6 +288,7 @@ public:
 	void update_master_height(const real_t p_height);
 	void update_master_heights(const Vector2 &p_low_high);
 	void calc_height_range(const bool p_recursive = false);
+	Vector2 get_area_height_range(const Rect2 &p_global_area) const;
 
 	void import_images(const TypedArray<Image> &p_images, const Vector3 &p_global_position = V3_ZERO,
 			const real_t p_offset = 0.f, const real_t p_scale = 1.f);
@@ -242,6 +352,62 @@ inline Ref<Terrain3DRegion> Terrain3DData::get_regionp(const Vector3 &p_global_p
 
 // Inline Map Functions
 
+// Returns the active region at the location, or nullptr. Reads from the region table when it is
+// current, otherwise falls back to `_regions` between adding or removing regions and update_maps().
+inline Terrain3DRegion *Terrain3DData::_get_region_ptr(const Vector2i &p_region_loc) const {
+	Terrain3DRegion *region = nullptr;
+	if (_region_map_dirty) {
+		region = get_region(p_region_loc).ptr(); // Kept alive by _regions
+	} else {
+		int region_id = get_region_id(p_region_loc);
+		if (region_id >= 0 && region_id < _region_table.size()) {
+			region = _region_table[region_id].ptr();
+		}
+	}
+	return (region && !region->is_deleted()) ? region : nullptr;
+}
+
+// Returns the pixel coordinates of the global position within the region map images
+inline Vector2i Terrain3DData::_get_pixel_position(const Vector2i &p_region_loc, const Vector3 &p_global_position) const {
+	Vector2i global_offset = p_region_loc * _region_size;
+	Vector3 descaled_pos = p_global_position / _vertex_spacing;
+	Vector2i img_pos = Vector2i(descaled_pos.x - global_offset.x, descaled_pos.z - global_offset.y);
+	return img_pos.clamp(V2I_ZERO, Vector2i(_region_size - 1, _region_size - 1));
+}
+
+// Same as get_pixel(p_map_type, p_global_position).r for the FORMAT_RF height and control maps,
+// reading the image buffer directly.
+inline real_t Terrain3DData::_get_pixel_r(const MapType p_map_type, const Vector3 &p_global_position) const {
+	Vector2i region_loc = get_region_location(p_global_position);
+	Terrain3DRegion *region = _get_region_ptr(region_loc);
+	if (!region) {
+		return NAN;
+	}
+	Image *map = region->get_map_ptr(p_map_type);
+	Vector2i img_pos = _get_pixel_position(region_loc, p_global_position);
+	if (_region_map_dirty) {
+		// Region sizes are only validated when the table is built
+		return map->get_pixelv(img_pos).r;
+	}
+	return reinterpret_cast<const float *>(map->ptr())[img_pos.y * _region_size + img_pos.x];
+}
+
+// Returns the red channel of the FORMAT_RF height or control map at the global pixel coordinates,
+// or NAN if there is no region.
+inline real_t Terrain3DData::_get_map_pixel(const MapType p_map_type, const Vector2i &p_global_pixel) const {
+	Vector2i region_loc = V2I_DIVIDE_FLOOR(p_global_pixel, _region_size);
+	Terrain3DRegion *region = _get_region_ptr(region_loc);
+	if (!region) {
+		return NAN;
+	}
+	Image *map = region->get_map_ptr(p_map_type);
+	Vector2i img_pos = p_global_pixel - region_loc * _region_size;
+	if (_region_map_dirty) {
+		return map->get_pixelv(img_pos).r;
+	}
+	return reinterpret_cast<const float *>(map->ptr())[img_pos.y * _region_size + img_pos.x];
+}
+
 inline void Terrain3DData::set_height(const Vector3 &p_global_position, const real_t p_height) {
 	set_pixel(TYPE_HEIGHT, p_global_position, Color(p_height, 0.f, 0.f, 1.f));
 }
@@ -263,7 +429,7 @@ inline void Terrain3DData::set_control(const Vector3 &p_global_position, const u
 }
 
 inline uint32_t Terrain3DData::get_control(const Vector3 &p_global_position) const {
-	real_t val = get_pixel(TYPE_CONTROL, p_global_position).r;
+	real_t val = _get_pixel_r(TYPE_CONTROL, p_global_position);
 	return (std::isnan(val)) ? UINT32_MAX : as_uint(val);
 }
 
@@ -177,6 +177,12 @@ void Terrain3DEditor::_operate_map(const Vector3 &p_global_position, const real_
 	// need to track if _added_removed_locations has changed between now and the end of the loop
 	int regions_added_removed = _added_removed_locations.size();
 
+	// Region and map of the last brush pixel. Most neighboring pixels share a region, so these are
+	// only looked up again when crossing a region boundary.
+	Vector2i region_loc = V2I_MAX;
+	Ref<Terrain3DRegion> region;
+	Image *map = nullptr;
+
 	for (real_t x = 0.f; x < brush_size; x += vertex_spacing) {
 		for (real_t y = 0.f; y < brush_size; y += vertex_spacing) {
 			Vector2 brush_offset = Vector2(x, y) - (Vector2(brush_size, brush_size) / 2.f);
@@ -184,17 +190,18 @@ void Terrain3DEditor::_operate_map(const Vector3 &p_global_position, const real_
 					Vector3(p_global_position.x + brush_offset.x + .5f, p_global_position.y,
 							p_global_position.z + brush_offset.y + .5f);
 
-			// Get region for current brush pixel global position
-			Vector2i region_loc = data->get_region_location(brush_global_position);
-			Ref<Terrain3DRegion> region = _operate_region(region_loc);
+			// Get region and map for this tool at current brush pixel global position
+			Vector2i brush_region_loc = data->get_region_location(brush_global_position);
+			if (brush_region_loc != region_loc) {
+				region_loc = brush_region_loc;
+				region = _operate_region(region_loc);
+				map = region.is_valid() ? region->get_map_ptr(map_type) : nullptr;
+			}
 			// If no region and can't make one, skip
 			if (region.is_null()) {
 				continue;
 			}
 
-			// Get map for this region and tool
-			Ref<Image> map = region->get_map(map_type);
-
 			// Identify position on map image
 			Vector2 uv_position = _get_uv_position(brush_global_position, region_size, vertex_spacing);
 			Vector2i map_pixel_position = Vector2i(uv_position * region_size);
@@ -471,8 +478,7 @@ void Terrain3DEditor::_operate_map(const Vector3 &p_global_position, const real_
 			} else if (map_type == TYPE_COLOR) {
 				// Filter by visible texture
 				if (enable_texture) {
-					Ref<Image> map = region->get_map(TYPE_CONTROL);
-					real_t src_ctrl = map->get_pixelv(map_pixel_position).r;
+					real_t src_ctrl = region->get_map_ptr(TYPE_CONTROL)->get_pixelv(map_pixel_position).r;
 					int tex_id = (get_blend(src_ctrl) > 110 + int(_brush_data.get("margin", 0))) ? get_overlay(src_ctrl) : get_base(src_ctrl);
 					if (tex_id != asset_id) {
 						continue;
@@ -505,13 +511,18 @@ void Terrain3DEditor::_operate_map(const Vector3 &p_global_position, const real_
 			}
 			backup_region(region);
 			map->set_pixelv(map_pixel_position, dest);
+			region->add_dirty_rect(map_type, Rect2i(map_pixel_position, Vector2i(1, 1)));
 		}
 	}
-	// Regenerate color mipmaps for edited regions
+	// Regenerate color mipmaps under the pixels changed in edited regions. The dirty rects are
+	// consumed as layers are uploaded, so they only hold this operation.
 	if (map_type == TYPE_COLOR) {
 		for (int i = 0; i < _edited_regions.size(); i++) {
-			Ref<Terrain3DRegion> region = _edited_regions[i];
-			region->get_map(map_type)->generate_mipmaps();
+			Ref<Terrain3DRegion> edited_region = _edited_regions[i];
+			Rect2i rect = edited_region->get_dirty_rect(TYPE_COLOR);
+			if (rect.has_area()) {
+				Util::update_mipmaps(edited_region->get_map(map_type), rect);
+			}
 		}
 	}
 	// If no added or removed regions, update only changed texture array layers from the edited regions in the rendering server
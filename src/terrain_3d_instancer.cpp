@@ -1,9 +1,14 @@
 // Copyright © 2025 Cory Petkovsek, Roope Palmroos, and Contributors.
 
 #include <godot_cpp/classes/resource_saver.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/classes/world3d.hpp>
+#include <algorithm>
+#include <unordered_set>
 
 #include "logger.h"
 #include "terrain_3d_instancer.h"
+#include "terrain_3d_occlusion.h"
 #include "terrain_3d_region.h"
 #include "terrain_3d_util.h"
 
@@ -11,11 +16,15 @@
 // Private Functions
 ///////////////////////////
 
-// Creates MMIs based on stored Multimesh data
+// Creates MMIs based on stored Multimesh data. While streaming, cells out of range are left for
+// update_streaming() to create.
 void Terrain3DInstancer::_update_mmis(const Vector2i &p_region_loc, const int p_mesh_id) {
 	IS_DATA_INIT(VOID);
 	LOG(INFO, "Updating MMIs for ", (p_region_loc.x == INT32_MAX) ? "all regions" : "region " + String(p_region_loc),
 			(p_mesh_id == -1) ? ", all meshes" : ", mesh " + String::num_int64(p_mesh_id));
+	uint64_t time = Time::get_singleton()->get_ticks_usec();
+	bool streaming = _terrain->get_instancer_streaming();
+	int built = 0;
 
 	// For specified region_location, or max for all
 	Array region_locations;
@@ -31,17 +40,14 @@ void Terrain3DInstancer::_update_mmis(const Vector2i &p_region_loc, const int p_
 			LOG(WARN, "Errant null region found at: ", region_loc);
 			continue;
 		}
-		Dictionary mesh_inst_dict = region->get_instances();
+		Terrain3DRegion::InstanceMeshes &meshes = region->get_instance_meshes();
 
 		// For specified mesh id in that region, or -1 for all
-		Array mesh_types;
-		if (p_mesh_id < 0) {
-			mesh_types = mesh_inst_dict.keys();
-		} else {
-			mesh_types.push_back(p_mesh_id);
-		}
-		for (int m = 0; m < mesh_types.size(); m++) {
-			int mesh_id = mesh_types[m];
+		for (auto &mesh_it : meshes) {
+			int mesh_id = mesh_it.first;
+			if (p_mesh_id >= 0 && mesh_id != p_mesh_id) {
+				continue;
+			}
 
 			// Verify mesh id is valid and has a mesh
 			Ref<Terrain3DMeshAsset> ma = _terrain->get_assets()->get_mesh_asset(mesh_id);
@@ -56,87 +62,120 @@ void Terrain3DInstancer::_update_mmis(const Vector2i &p_region_loc, const int p_
 				LOG(WARN, "MeshAsset ", mesh_id, " is null, skipping");
 				continue;
 			}
+			real_t stream_distance = _get_streaming_distance(ma);
 
-			Dictionary cell_inst_dict = mesh_inst_dict[mesh_id];
-			Array cell_locations = cell_inst_dict.keys();
-			for (int c = 0; c < cell_locations.size(); c++) {
-				// Get instances
-				Vector2i cell = cell_locations[c];
-				Array triple = cell_inst_dict[cell];
-				if (triple.size() < 3) {
-					LOG(WARN, "Triple is empty");
+			for (auto &cell_it : mesh_it.second) {
+				Vector2i cell = cell_it.first;
+				Terrain3DRegion::InstanceCell &instances = cell_it.second;
+				if (instances.get_count() == 0) {
+					LOG(WARN, "Empty cell in region ", region_loc, " cell ", cell);
 					continue;
 				}
-				TypedArray<Transform3D> xforms = triple[0];
-				PackedColorArray colors = triple[1];
-				bool modified = triple[2];
-				if (xforms.size() == 0) {
-					LOG(WARN, "Empty cell in region ", region_loc, " cell ", cell);
+				if (streaming && !_has_cell_mmi(region_loc, mesh_id, cell) &&
+						_get_cell_distance(region_loc, cell) > stream_distance) {
 					continue;
 				}
+				built += _update_cell_mmis(region, mesh_id, ma, cell, instances);
+			}
+		}
+	}
+	LOG(DEBUG, "Built ", built, " MMIs in ", (Time::get_singleton()->get_ticks_usec() - time) / 1000.f, " ms");
+}
 
-				// Create MMI container if needed
-				String rname("Region" + Util::location_to_string(region_loc));
-				if (_mmi_containers.count(region_loc) == 0) {
-					LOG(DEBUG, "Creating new region MMI container Terrain3D/MMI/", rname);
-					Node3D *node = memnew(Node3D);
-					node->set_name(rname);
-					_mmi_containers[region_loc] = node;
-					_terrain->get_mmi_parent()->add_child(node, true);
-				}
+// Creates or updates the MMIs of a cell, one per LOD, and returns the number built
+int Terrain3DInstancer::_update_cell_mmis(const Ref<Terrain3DRegion> &p_region, const int p_mesh_id, const Ref<Terrain3DMeshAsset> &p_ma,
+		const Vector2i &p_cell, Terrain3DRegion::InstanceCell &p_instances) {
+	Vector2i region_loc = p_region->get_location();
+	bool use_nodes = _terrain->get_instancer_mode() == Terrain3D::INSTANCER_NODES;
+	bool modified = p_instances.modified;
+	int built = 0;
+
+	// Create MMI container if needed
+	String rname("Region" + Util::location_to_string(region_loc));
+	if (use_nodes && _mmi_containers.count(region_loc) == 0) {
+		LOG(DEBUG, "Creating new region MMI container Terrain3D/MMI/", rname);
+		Node3D *node = memnew(Node3D);
+		node->set_name(rname);
+		_mmi_containers[region_loc] = node;
+		_terrain->get_mmi_parent()->add_child(node, true);
+	}
 
-				// Retrieve MMI or create one
-				MeshMMIDict &mesh_mmi_dict = _mmi_nodes[region_loc];
-
-				int lod = 0; // TODO Hard coded LOD0 for now
-				Vector2i mesh_key(mesh_id, lod);
-				CellMMIDict &cell_mmi_dict = mesh_mmi_dict[mesh_key];
-
-				MultiMeshInstance3D *mmi;
-				if (cell_mmi_dict.count(cell) == 0) {
-					mmi = memnew(MultiMeshInstance3D);
-					LOG(DEBUG, "No MMI found, Created new MultiMeshInstance3D: ", uint64_t(mmi));
-					// Node name is MMI3D_Cell##_##_Mesh#
-					String cstring = "_C" + Util::location_to_string(cell).trim_prefix("_");
-					mmi->set_name("MMI3D" + cstring + "_M" + String::num_int64(mesh_id));
-					mmi->set_as_top_level(true);
-					mmi->set_cast_shadows_setting(ma->get_cast_shadows());
-					mmi->set_visibility_range_end(ma->get_visibility_range());
-					// Review margin when implementing lods
-					//mmi->set_visibility_range_end_margin(ma->get_visibility_margin());
-					cell_mmi_dict[cell] = mmi;
-					//Attach to tree
-					Node *node_container = _terrain->get_mmi_parent()->get_node_internal(rname);
-					if (node_container == nullptr) {
-						LOG(ERROR, rname, " isn't attached to the tree.");
-						continue;
-					}
-					node_container->add_child(mmi, true);
-					// New MMI, cannot skip
-					modified = true;
-				}
-				// If data hasn't changed since last _update_mmis, skip
-				if (modified == false) {
+	// Retrieve MMIs or create them, one per LOD, each shown within its LOD range. The
+	// margins are hysteresis, so LODs swap without both being drawn.
+	MeshMMIDict &mesh_mmi_dict = _mmi_nodes[region_loc];
+	for (int lod = 0; lod < p_ma->get_lod_count(); lod++) {
+		Vector2i mesh_key(p_mesh_id, lod);
+		CellMMIDict &cell_mmi_dict = mesh_mmi_dict[mesh_key];
+		bool lod_modified = modified;
+
+		if (cell_mmi_dict.count(p_cell) == 0) {
+			CellMMI &new_mmi = cell_mmi_dict[p_cell];
+			new_mmi.cast_shadows = RenderingServer::ShadowCastingSetting(p_ma->get_cast_shadows());
+			Vector2 lod_range = p_ma->get_lod_range(lod);
+			real_t margin = p_ma->get_visibility_margin();
+			real_t begin_margin = (lod > 0) ? margin : 0.f;
+			if (use_nodes) {
+				MultiMeshInstance3D *mmi = memnew(MultiMeshInstance3D);
+				LOG(DEBUG, "No MMI found, Created new MultiMeshInstance3D: ", uint64_t(mmi));
+				// Node name is MMI3D_Cell##_##_Mesh#_LOD#
+				String cstring = "_C" + Util::location_to_string(p_cell).trim_prefix("_");
+				mmi->set_name("MMI3D" + cstring + "_M" + String::num_int64(p_mesh_id) + "_L" + String::num_int64(lod));
+				mmi->set_as_top_level(true);
+				mmi->set_cast_shadows_setting(p_ma->get_cast_shadows());
+				mmi->set_visibility_range_begin(lod_range.x);
+				mmi->set_visibility_range_begin_margin(begin_margin);
+				mmi->set_visibility_range_end(lod_range.y);
+				mmi->set_visibility_range_end_margin(margin);
+				new_mmi.node = mmi;
+				//Attach to tree
+				Node *node_container = _terrain->get_mmi_parent()->get_node_internal(rname);
+				if (node_container == nullptr) {
+					LOG(ERROR, rname, " isn't attached to the tree.");
 					continue;
 				}
-
-				// Create MM and assign to MMI
-				mmi = cell_mmi_dict[cell];
-				mmi->set_multimesh(_create_multimesh(mesh_id, xforms, colors));
-
-				// Reposition the MMIs to their region location
-				Transform3D t = Transform3D();
-				int region_size = region->get_region_size();
-				real_t vertex_spacing = _terrain->get_vertex_spacing();
-				t.origin.x += region_loc.x * region_size * vertex_spacing;
-				t.origin.z += region_loc.y * region_size * vertex_spacing;
-				mmi->set_global_transform(t);
-
-				// Set the cell modified state to false
-				triple[2] = false;
+				node_container->add_child(mmi, true);
+			} else {
+				// Matches the defaults of a MultiMeshInstance3D node
+				new_mmi.multimesh = RS->multimesh_create();
+				new_mmi.instance = RS->instance_create2(new_mmi.multimesh, _get_scenario());
+				LOG(DEBUG, "No MMI found, Created new multimesh instance: ", new_mmi.instance);
+				RS->instance_set_visible(new_mmi.instance, _terrain->is_visible_in_tree());
+				RS->instance_geometry_set_cast_shadows_setting(new_mmi.instance, RenderingServer::ShadowCastingSetting(p_ma->get_cast_shadows()));
+				RS->instance_geometry_set_flag(new_mmi.instance, RenderingServer::INSTANCE_FLAG_USE_BAKED_LIGHT, true);
+				RS->instance_geometry_set_visibility_range(new_mmi.instance, lod_range.x, lod_range.y, begin_margin, margin,
+						RenderingServer::VISIBILITY_RANGE_FADE_DISABLED);
 			}
+			// New MMI, cannot skip
+			lod_modified = true;
 		}
+		// If data hasn't changed since last _update_mmis, skip
+		if (lod_modified == false) {
+			continue;
+		}
+
+		// Reposition the MMIs to their region location
+		Transform3D t = Transform3D();
+		int region_size = p_region->get_region_size();
+		real_t vertex_spacing = _terrain->get_vertex_spacing();
+		t.origin.x += region_loc.x * region_size * vertex_spacing;
+		t.origin.z += region_loc.y * region_size * vertex_spacing;
+
+		// Write the changed instances to the MM. Other LODs set the buffer of LOD 0, updated first
+		CellMMI &mmi = cell_mmi_dict[p_cell];
+		const CellMMI *lod0 = (lod > 0) ? &mesh_mmi_dict[Vector2i(p_mesh_id, 0)][p_cell] : nullptr;
+		_update_multimesh(mmi, p_ma->get_mesh(lod), p_instances.xforms, p_instances.colors, p_instances.modified ? p_instances.modified_from : 0, lod0);
+		if (mmi.node != nullptr) {
+			mmi.node->set_global_transform(t);
+		} else {
+			RS->instance_set_transform(mmi.instance, t);
+		}
+		mmi.aabb_valid = false;
+		built++;
 	}
+
+	// Set the cell modified state to false
+	p_instances.modified = false;
+	return built;
 }
 
 void Terrain3DInstancer::_update_vertex_spacing(const real_t p_vertex_spacing) {
@@ -156,30 +195,18 @@ void Terrain3DInstancer::_update_vertex_spacing(const real_t p_vertex_spacing) {
 		}
 
 		// For all mesh_ids in region
-		Dictionary mesh_inst_dict = region->get_instances();
 		LOG(DEBUG, "Updating MMIs from: ", region_loc);
-		Array mesh_types = mesh_inst_dict.keys();
-		for (int m = 0; m < mesh_types.size(); m++) {
-			int mesh_id = mesh_types[m];
-			Dictionary cell_inst_dict = mesh_inst_dict[mesh_id];
-			Array cell_locations = cell_inst_dict.keys();
-			for (int c = 0; c < cell_locations.size(); c++) {
-				// Get instances
-				Vector2i cell = cell_locations[c];
-				Array triple = cell_inst_dict[cell];
-				TypedArray<Transform3D> xforms = triple[0];
-				// Descale, then Scale to the new value
-				for (int i = 0; i < xforms.size(); i++) {
-					Transform3D t = xforms[i];
-					t.origin.x /= old_spacing;
-					t.origin.x *= p_vertex_spacing;
-					t.origin.z /= old_spacing;
-					t.origin.z *= p_vertex_spacing;
-					xforms[i] = t;
+		for (auto &mesh_it : region->get_instance_meshes()) {
+			for (auto &cell_it : mesh_it.second) {
+				// Descale, then Scale the origin X and Z to the new value
+				Terrain3DRegion::InstanceCell &instances = cell_it.second;
+				float *xforms = instances.xforms.ptrw();
+				for (int i = 0; i < instances.get_count(); i++) {
+					float *origin = xforms + i * Terrain3DRegion::XFORM_FLOATS;
+					origin[3] = origin[3] / old_spacing * p_vertex_spacing;
+					origin[11] = origin[11] / old_spacing * p_vertex_spacing;
 				}
-				triple[0] = xforms;
-				triple[2] = true;
-				cell_inst_dict[cell] = triple;
+				instances.set_modified();
 			}
 		}
 		// After all transforms are updated, set the new region vertex spacing value
@@ -196,25 +223,26 @@ void Terrain3DInstancer::_destroy_mmi_by_cell(const Vector2i &p_region_loc, cons
 	}
 	MeshMMIDict &mesh_mmi_dict = _mmi_nodes[p_region_loc];
 
-	// TODO Hardcoded LOD0, loop through lods
-	Vector2i mesh_key(p_mesh_id, 0);
-	if (mesh_mmi_dict.count(mesh_key) == 0) {
-		return;
-	}
-	CellMMIDict &cell_mmi_dict = mesh_mmi_dict[mesh_key];
-
-	if (cell_mmi_dict.count(p_cell) == 0) {
-		return;
+	// Free the MMI of each LOD
+	std::vector<Vector2i> mesh_keys;
+	for (auto &it : mesh_mmi_dict) {
+		if (it.first.x == p_mesh_id) {
+			mesh_keys.push_back(it.first);
+		}
 	}
-	MultiMeshInstance3D *mmi = cell_mmi_dict[p_cell];
-	LOG(EXTREME, "Freeing ", uint64_t(mmi), " and erasing mmi cell ", p_cell);
-	cell_mmi_dict.erase(p_cell);
-	remove_from_tree(mmi);
-	memdelete_safely(mmi);
+	for (const Vector2i &mesh_key : mesh_keys) {
+		CellMMIDict &cell_mmi_dict = mesh_mmi_dict[mesh_key];
+		if (cell_mmi_dict.count(p_cell) == 0) {
+			continue;
+		}
+		LOG(EXTREME, "Freeing and erasing mmi cell ", p_cell, " LOD ", mesh_key.y);
+		_free_cell_mmi(cell_mmi_dict[p_cell]);
+		cell_mmi_dict.erase(p_cell);
 
-	if (cell_mmi_dict.empty()) {
-		LOG(EXTREME, "Removing mesh ", mesh_key, " from cell MMI dictionary");
-		mesh_mmi_dict.erase(mesh_key);
+		if (cell_mmi_dict.empty()) {
+			LOG(EXTREME, "Removing mesh ", mesh_key, " from cell MMI dictionary");
+			mesh_mmi_dict.erase(mesh_key);
+		}
 	}
 
 	if (mesh_mmi_dict.empty()) {
@@ -239,17 +267,15 @@ void Terrain3DInstancer::_destroy_mmi_by_location(const Vector2i &p_region_loc,
 	}
 	MeshMMIDict &mesh_mmi_dict = _mmi_nodes[p_region_loc];
 
-	// TODO Hard coded LOD0 - loop through
-	Vector2i mesh_key(p_mesh_id, 0);
-	CellMMIDict &cell_mmi_dict = mesh_mmi_dict[mesh_key];
-
-	// Iterate over keys as functions will invalidate standard iterator
-	std::vector<Vector2i> keys;
-	keys.reserve(cell_mmi_dict.size());
-	int i = 0;
-	for (auto &it : cell_mmi_dict) {
-		keys.push_back(it.first);
-		i++;
+	// Iterate over keys of all LODs as functions will invalidate standard iterator
+	std::unordered_set<Vector2i, Vector2iHash> keys;
+	for (auto &mesh_it : mesh_mmi_dict) {
+		if (mesh_it.first.x != p_mesh_id) {
+			continue;
+		}
+		for (auto &it : mesh_it.second) {
+			keys.insert(it.first);
+		}
 	}
 	for (auto &cell : keys) {
 		_destroy_mmi_by_cell(p_region_loc, p_mesh_id, cell);
@@ -271,30 +297,120 @@ void Terrain3DInstancer::_backup_region(const Ref<Terrain3DRegion> &p_region) {
 	}
 }
 
-Ref<MultiMesh> Terrain3DInstancer::_create_multimesh(const int p_mesh_id, const TypedArray<Transform3D> &p_xforms, const PackedColorArray &p_colors) const {
+// Writes the instances of a cell to its multimesh. Those before p_from are unchanged since the last
+// update, so only the rest are written to the cell's copy of the buffer, which is then set whole. The
+// multimesh keeps spare capacity, grown by half again when full, so painting rarely reallocates. The
+// spare instances are hidden by the visible count. If p_lod0 is given, its buffer and capacity are
+// used instead, so the LODs of a cell share one CPU copy.
+void Terrain3DInstancer::_update_multimesh(CellMMI &p_mmi, const Ref<Mesh> &p_mesh, const PackedFloat32Array &p_xforms,
+		const PackedColorArray &p_colors, const int p_from, const CellMMI *p_lod0) {
+	const int xform_floats = Terrain3DRegion::XFORM_FLOATS;
+	int count = p_xforms.size() / xform_floats;
+
+	// Node MMIs use a MultiMesh resource, server MMIs the multimesh RID
 	Ref<MultiMesh> mm;
-	IS_INIT(mm);
-	Ref<Terrain3DMeshAsset> mesh_asset = _terrain->get_assets()->get_mesh_asset(p_mesh_id);
-	if (mesh_asset.is_null()) {
-		LOG(ERROR, "No mesh id ", p_mesh_id, " found");
-		return mm;
-	}
-	Ref<Mesh> mesh = mesh_asset->get_mesh();
-	mm.instantiate();
-	mm->set_transform_format(MultiMesh::TRANSFORM_3D);
-	mm->set_use_colors(true);
-	mm->set_mesh(mesh);
-
-	if (p_xforms.size() > 0) {
-		mm->set_instance_count(p_xforms.size());
-		for (int i = 0; i < p_xforms.size(); i++) {
-			mm->set_instance_transform(i, p_xforms[i]);
-			if (i < p_colors.size()) {
-				mm->set_instance_color(i, p_colors[i]);
-			}
+	if (p_mmi.node != nullptr) {
+		mm = p_mmi.node->get_multimesh();
+		if (mm.is_null()) {
+			mm.instantiate();
+			mm->set_transform_format(MultiMesh::TRANSFORM_3D);
+			mm->set_use_colors(true);
+			p_mmi.node->set_multimesh(mm);
+			p_mmi.capacity = 0;
+			p_mmi.mesh = RID();
+		}
+	}
+	RID mesh_rid = p_mesh.is_valid() ? p_mesh->get_rid() : RID();
+	if (p_mmi.mesh != mesh_rid) {
+		if (mm.is_valid()) {
+			mm->set_mesh(p_mesh);
+		} else {
+			RS->multimesh_set_mesh(p_mmi.multimesh, mesh_rid);
+		}
+		p_mmi.mesh = mesh_rid;
+	}
+
+	// Reallocate if full, or mostly empty after removals
+	const int stride = xform_floats + 4;
+	bool shared = p_lod0 != nullptr && p_lod0->capacity >= count && p_lod0->buffer.size() == p_lod0->capacity * stride;
+	int capacity = p_mmi.capacity;
+	if (shared) {
+		capacity = p_lod0->capacity;
+	} else if (count > capacity || count < capacity / 4) {
+		bool grow = capacity > 0 && count > capacity;
+		capacity = grow ? MAX(count, capacity + capacity / 2) : count;
+	}
+	int from = CLAMP(p_from, 0, count);
+	if (capacity != p_mmi.capacity) {
+		p_mmi.capacity = capacity;
+		LOG(EXTREME, "Allocating multimesh for ", count, " instances, capacity ", p_mmi.capacity);
+		if (mm.is_valid()) {
+			mm->set_instance_count(p_mmi.capacity);
+		} else {
+			RS->multimesh_allocate_data(p_mmi.multimesh, p_mmi.capacity, RenderingServer::MULTIMESH_TRANSFORM_3D, true);
 		}
+		from = 0;
+	}
+
+	// The renderer reads a multimesh back from the GPU the first time an instance is set on it, which
+	// stalls the frame. So the buffer is kept here, the changed instances are written into it, and it
+	// is set whole, which is only an upload.
+	if (shared) {
+		p_mmi.buffer = PackedFloat32Array();
+	} else if (from == 0 || p_mmi.buffer.size() != p_mmi.capacity * stride) {
+		p_mmi.buffer = _get_multimesh_buffer(p_xforms, p_colors, p_mmi.capacity);
+	} else {
+		_write_multimesh_buffer(p_mmi.buffer.ptrw(), p_xforms, p_colors, from, count);
+	}
+	const PackedFloat32Array &buffer = shared ? p_lod0->buffer : p_mmi.buffer;
+	if (mm.is_valid()) {
+		mm->set_buffer(buffer);
+	} else {
+		RS->multimesh_set_buffer(p_mmi.multimesh, buffer);
+	}
+	int visible = (count == p_mmi.capacity) ? -1 : count;
+	if (mm.is_valid()) {
+		mm->set_visible_instance_count(visible);
+	} else {
+		RS->multimesh_set_visible_instances(p_mmi.multimesh, visible);
+	}
+}
+
+// Interleaves packed instances into a MultiMesh buffer in one pass, rather than setting them one
+// Variant at a time. Spare capacity is filled with the last instance, so it doesn't grow the AABB.
+PackedFloat32Array Terrain3DInstancer::_get_multimesh_buffer(const PackedFloat32Array &p_xforms, const PackedColorArray &p_colors,
+		const int p_capacity) const {
+	const int stride = Terrain3DRegion::XFORM_FLOATS + 4; // Transform then color
+	int count = MIN(p_xforms.size() / Terrain3DRegion::XFORM_FLOATS, p_capacity);
+	PackedFloat32Array buffer;
+	buffer.resize(p_capacity * stride);
+	float *dst = buffer.ptrw();
+	_write_multimesh_buffer(dst, p_xforms, p_colors, 0, count);
+	dst += count * stride;
+	for (int i = count; i < p_capacity && count > 0; i++) {
+		memcpy(dst, dst - stride, sizeof(float) * stride);
+		dst += stride;
+	}
+	return buffer;
+}
+
+// Writes instances p_from to p_to of the packed instances into their slots of a MultiMesh buffer
+void Terrain3DInstancer::_write_multimesh_buffer(float *r_buffer, const PackedFloat32Array &p_xforms, const PackedColorArray &p_colors,
+		const int p_from, const int p_to) const {
+	const int xform_floats = Terrain3DRegion::XFORM_FLOATS;
+	const int stride = xform_floats + 4;
+	float *dst = r_buffer + p_from * stride;
+	const float *xforms = p_xforms.ptr();
+	const Color *colors = p_colors.ptr();
+	for (int i = p_from; i < p_to; i++) {
+		memcpy(dst, xforms + i * xform_floats, sizeof(float) * xform_floats);
+		Color col = (i < p_colors.size()) ? colors[i] : COLOR_WHITE;
+		dst[xform_floats + 0] = col.r;
+		dst[xform_floats + 1] = col.g;
+		dst[xform_floats + 2] = col.b;
+		dst[xform_floats + 3] = col.a;
+		dst += stride;
 	}
-	return mm;
 }
 
 Vector2i Terrain3DInstancer::_get_cell(const Vector3 &p_global_position, const int p_region_size) {
@@ -305,6 +421,221 @@ Vector2i Terrain3DInstancer::_get_cell(const Vector3 &p_global_position, const i
 	return cell;
 }
 
+// Appends packed transforms in region space, and their colors, to the cells they fall in
+void Terrain3DInstancer::_append_cells(const Ref<Terrain3DRegion> &p_region, const int p_mesh_id,
+		const PackedFloat32Array &p_xforms, const PackedColorArray &p_colors, const bool p_update) {
+	const int xform_floats = Terrain3DRegion::XFORM_FLOATS;
+	int count = MIN(p_xforms.size() / xform_floats, p_colors.size());
+	if (count == 0) {
+		return;
+	}
+	_backup_region(p_region);
+
+	Terrain3DRegion::InstanceCells &cells = p_region->get_instance_meshes()[p_mesh_id];
+	int region_size = p_region->get_region_size();
+	const float *src = p_xforms.ptr();
+	for (int i = 0; i < count; i++) {
+		const float *xform = src + i * xform_floats;
+		Vector2i cell = _get_cell(Vector3(xform[3], 0.f, xform[11]), region_size);
+		Terrain3DRegion::InstanceCell &instances = cells[cell];
+		instances.set_modified(instances.get_count());
+		int64_t offset = instances.xforms.size();
+		instances.xforms.resize(offset + xform_floats);
+		memcpy(instances.xforms.ptrw() + offset, xform, sizeof(float) * xform_floats);
+		instances.colors.push_back(p_colors[i]);
+	}
+	if (p_update) {
+		_update_mmis(p_region->get_location(), p_mesh_id);
+	}
+}
+
+// Hides the MMIs the terrain occludes from the camera, or shows all if p_occlusion is null.
+// Returns the number hidden. Occluded MMIs that cast shadows are kept as shadow casters.
+int Terrain3DInstancer::_update_occlusion(const Terrain3DOcclusion *p_occlusion) {
+	int count = 0;
+	real_t region_width = real_t(_terrain->get_region_size()) * _terrain->get_vertex_spacing();
+	bool visible = _terrain->is_visible_in_tree();
+	for (auto &region_it : _mmi_nodes) {
+		Vector3 region_origin = Vector3(region_it.first.x * region_width, 0.f, region_it.first.y * region_width);
+		for (auto &mesh_it : region_it.second) {
+			for (auto &cell_it : mesh_it.second) {
+				CellMMI &mmi = cell_it.second;
+				bool occluded = false;
+				if (p_occlusion != nullptr) {
+					if (!mmi.aabb_valid) {
+						if (mmi.node != nullptr) {
+							mmi.aabb = mmi.node->get_global_transform().xform(mmi.node->get_aabb());
+						} else {
+							mmi.aabb = RS->multimesh_get_aabb(mmi.multimesh);
+							mmi.aabb.position += region_origin;
+						}
+						mmi.aabb_valid = true;
+					}
+					occluded = p_occlusion->is_occluded(mmi.aabb);
+				}
+				if (occluded != mmi.occluded) {
+					mmi.occluded = occluded;
+					_apply_occlusion(mmi, mmi.node != nullptr ? mmi.node->is_visible_in_tree() : visible);
+				}
+				count += occluded ? 1 : 0;
+			}
+		}
+	}
+	return count;
+}
+
+// Shows or hides an MMI per its occlusion. Occluded MMIs are hidden from the camera, but keep
+// casting shadows into what it can see, such as trees behind a ridge.
+void Terrain3DInstancer::_apply_occlusion(const CellMMI &p_mmi, const bool p_visible) const {
+	RID instance = (p_mmi.node != nullptr) ? p_mmi.node->get_instance() : p_mmi.instance;
+	bool shadows = p_mmi.cast_shadows != RenderingServer::SHADOW_CASTING_SETTING_OFF;
+	RS->instance_set_visible(instance, p_visible && (!p_mmi.occluded || shadows));
+	RS->instance_geometry_set_cast_shadows_setting(instance,
+			(p_mmi.occluded && shadows) ? RenderingServer::SHADOW_CASTING_SETTING_SHADOWS_ONLY : p_mmi.cast_shadows);
+}
+
+// Frees the node or the RenderingServer objects of a cell MMI
+void Terrain3DInstancer::_free_cell_mmi(CellMMI &p_mmi) {
+	if (p_mmi.node != nullptr) {
+		remove_from_tree(p_mmi.node);
+		memdelete_safely(p_mmi.node);
+	}
+	if (p_mmi.instance.is_valid()) {
+		RS->free_rid(p_mmi.instance);
+		p_mmi.instance = RID();
+	}
+	if (p_mmi.multimesh.is_valid()) {
+		RS->free_rid(p_mmi.multimesh);
+		p_mmi.multimesh = RID();
+	}
+	p_mmi.buffer = PackedFloat32Array();
+}
+
+RID Terrain3DInstancer::_get_scenario() const {
+	if (_terrain->is_inside_tree() && _terrain->get_world_3d().is_valid()) {
+		return _terrain->get_world_3d()->get_scenario();
+	}
+	return RID();
+}
+
+// Moves server MMIs to the scenario of the terrain and sets their visibility. Nodes follow the tree.
+void Terrain3DInstancer::_update_scenario(const RID &p_scenario, const bool p_visible) {
+	for (auto &region_it : _mmi_nodes) {
+		for (auto &mesh_it : region_it.second) {
+			for (auto &cell_it : mesh_it.second) {
+				CellMMI &mmi = cell_it.second;
+				if (mmi.instance.is_valid()) {
+					RS->instance_set_scenario(mmi.instance, p_scenario);
+					_apply_occlusion(mmi, p_visible);
+				}
+			}
+		}
+	}
+}
+
+bool Terrain3DInstancer::_has_cell_mmi(const Vector2i &p_region_loc, const int p_mesh_id, const Vector2i &p_cell) const {
+	auto region_it = _mmi_nodes.find(p_region_loc);
+	if (region_it == _mmi_nodes.end()) {
+		return false;
+	}
+	auto mesh_it = region_it->second.find(Vector2i(p_mesh_id, 0));
+	return mesh_it != region_it->second.end() && mesh_it->second.count(p_cell) > 0;
+}
+
+// Returns the horizontal distance from the streaming camera position to the center of a cell
+real_t Terrain3DInstancer::_get_cell_distance(const Vector2i &p_region_loc, const Vector2i &p_cell) const {
+	real_t vertex_spacing = _terrain->get_vertex_spacing();
+	Vector2 center = (Vector2(p_region_loc * _terrain->get_region_size()) + (Vector2(p_cell) + Vector2(.5f, .5f)) * real_t(CELL_SIZE)) * vertex_spacing;
+	return center.distance_to(Vector2(_streaming_position.x, _streaming_position.z));
+}
+
+// Returns the distance within which cells of a mesh are streamed in. The renderer measures the
+// visibility range to the center of the cell AABB, which is never closer than the horizontal distance,
+// so cells beyond this are never visible. Half a cell is added, so they're created a little early.
+real_t Terrain3DInstancer::_get_streaming_distance(const Ref<Terrain3DMeshAsset> &p_ma) const {
+	real_t range = p_ma->get_visibility_range();
+	if (range <= 0.f) {
+		return FLT_MAX; // Unlimited
+	}
+	return range + p_ma->get_visibility_margin() + real_t(CELL_SIZE) * _terrain->get_vertex_spacing() * .5f;
+}
+
+// Queues the cells to create or free around the streaming position. Cells are freed a cell width
+// beyond the streaming distance, so those at the edge don't thrash as the camera moves back and forth.
+// Only regions within range of the camera have their cells scanned. Regions out of range are only
+// visited for their live MMIs, to free them.
+void Terrain3DInstancer::_queue_streaming() {
+	_streaming_queue.clear();
+	Ref<Terrain3DAssets> assets = _terrain->get_assets();
+	real_t hysteresis = real_t(CELL_SIZE) * _terrain->get_vertex_spacing();
+	real_t region_width = real_t(_terrain->get_region_size()) * _terrain->get_vertex_spacing();
+	Vector2 cam_pos = Vector2(_streaming_position.x, _streaming_position.z);
+	real_t max_distance = 0.f;
+	for (int i = 0; i < assets->get_mesh_count(); i++) {
+		Ref<Terrain3DMeshAsset> ma = assets->get_mesh_asset(i);
+		if (ma.is_valid()) {
+			max_distance = MAX(max_distance, _get_streaming_distance(ma));
+		}
+	}
+
+	Array region_locations = _terrain->get_data()->get_region_locations();
+	for (int r = 0; r < region_locations.size(); r++) {
+		Vector2i region_loc = region_locations[r];
+		Rect2 bounds = Rect2(Vector2(region_loc) * region_width, Vector2(region_width, region_width));
+		real_t region_distance = cam_pos.distance_to(cam_pos.clamp(bounds.position, bounds.get_end()));
+		auto mmi_it = _mmi_nodes.find(region_loc);
+		if (region_distance > max_distance && mmi_it == _mmi_nodes.end()) {
+			continue;
+		}
+		Ref<Terrain3DRegion> region = _terrain->get_data()->get_region(region_loc);
+		if (region.is_null()) {
+			continue;
+		}
+		for (const auto &mesh_it : region->get_instance_meshes()) {
+			int mesh_id = mesh_it.first;
+			Ref<Terrain3DMeshAsset> ma = assets->get_mesh_asset(mesh_id);
+			if (ma.is_null()) {
+				continue;
+			}
+			real_t stream_distance = _get_streaming_distance(ma);
+			if (region_distance <= stream_distance) {
+				for (const auto &cell_it : mesh_it.second) {
+					real_t distance = _get_cell_distance(region_loc, cell_it.first);
+					bool has_mmi = _has_cell_mmi(region_loc, mesh_id, cell_it.first);
+					if (!has_mmi && distance <= stream_distance) {
+						_streaming_queue.push_back({ region_loc, mesh_id, cell_it.first, true, distance });
+					} else if (has_mmi && distance > stream_distance + hysteresis) {
+						_streaming_queue.push_back({ region_loc, mesh_id, cell_it.first, false, distance });
+					}
+				}
+				continue;
+			}
+			// All cells are out of range, so only those with MMIs need a look
+			if (mmi_it == _mmi_nodes.end()) {
+				continue;
+			}
+			auto cells_it = mmi_it->second.find(Vector2i(mesh_id, 0));
+			if (cells_it == mmi_it->second.end()) {
+				continue;
+			}
+			for (const auto &cell_it : cells_it->second) {
+				real_t distance = _get_cell_distance(region_loc, cell_it.first);
+				if (distance > stream_distance + hysteresis) {
+					_streaming_queue.push_back({ region_loc, mesh_id, cell_it.first, false, distance });
+				}
+			}
+		}
+	}
+	// Frees first, as they're cheap and release memory, then creates, nearest first
+	std::sort(_streaming_queue.begin(), _streaming_queue.end(), [](const StreamCell &p_a, const StreamCell &p_b) {
+		if (p_a.create != p_b.create) {
+			return p_a.create;
+		}
+		return p_a.create ? p_a.distance > p_b.distance : p_a.distance < p_b.distance;
+	});
+	LOG(DEBUG, "Queued ", int(_streaming_queue.size()), " cells to stream around: ", _streaming_position);
+}
+
 ///////////////////////////
 // Public Functions
 ///////////////////////////
@@ -321,6 +652,7 @@ void Terrain3DInstancer::initialize(Terrain3D *p_terrain) {
 void Terrain3DInstancer::destroy() {
 	IS_DATA_INIT(VOID);
 	LOG(INFO, "Destroying all MMIs");
+	_streaming_queue.clear();
 
 	// Iterate over keys as subfunction will invalidate standard iterator
 	std::vector<Vector2i> keys;
@@ -330,10 +662,14 @@ void Terrain3DInstancer::destroy() {
 		keys.push_back(it.first);
 		i++;
 	}
-	int mesh_count = _terrain->get_assets()->get_mesh_count();
 	for (auto &region_loc : keys) {
-		for (int m = 0; m < mesh_count; m++) {
-			_destroy_mmi_by_location(region_loc, m);
+		// Mesh ids with MMIs, as assets might have been removed since they were built
+		std::unordered_set<int> mesh_ids;
+		for (auto &mesh_it : _mmi_nodes[region_loc]) {
+			mesh_ids.insert(mesh_it.first.x);
+		}
+		for (int mesh_id : mesh_ids) {
+			_destroy_mmi_by_location(region_loc, mesh_id);
 		}
 	}
 }
@@ -359,10 +695,10 @@ void Terrain3DInstancer::clear_by_region(const Ref<Terrain3DRegion> &p_region, c
 	}
 	Vector2i region_loc = p_region->get_location();
 	LOG(INFO, "Deleting Multimeshes w/ mesh_id: ", p_mesh_id, " in region: ", region_loc);
-	Dictionary mesh_inst_dict = p_region->get_instances();
-	if (mesh_inst_dict.has(p_mesh_id)) {
+	Terrain3DRegion::InstanceMeshes &meshes = p_region->get_instance_meshes();
+	if (meshes.count(p_mesh_id) > 0) {
 		_backup_region(p_region);
-		mesh_inst_dict.erase(p_mesh_id);
+		meshes.erase(p_mesh_id);
 	}
 	_destroy_mmi_by_location(region_loc, p_mesh_id);
 }
@@ -524,9 +860,8 @@ void Terrain3DInstancer::remove_instances(const Vector3 &p_global_position, cons
 		Vector2i region_loc = region_queue[r];
 		Ref<Terrain3DRegion> region = data->get_region(region_loc);
 
-		Dictionary mesh_inst_dict = region->get_instances();
-		Array mesh_types = mesh_inst_dict.keys();
-		if (mesh_types.size() == 0) {
+		Terrain3DRegion::InstanceMeshes &meshes = region->get_instance_meshes();
+		if (meshes.empty()) {
 			continue;
 		}
 		Vector3 global_local_offset = Vector3(region_loc.x * region_size * vertex_spacing, 0.f, region_loc.y * region_size * vertex_spacing);
@@ -534,13 +869,13 @@ void Terrain3DInstancer::remove_instances(const Vector3 &p_global_position, cons
 		// For this mesh id, or all mesh ids
 		for (int m = (modifier_shift ? 0 : mesh_id); m <= (modifier_shift ? mesh_count - 1 : mesh_id); m++) {
 			// Ensure this region has this mesh
-			if (!mesh_inst_dict.has(m)) {
+			auto mesh_it = meshes.find(m);
+			if (mesh_it == meshes.end()) {
 				continue;
 			}
-			Dictionary cell_inst_dict = mesh_inst_dict[m];
-			Array cell_locations = cell_inst_dict.keys();
+			Terrain3DRegion::InstanceCells &cells = mesh_it->second;
 			// This shouldnt be empty
-			if (cell_locations.size() == 0) {
+			if (cells.empty()) {
 				LOG(WARN, "Region at: ", region_loc, " has instance dictionary for mesh id: ", m, " but has no cells.")
 				continue;
 			}
@@ -557,7 +892,7 @@ void Terrain3DInstancer::remove_instances(const Vector3 &p_global_position, cons
 					Vector2i cell_loc;
 					cell_loc.x = UtilityFunctions::floori(cell_pos.x / vertex_spacing) / CELL_SIZE;
 					cell_loc.y = UtilityFunctions::floori(cell_pos.z / vertex_spacing) / CELL_SIZE;
-					if (cell_locations.has(cell_loc)) {
+					if (cells.count(cell_loc) > 0) {
 						c_locs[cell_loc] = 1;
 					}
 				}
@@ -570,14 +905,13 @@ void Terrain3DInstancer::remove_instances(const Vector3 &p_global_position, cons
 			real_t mesh_height_offset = mesh_asset->get_height_offset();
 			for (int c = 0; c < cell_queue.size(); c++) {
 				Vector2i cell = cell_queue[c];
-				Array triple = cell_inst_dict[cell];
-				TypedArray<Transform3D> xforms = triple[0];
-				PackedColorArray colors = triple[1];
-				TypedArray<Transform3D> updated_xforms;
-				PackedColorArray updated_colors;
-				// Remove transforms if inside ring radius
-				for (int i = 0; i < xforms.size(); i++) {
-					Transform3D t = xforms[i];
+				Terrain3DRegion::InstanceCell &instances = cells[cell];
+				// Remove transforms if inside ring radius, compacting the rest in place
+				int count = instances.get_count();
+				int kept = 0;
+				int first_changed = count;
+				for (int i = 0; i < count; i++) {
+					Transform3D t = Terrain3DRegion::unpack_xform(instances.xforms.ptr() + i * Terrain3DRegion::XFORM_FLOATS);
 					// Use localised ring center
 					real_t radial_distance = localised_ring_center.distance_to(Vector2(t.origin.x, t.origin.z));
 					Vector3 height_offset = t.basis.get_column(1) * mesh_height_offset;
@@ -585,24 +919,28 @@ void Terrain3DInstancer::remove_instances(const Vector3 &p_global_position, cons
 							UtilityFunctions::randf() < CLAMP(0.175f * strength, 0.005f, 10.f) &&
 							data->is_in_slope(t.origin + global_local_offset - height_offset, slope_range, invert)) {
 						_backup_region(region);
+						first_changed = MIN(first_changed, kept);
 						continue;
-					} else {
-						updated_xforms.push_back(t);
-						updated_colors.push_back(colors[i]);
 					}
+					if (kept != i) {
+						instances.copy_instance(i, kept);
+					}
+					kept++;
+				}
+				if (kept == count) {
+					continue;
 				}
-				if (updated_xforms.size() > 0) {
-					triple[0] = updated_xforms;
-					triple[1] = updated_colors;
-					triple[2] = true;
-					cell_inst_dict[cell] = triple;
+				if (kept > 0) {
+					instances.xforms.resize(kept * Terrain3DRegion::XFORM_FLOATS);
+					instances.colors.resize(kept);
+					instances.set_modified(first_changed);
 				} else {
-					cell_inst_dict.erase(cell);
+					cells.erase(cell);
 					_destroy_mmi_by_cell(region_loc, m, cell);
 				}
 			}
-			if (cell_inst_dict.is_empty()) {
-				mesh_inst_dict.erase(m);
+			if (cells.empty()) {
+				meshes.erase(m);
 			}
 		}
 		_update_mmis(region_loc);
@@ -635,12 +973,15 @@ void Terrain3DInstancer::add_transforms(const int p_mesh_id, const TypedArray<Tr
 		return;
 	}
 
-	Dictionary xforms_dict;
-	Dictionary colors_dict;
 	Ref<Terrain3DMeshAsset> mesh_asset = _terrain->get_assets()->get_mesh_asset(p_mesh_id);
+	Terrain3DData *data = _terrain->get_data();
+	int region_size = _terrain->get_region_size();
+	real_t vertex_spacing = _terrain->get_vertex_spacing();
 
-	// Separate incoming transforms/colors by region Dict{ region_loc => Array() }
+	// Separate incoming transforms/colors by region, packed in region space
 	LOG(INFO, "Separating ", p_xforms.size(), " transforms and ", p_colors.size(), " colors into regions");
+	std::unordered_map<Vector2i, PackedFloat32Array, Vector2iHash> xforms_by_region;
+	std::unordered_map<Vector2i, PackedColorArray, Vector2iHash> colors_by_region;
 	for (int i = 0; i < p_xforms.size(); i++) {
 		// Get adjusted xform/color
 		Transform3D trns = p_xforms[i];
@@ -651,26 +992,23 @@ void Terrain3DInstancer::add_transforms(const int p_mesh_id, const TypedArray<Tr
 		}
 
 		// Store by region offset
-		Vector2i region_loc = _terrain->get_data()->get_region_location(trns.origin);
-		if (!xforms_dict.has(region_loc)) {
-			xforms_dict[region_loc] = TypedArray<Transform3D>();
-			colors_dict[region_loc] = PackedColorArray();
-		}
-		TypedArray<Transform3D> xforms = xforms_dict[region_loc];
-		PackedColorArray colors = colors_dict[region_loc];
-		xforms.push_back(trns);
-		colors.push_back(col);
-		colors_dict[region_loc] = colors; // Note similar bug as godot-cpp#1149 needs this for PCA
+		Vector2i region_loc = data->get_region_location(trns.origin);
+		trns.origin.x -= region_loc.x * region_size * vertex_spacing;
+		trns.origin.z -= region_loc.y * region_size * vertex_spacing;
+		PackedFloat32Array &xforms = xforms_by_region[region_loc];
+		int64_t offset = xforms.size();
+		xforms.resize(offset + Terrain3DRegion::XFORM_FLOATS);
+		Terrain3DRegion::pack_xform(trns, xforms.ptrw() + offset);
+		colors_by_region[region_loc].push_back(col);
 	}
 
 	// Merge incoming transforms with existing transforms
-	Array region_locations = xforms_dict.keys();
-	for (int i = 0; i < region_locations.size(); i++) {
-		Vector2i region_loc = region_locations[i];
-		TypedArray<Transform3D> xforms = xforms_dict[region_loc];
-		PackedColorArray colors = colors_dict[region_loc];
-		//LOG(MESG, "Appending ", xforms.size(), " xforms, ", colors, " colors to region location: ", region_loc);
-		append_location(region_loc, p_mesh_id, xforms, colors, p_update);
+	for (auto &it : xforms_by_region) {
+		Ref<Terrain3DRegion> region = data->get_region(it.first);
+		if (region.is_null()) {
+			continue;
+		}
+		_append_cells(region, p_mesh_id, it.second, colors_by_region[it.first], p_update);
 	}
 }
 
@@ -707,45 +1045,18 @@ void Terrain3DInstancer::append_region(const Ref<Terrain3DRegion> &p_region, con
 		LOG(ERROR, "No transforms to add. Doing nothing.");
 		return;
 	}
-
-	_backup_region(p_region);
-
-	Dictionary cell_locations = p_region->get_instances()[p_mesh_id];
-	int region_size = p_region->get_region_size();
-
+	PackedFloat32Array xforms;
+	xforms.resize(p_xforms.size() * Terrain3DRegion::XFORM_FLOATS);
+	float *dst = xforms.ptrw();
+	PackedColorArray colors = p_colors;
+	colors.resize(p_xforms.size());
 	for (int i = 0; i < p_xforms.size(); i++) {
-		Transform3D xform = p_xforms[i];
-		Color col = p_colors[i];
-		Vector2i cell = _get_cell(xform.origin, region_size);
-
-		// Get current instance arrays or create if none
-		Array triple = cell_locations[cell];
-		bool modified = true;
-		if (triple.size() != 3) {
-			LOG(DEBUG, "No data at ", p_region->get_location(), ":", cell, ". Creating triple");
-			triple.resize(3);
-			triple[0] = TypedArray<Transform3D>();
-			triple[1] = PackedColorArray();
-			triple[2] = modified;
+		Terrain3DRegion::pack_xform(p_xforms[i], dst + i * Terrain3DRegion::XFORM_FLOATS);
+		if (i >= p_colors.size()) {
+			colors.set(i, COLOR_WHITE);
 		}
-		TypedArray<Transform3D> xforms = triple[0];
-		PackedColorArray colors = triple[1];
-		xforms.push_back(xform);
-		colors.push_back(col);
-
-		// Must write back since there are copy constructors somewhere
-		// see godot-cpp#1149
-		triple[0] = xforms;
-		triple[1] = colors;
-		triple[2] = modified;
-		cell_locations[cell] = triple;
-	}
-
-	// Write back dictionary. See above comments
-	p_region->get_instances()[p_mesh_id] = cell_locations;
-	if (p_update) {
-		_update_mmis(p_region->get_location(), p_mesh_id);
 	}
+	_append_cells(p_region, p_mesh_id, xforms, colors, p_update);
 }
 
 // Review all transforms in one area and adjust their transforms w/ the current height
@@ -787,24 +1098,19 @@ void Terrain3DInstancer::update_transforms(const AABB &p_aabb) {
 		Ref<Terrain3DRegion> region = _terrain->get_data()->get_region(region_loc);
 		_backup_region(region);
 
-		Dictionary mesh_inst_dict = region->get_instances();
-		Array mesh_types = mesh_inst_dict.keys();
-		if (mesh_types.size() == 0) {
+		Terrain3DRegion::InstanceMeshes &meshes = region->get_instance_meshes();
+		if (meshes.empty()) {
 			continue;
 		}
 		Vector3 global_local_offset = Vector3(region_loc.x * region_size * vertex_spacing, 0.f, region_loc.y * region_size * vertex_spacing);
 
 		// For this mesh id, or all mesh ids
-		for (int m = 0; m < mesh_types.size(); m++) {
+		for (auto mesh_it = meshes.begin(); mesh_it != meshes.end();) {
 			// Check potential cells rather than searching the entire region, whilst marginally
 			// slower if there are very few cells for the given mesh present it is significantly
 			// faster when a very large number of cells are present.
-			int region_mesh_id = mesh_types[m];
-			Dictionary cell_inst_dict = mesh_inst_dict[region_mesh_id];
-			Array cell_locations = cell_inst_dict.keys();
-			if (cell_locations.size() == 0) {
-				continue;
-			}
+			int region_mesh_id = mesh_it->first;
+			Terrain3DRegion::InstanceCells &cells = mesh_it->second;
 			Dictionary c_locs;
 			// Calculate step distance to ensure every cell is checked inside the bounds of brush size.
 			Vector2 cell_step = Vector2(size.x / ceil(size.x / real_t(CELL_SIZE) / vertex_spacing), size.y / ceil(size.y / real_t(CELL_SIZE) / vertex_spacing));
@@ -815,55 +1121,56 @@ void Terrain3DInstancer::update_transforms(const AABB &p_aabb) {
 					Vector2i cell_loc;
 					cell_loc.x = UtilityFunctions::floori(cell_pos.x / vertex_spacing) / CELL_SIZE;
 					cell_loc.y = UtilityFunctions::floori(cell_pos.z / vertex_spacing) / CELL_SIZE;
-					if (cell_locations.has(cell_loc)) {
+					if (cells.count(cell_loc) > 0) {
 						c_locs[cell_loc] = 0;
 					}
 				}
 			}
 			Array cell_queue = c_locs.keys();
-			if (cell_queue.size() == 0) {
-				continue;
-			}
-			Ref<Terrain3DMeshAsset> mesh_asset = _terrain->get_assets()->get_mesh_asset(mesh_types[m]);
-			real_t mesh_height_offset = mesh_asset->get_height_offset();
+			Ref<Terrain3DMeshAsset> mesh_asset = _terrain->get_assets()->get_mesh_asset(region_mesh_id);
+			real_t mesh_height_offset = mesh_asset.is_valid() ? mesh_asset->get_height_offset() : 0.f;
 			for (int c = 0; c < cell_queue.size(); c++) {
 				Vector2i cell = cell_queue[c];
-				Array triple = cell_inst_dict[cell];
-				TypedArray<Transform3D> xforms = triple[0];
-				PackedColorArray colors = triple[1];
-				TypedArray<Transform3D> updated_xforms;
-				PackedColorArray updated_colors;
-				for (int i = 0; i < xforms.size(); i++) {
-					Transform3D t = xforms[i];
-					Vector3 global_origin(t.origin + global_local_offset);
+				Terrain3DRegion::InstanceCell &instances = cells[cell];
+				int count = instances.get_count();
+				int kept = 0;
+				int first_changed = count;
+				for (int i = 0; i < count; i++) {
+					float *xform = instances.xforms.ptrw() + i * Terrain3DRegion::XFORM_FLOATS;
+					Vector3 global_origin = Vector3(xform[3], xform[7], xform[11]) + global_local_offset;
 					if (rect.has_point(Vector2(global_origin.x, global_origin.z))) {
-						Vector3 height_offset = t.basis.get_column(1) * mesh_height_offset;
-						t.origin -= height_offset;
-						real_t height = _terrain->get_data()->get_height(global_origin);
+						real_t height = data->get_height(global_origin);
+						first_changed = MIN(first_changed, kept);
 						// If the new height is a nan due to creating a hole, remove the instance
 						if (std::isnan(height)) {
 							continue;
 						}
-						t.origin.y = height;
-						t.origin += height_offset;
+						// Only Y changes. Keep the offset along the up axis, the second basis column
+						xform[7] = height + xform[5] * mesh_height_offset;
+					}
+					if (kept != i) {
+						instances.copy_instance(i, kept);
 					}
-					updated_xforms.push_back(t);
-					updated_colors.push_back(colors[i]);
+					kept++;
 				}
-				if (updated_xforms.size() > 0) {
-					triple[0] = updated_xforms;
-					triple[1] = updated_colors;
-					triple[2] = true;
-					cell_inst_dict[cell] = triple;
+				if (kept == count && first_changed == count) {
+					continue;
+				}
+				if (kept > 0) {
+					instances.xforms.resize(kept * Terrain3DRegion::XFORM_FLOATS);
+					instances.colors.resize(kept);
+					instances.set_modified(first_changed);
 				} else {
 					// Removed if a hole erased everything
-					cell_inst_dict.erase(cell);
-					_destroy_mmi_by_cell(region_loc, m, cell);
-				}
-				if (cell_inst_dict.is_empty()) {
-					mesh_inst_dict.erase(region_mesh_id);
+					cells.erase(cell);
+					_destroy_mmi_by_cell(region_loc, region_mesh_id, cell);
 				}
 			}
+			if (cells.empty()) {
+				mesh_it = meshes.erase(mesh_it);
+			} else {
+				++mesh_it;
+			}
 		}
 		_update_mmis(region_loc);
 	}
@@ -900,30 +1207,28 @@ void Terrain3DInstancer::copy_paste_dfr(const Terrain3DRegion *p_src_region, con
 	}
 
 	// For each mesh, for each cell, if in rect, convert xforms to target region space, append to target region.
-	Dictionary mesh_inst_dict = p_src_region->get_instances();
-	Array mesh_types = mesh_inst_dict.keys();
-	for (int m = 0; m < mesh_types.size(); m++) {
-		TypedArray<Transform3D> xforms;
+	const int xform_floats = Terrain3DRegion::XFORM_FLOATS;
+	for (const auto &mesh_it : p_src_region->get_instance_meshes()) {
+		PackedFloat32Array xforms;
 		PackedColorArray colors;
-		Dictionary cell_inst_dict = p_src_region->get_instances()[m];
-		Array cell_locs = cell_inst_dict.keys();
-		for (int c = 0; c < cell_locs.size(); c++) {
-			if (cells_to_copy.has(cell_locs[c])) {
-				Array triple = cell_inst_dict[cell_locs[c]];
-				TypedArray<Transform3D> cell_xforms = triple[0];
-				PackedColorArray cell_colors = triple[1];
-				for (int i = 0; i < cell_xforms.size(); i++) {
-					Transform3D t = cell_xforms[i];
-					t.origin += dst_translate;
-					xforms.push_back(t);
-					colors.push_back(cell_colors[i]);
-				}
+		for (const auto &cell_it : mesh_it.second) {
+			if (!cells_to_copy.has(cell_it.first)) {
+				continue;
+			}
+			const Terrain3DRegion::InstanceCell &instances = cell_it.second;
+			int64_t offset = xforms.size();
+			xforms.append_array(instances.xforms);
+			colors.append_array(instances.colors);
+			float *dst = xforms.ptrw() + offset;
+			for (int i = 0; i < instances.get_count(); i++) {
+				dst[i * xform_floats + 3] += dst_translate.x;
+				dst[i * xform_floats + 11] += dst_translate.z;
 			}
 		}
-		if (xforms.size() == 0) {
+		if (colors.is_empty()) {
 			continue;
 		}
-		append_region(Ref<Terrain3DRegion>(p_dst_region), m, xforms, colors, false);
+		_append_cells(Ref<Terrain3DRegion>(p_dst_region), mesh_it.first, xforms, colors, false);
 	}
 }
 
@@ -944,31 +1249,30 @@ void Terrain3DInstancer::swap_ids(const int p_src_id, const int p_dst_id) {
 				continue;
 			}
 
-			// mesh_inst_dict could have src, src+dst, dst or nothing. All 4 must be considered
-			Dictionary mesh_inst_dict = region->get_instances();
-			Dictionary cells_inst_dict_src;
-			Dictionary cells_inst_dict_dst;
-			// Extract src dict
-			if (mesh_inst_dict.has(p_src_id)) {
-				_backup_region(region);
-				cells_inst_dict_src = mesh_inst_dict[p_src_id];
-				mesh_inst_dict.erase(p_src_id);
+			// Meshes could have src, src+dst, dst or nothing. All 4 must be considered
+			Terrain3DRegion::InstanceMeshes &meshes = region->get_instance_meshes();
+			auto src_it = meshes.find(p_src_id);
+			auto dst_it = meshes.find(p_dst_id);
+			if (src_it == meshes.end() && dst_it == meshes.end()) {
+				continue;
+			}
+			_backup_region(region);
+			Terrain3DRegion::InstanceCells cells_src;
+			Terrain3DRegion::InstanceCells cells_dst;
+			if (src_it != meshes.end()) {
+				cells_src.swap(src_it->second);
+				meshes.erase(src_it);
 			}
-			// Extract dest dict
-			if (mesh_inst_dict.has(p_dst_id)) {
-				_backup_region(region);
-				cells_inst_dict_dst = mesh_inst_dict[p_dst_id];
-				mesh_inst_dict.erase(p_dst_id);
+			if (dst_it != meshes.end()) {
+				cells_dst.swap(dst_it->second);
+				meshes.erase(dst_it);
 			}
-			// If src exists, insert into dst slot
-			if (!cells_inst_dict_src.is_empty()) {
-				_backup_region(region);
-				mesh_inst_dict[p_dst_id] = cells_inst_dict_src;
+			// If src exists, insert into dst slot, and dst into src
+			if (!cells_src.empty()) {
+				meshes[p_dst_id].swap(cells_src);
 			}
-			// If dst exists, insert into src slot
-			if (!cells_inst_dict_dst.is_empty()) {
-				_backup_region(region);
-				mesh_inst_dict[p_src_id] = cells_inst_dict_dst;
+			if (!cells_dst.empty()) {
+				meshes[p_src_id].swap(cells_dst);
 			}
 			LOG(MESG, "Swapped mesh_ids for region: ", region_loc);
 		}
@@ -981,6 +1285,60 @@ void Terrain3DInstancer::force_update_mmis() {
 	_update_mmis();
 }
 
+// Creates and frees cell MMIs around the camera, if streaming is enabled on Terrain3D. Called every
+// frame. Cells are queued when the camera moves a quarter of a cell, and the queue is worked through
+// until the budget runs out. At least one cell is done per call, so the queue always progresses.
+void Terrain3DInstancer::update_streaming(const Vector3 &p_cam_pos, const real_t p_budget_ms) {
+	IS_DATA_INIT(VOID);
+	if (!_terrain->get_instancer_streaming()) {
+		return;
+	}
+	real_t cell_width = real_t(CELL_SIZE) * _terrain->get_vertex_spacing();
+	Vector2 cam_pos = Vector2(p_cam_pos.x, p_cam_pos.z);
+	if (cam_pos.distance_to(Vector2(_streaming_position.x, _streaming_position.z)) > cell_width * .25f) {
+		_streaming_position = p_cam_pos;
+		_queue_streaming();
+	}
+	if (_streaming_queue.empty()) {
+		return;
+	}
+
+	uint64_t start = Time::get_singleton()->get_ticks_usec();
+	uint64_t budget = uint64_t(MAX(p_budget_ms, 0.f) * 1000.f);
+	int created = 0;
+	int freed = 0;
+	do {
+		StreamCell sc = _streaming_queue.back();
+		_streaming_queue.pop_back();
+		if (!sc.create) {
+			_destroy_mmi_by_cell(sc.region_loc, sc.mesh_id, sc.cell);
+			freed++;
+			continue;
+		}
+		// The data may have changed since it was queued
+		if (_has_cell_mmi(sc.region_loc, sc.mesh_id, sc.cell)) {
+			continue;
+		}
+		Ref<Terrain3DRegion> region = _terrain->get_data()->get_region(sc.region_loc);
+		Ref<Terrain3DMeshAsset> ma = _terrain->get_assets()->get_mesh_asset(sc.mesh_id);
+		if (region.is_null() || ma.is_null() || ma->get_mesh().is_null()) {
+			continue;
+		}
+		Terrain3DRegion::InstanceMeshes &meshes = region->get_instance_meshes();
+		auto mesh_it = meshes.find(sc.mesh_id);
+		if (mesh_it == meshes.end()) {
+			continue;
+		}
+		auto cell_it = mesh_it->second.find(sc.cell);
+		if (cell_it == mesh_it->second.end() || cell_it->second.get_count() == 0) {
+			continue;
+		}
+		_update_cell_mmis(region, sc.mesh_id, ma, sc.cell, cell_it->second);
+		created++;
+	} while (!_streaming_queue.empty() && Time::get_singleton()->get_ticks_usec() - start < budget);
+	LOG(EXTREME, "Streamed cells, created: ", created, ", freed: ", freed, ", queued: ", int(_streaming_queue.size()));
+}
+
 void Terrain3DInstancer::dump_data() {
 	IS_DATA_INIT_MESG("Instancer isn't initialized.", VOID);
 	Array region_locations = _terrain->get_data()->get_region_locations();
@@ -993,24 +1351,13 @@ void Terrain3DInstancer::dump_data() {
 			continue;
 		}
 		LOG(MESG, "Region: ", region_loc);
-		Dictionary mesh_inst_dict = region->get_instances();
-		Array mesh_ids = mesh_inst_dict.keys();
-		for (int m = 0; m < mesh_ids.size(); m++) {
-			int mesh_id = mesh_ids[m];
+		for (const auto &mesh_it : region->get_instance_meshes()) {
+			int mesh_id = mesh_it.first;
 			LOG(MESG, "Mesh ID: ", mesh_id);
-			Dictionary cell_inst_dict = mesh_inst_dict[mesh_id];
-			Array cells = cell_inst_dict.keys();
-			for (int c = 0; c < cells.size(); c++) {
-				Vector2i cell = cells[c];
-				Array triple = cell_inst_dict[cell];
-				if (triple.size() != 3) {
-					LOG(WARN, "Malformed triple at cell ", cell, ": ", triple);
-					continue;
-				}
-				Array xforms = triple[0];
-				Array colors = triple[1];
-				bool modified = triple[2];
-				LOG(MESG, "Mesh: ", mesh_id, " cell: ", cell, " xforms: ", xforms.size(), " colors: ", colors.size(), " modified: ", modified);
+			for (const auto &cell_it : mesh_it.second) {
+				const Terrain3DRegion::InstanceCell &instances = cell_it.second;
+				LOG(MESG, "Mesh: ", mesh_id, " cell: ", cell_it.first, " xforms: ", instances.xforms.size() / Terrain3DRegion::XFORM_FLOATS,
+						" colors: ", instances.colors.size(), " modified: ", instances.modified);
 			}
 		}
 	}
@@ -1030,7 +1377,8 @@ void Terrain3DInstancer::dump_mmis() {
 		for (auto &j : i.second) {
 			LOG(MESG, "mesh_mmi_dict mesh: ", j.first, ", dict ptr: ", uint64_t(&j.second));
 			for (auto &k : j.second) {
-				LOG(MESG, "cell_mmi_dict cell: ", k.first, ", mmi ptr: ", uint64_t(k.second));
+				LOG(MESG, "cell_mmi_dict cell: ", k.first, ", mmi ptr: ", uint64_t(k.second.node), ", instance: ", k.second.instance,
+						", multimesh: ", k.second.multimesh);
 			}
 		}
 	}
@@ -1052,6 +1400,8 @@ void Terrain3DInstancer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("append_region", "region", "mesh_id", "transforms", "colors", "update"), &Terrain3DInstancer::append_region, DEFVAL(true));
 	ClassDB::bind_method(D_METHOD("update_transforms", "aabb"), &Terrain3DInstancer::update_transforms);
 	ClassDB::bind_method(D_METHOD("force_update_mmis"), &Terrain3DInstancer::force_update_mmis);
+	ClassDB::bind_method(D_METHOD("update_streaming", "camera_position", "budget_ms"), &Terrain3DInstancer::update_streaming);
+	ClassDB::bind_method(D_METHOD("get_streaming_queue_size"), &Terrain3DInstancer::get_streaming_queue_size);
 	ClassDB::bind_method(D_METHOD("swap_ids", "src_id", "dest_id"), &Terrain3DInstancer::swap_ids);
 	ClassDB::bind_method(D_METHOD("dump_data"), &Terrain3DInstancer::dump_data);
 	ClassDB::bind_method(D_METHOD("dump_mmis"), &Terrain3DInstancer::dump_mmis);
@@ -5,14 +5,19 @@
 
 #include <godot_cpp/classes/multi_mesh.hpp>
 #include <godot_cpp/classes/multi_mesh_instance3d.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
 #include <unordered_map>
+#include <vector>
 
 #include "constants.h"
+#include "terrain_3d_mesh_asset.h"
+#include "terrain_3d_region.h"
 
 using namespace godot;
 
 class Terrain3D;
 class Terrain3DAssets;
+class Terrain3DOcclusion;
 
 class Terrain3DInstancer : public Object {
 	GDCLASS(Terrain3DInstancer, Object);
@@ -26,11 +31,27 @@ private:
 	Terrain3D *_terrain = nullptr;
 
 	// MM Resources stored in Terrain3DRegion::_instances as
-	// Region::_instances{mesh_id:int} -> cell{v2i} -> [ TypedArray<Transform3D>, PackedColorArray, modified:bool ]
-
-	// MMI Objects attached to tree, freed in destructor, stored as
-	// _mmi_nodes{region_loc} -> mesh{v2i(mesh_id,lod)} -> cell{v2i} -> MultiMeshInstance3D
-	typedef std::unordered_map<Vector2i, MultiMeshInstance3D *, Vector2iHash> CellMMIDict;
+	// Region::_instances{mesh_id:int} -> cell{v2i} -> InstanceCell{ packed transforms, colors, modified }
+
+	// MMIs of each cell, freed in destructor, stored as
+	// _mmi_nodes{region_loc} -> mesh{v2i(mesh_id,lod)} -> cell{v2i} -> CellMMI
+	// In node mode, a CellMMI is a MultiMeshInstance3D attached to the tree. In server mode, it is a
+	// multimesh and instance RID created directly on the RenderingServer, without any nodes.
+	struct CellMMI {
+		MultiMeshInstance3D *node = nullptr;
+		RID multimesh;
+		RID instance;
+		RID mesh; // Set on the multimesh
+		int capacity = 0; // Allocated instances, which can be more than are visible
+		PackedFloat32Array buffer; // Copy of the multimesh buffer, so edits don't read it back. LOD 0 only
+		// Occlusion culling state. The global AABB is cached, and invalidated when the multimesh
+		// is rebuilt.
+		AABB aabb;
+		bool aabb_valid = false;
+		bool occluded = false;
+		RenderingServer::ShadowCastingSetting cast_shadows = RenderingServer::SHADOW_CASTING_SETTING_ON; // Of the mesh asset
+	};
+	typedef std::unordered_map<Vector2i, CellMMI, Vector2iHash> CellMMIDict;
 	typedef std::unordered_map<Vector2i, CellMMIDict, Vector2iHash> MeshMMIDict;
 	std::unordered_map<Vector2i, MeshMMIDict, Vector2iHash> _mmi_nodes;
 
@@ -38,17 +59,47 @@ private:
 	// _mmi_containers{region_loc} -> Node3D
 	std::unordered_map<Vector2i, Node3D *, Vector2iHash> _mmi_containers;
 
+	// Streaming, enabled on Terrain3D. Only cells within range of the camera, per the visibility range
+	// of their mesh, have MMIs. Cells to create or free are queued when the camera moves, and worked
+	// through within a time budget per frame, nearest first.
+	struct StreamCell {
+		Vector2i region_loc;
+		int mesh_id = 0;
+		Vector2i cell;
+		bool create = true; // Else free
+		real_t distance = 0.f;
+	};
+	Vector3 _streaming_position = V3_MAX; // Camera position of the last queue
+	std::vector<StreamCell> _streaming_queue; // Next at the back
+
 	uint32_t _density_counter = 0;
 	uint32_t _get_density_count(const real_t p_density);
 
 	void _update_mmis(const Vector2i &p_region_loc = V2I_MAX, const int p_mesh_id = -1);
+	int _update_cell_mmis(const Ref<Terrain3DRegion> &p_region, const int p_mesh_id, const Ref<Terrain3DMeshAsset> &p_ma,
+			const Vector2i &p_cell, Terrain3DRegion::InstanceCell &p_instances);
 	void _update_vertex_spacing(const real_t p_vertex_spacing);
 	void _destroy_mmi_by_cell(const Vector2i &p_region_loc, const int p_mesh_id, const Vector2i p_cell);
 	void _destroy_mmi_by_location(const Vector2i &p_region_loc, const int p_mesh_id);
 	void _backup_regionl(const Vector2i &p_region_loc);
 	void _backup_region(const Ref<Terrain3DRegion> &p_region);
-	Ref<MultiMesh> _create_multimesh(const int p_mesh_id, const TypedArray<Transform3D> &p_xforms = TypedArray<Transform3D>(), const PackedColorArray &p_colors = PackedColorArray()) const;
+	void _update_multimesh(CellMMI &p_mmi, const Ref<Mesh> &p_mesh, const PackedFloat32Array &p_xforms, const PackedColorArray &p_colors,
+			const int p_from = 0, const CellMMI *p_lod0 = nullptr);
+	PackedFloat32Array _get_multimesh_buffer(const PackedFloat32Array &p_xforms, const PackedColorArray &p_colors, const int p_capacity) const;
+	void _write_multimesh_buffer(float *r_buffer, const PackedFloat32Array &p_xforms, const PackedColorArray &p_colors,
+			const int p_from, const int p_to) const;
+	void _free_cell_mmi(CellMMI &p_mmi);
+	RID _get_scenario() const;
+	void _update_scenario(const RID &p_scenario, const bool p_visible);
 	Vector2i _get_cell(const Vector3 &p_global_position, const int p_region_size);
+	void _append_cells(const Ref<Terrain3DRegion> &p_region, const int p_mesh_id, const PackedFloat32Array &p_xforms,
+			const PackedColorArray &p_colors, const bool p_update);
+	int _update_occlusion(const Terrain3DOcclusion *p_occlusion);
+	void _apply_occlusion(const CellMMI &p_mmi, const bool p_visible) const;
+	bool _has_cell_mmi(const Vector2i &p_region_loc, const int p_mesh_id, const Vector2i &p_cell) const;
+	real_t _get_cell_distance(const Vector2i &p_region_loc, const Vector2i &p_cell) const;
+	real_t _get_streaming_distance(const Ref<Terrain3DMeshAsset> &p_ma) const;
+	void _queue_streaming();
 
 public:
 	Terrain3DInstancer() {}
@@ -74,6 +125,8 @@ public:
 
 	void swap_ids(const int p_src_id, const int p_dst_id);
 	void force_update_mmis();
+	void update_streaming(const Vector3 &p_cam_pos, const real_t p_budget_ms);
+	int get_streaming_queue_size() const { return _streaming_queue.size(); }
 
 	void reset_density_counter() { _density_counter = 0; }
 	void dump_data();
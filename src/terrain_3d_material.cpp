@@ -371,15 +371,40 @@ void Terrain3DMaterial::_update_shader() {
 		_set("noise_texture", noise_tex);
 	}
 
+	_update_background_height_range();
 	notify_property_list_changed();
 }
 
+// Calculates the range of heights the world noise adds outside of regions, and blended into their
+// edges, as in get_noise_height() of world_noise.glsl. Each octave is 0-1 at half the weight of the
+// previous, so the sum is below 2. AABBs are refit if it changed.
+void Terrain3DMaterial::_update_background_height_range() {
+	Vector2 range = V2_ZERO;
+	if (_world_background == NOISE) {
+		Variant height = RS->material_get_param(_material, "world_noise_height");
+		Variant offset = RS->material_get_param(_material, "world_noise_offset");
+		real_t noise_height = (height.get_type() == Variant::NIL) ? 64.f : real_t(height);
+		real_t base = (offset.get_type() == Variant::NIL) ? 0.f : Vector3(offset).y * 100.f;
+		range = Vector2(MIN(0.f, base), MAX(0.f, base + noise_height * 10.f * 2.f));
+	}
+	if (range != _background_height_range) {
+		LOG(DEBUG, "World background height range: ", range);
+		_background_height_range = range;
+		if (_terrain) {
+			_terrain->update_aabbs();
+		}
+	}
+}
+
 void Terrain3DMaterial::_update_maps() {
 	IS_DATA_INIT(VOID);
 	LOG(EXTREME, "Updating maps in shader");
 
 	Terrain3DData *data = _terrain->get_data();
-	PackedInt32Array region_map = data->get_region_map();
+	// The region map the bound texture arrays were built for. When streaming, it indexes the resident
+	// slots instead of all regions.
+	bool bound = !data->get_texture_region_map().is_empty();
+	PackedInt32Array region_map = bound ? data->get_texture_region_map() : data->get_region_map();
 	LOG(EXTREME, "region_map.size(): ", region_map.size());
 	if (region_map.size() != Terrain3DData::REGION_MAP_SIZE * Terrain3DData::REGION_MAP_SIZE) {
 		LOG(ERROR, "Expected region_map.size() of ", Terrain3DData::REGION_MAP_SIZE * Terrain3DData::REGION_MAP_SIZE);
@@ -396,9 +421,10 @@ void Terrain3DMaterial::_update_maps() {
 		}
 	}
 
-	TypedArray<Vector2i> region_locations = data->get_region_locations();
+	TypedArray<Vector2i> region_locations = bound ? data->get_texture_region_locations() : data->get_region_locations();
 	LOG(EXTREME, "Region_locations size: ", region_locations.size(), " ", region_locations);
 	RS->material_set_param(_material, "_region_locations", region_locations);
+	RS->material_set_param(_material, "_summary_layer", data->get_texture_summary_layer());
 
 	real_t region_size = real_t(_terrain->get_region_size());
 	LOG(EXTREME, "Setting region size in material: ", region_size);
@@ -797,6 +823,9 @@ bool Terrain3DMaterial::_set(const StringName &p_name, const Variant &p_property
 		_shader_params[p_name] = p_property;
 		RS->material_set_param(_material, p_name, p_property);
 	}
+	if (String(p_name).begins_with("world_noise")) {
+		_update_background_height_range();
+	}
 	return true;
 }
 
@@ -43,6 +43,7 @@ private:
 
 	// Material Features
 	WorldBackground _world_background = FLAT;
+	Vector2 _background_height_range = V2_ZERO; // Heights the world background adds, see WORLD_NOISE
 	TextureFiltering _texture_filtering = LINEAR;
 	bool _auto_shader = false;
 	bool _dual_scaling = false;
@@ -76,6 +77,7 @@ private:
 	void _update_shader();
 	void _update_maps();
 	void _update_texture_arrays();
+	void _update_background_height_range();
 	void _set_shader_parameters(const Dictionary &p_dict);
 	Dictionary _get_shader_parameters() const { return _shader_params; }
 
@@ -91,6 +93,7 @@ public:
 	// Material settings
 	void set_world_background(const WorldBackground p_background);
 	WorldBackground get_world_background() const { return _world_background; }
+	Vector2 get_background_height_range() const { return _background_height_range; }
 	void set_texture_filtering(const TextureFiltering p_filtering);
 	TextureFiltering get_texture_filtering() const { return _texture_filtering; }
 	void set_auto_shader(const bool p_enabled);
@@ -23,6 +23,7 @@ void Terrain3DMeshAsset::_set_generated_type(const GenType p_type) {
 	if (p_type > TYPE_NONE && p_type < TYPE_MAX) {
 		_packed_scene.unref();
 		_meshes.clear();
+		_lod_count = 1;
 		LOG(DEBUG, "Generating card mesh");
 		_meshes.push_back(_get_generated_mesh());
 		_set_material_override(_get_material());
@@ -38,14 +39,16 @@ void Terrain3DMeshAsset::_set_material_override(const Ref<Material> &p_material)
 		set_scene_file(_packed_scene);
 		return;
 	}
-	if (_material_override.is_valid() && _meshes.size() > 0) {
-		Ref<Mesh> mesh = _meshes[0];
-		if (mesh.is_null()) {
-			return;
-		}
-		LOG(DEBUG, "Setting material for ", mesh->get_surface_count(), " surfaces");
-		for (int i = 0; i < mesh->get_surface_count(); i++) {
-			mesh->surface_set_material(i, _material_override);
+	if (_material_override.is_valid()) {
+		for (int m = 0; m < _lod_count && m < _meshes.size(); m++) {
+			Ref<Mesh> mesh = _meshes[m];
+			if (mesh.is_null()) {
+				continue;
+			}
+			LOG(DEBUG, "Setting material for ", mesh->get_surface_count(), " surfaces");
+			for (int i = 0; i < mesh->get_surface_count(); i++) {
+				mesh->surface_set_material(i, _material_override);
+			}
 		}
 	}
 }
@@ -136,6 +139,17 @@ Ref<Material> Terrain3DMeshAsset::_get_material() {
 	}
 }
 
+// Returns the LOD of a mesh named with a LOD# suffix, eg. Tree_LOD2, or -1
+int Terrain3DMeshAsset::_get_lod_index(const String &p_name) {
+	String name = p_name.to_lower();
+	int pos = name.rfind("lod");
+	if (pos < 0) {
+		return -1;
+	}
+	String suffix = name.substr(pos + 3).trim_prefix("_");
+	return suffix.is_valid_int() ? suffix.to_int() : -1;
+}
+
 ///////////////////////////
 // Public Functions
 ///////////////////////////
@@ -151,6 +165,7 @@ void Terrain3DMeshAsset::clear() {
 	_height_offset = 0.f;
 	_visibility_range = 100.f;
 	_visibility_margin = 0.f;
+	_lod_distances.clear();
 	_cast_shadows = GeometryInstance3D::SHADOW_CASTING_SETTING_ON;
 	_generated_faces = 2.f;
 	_generated_size = Vector2(1.f, 1.f);
@@ -197,6 +212,34 @@ void Terrain3DMeshAsset::set_visibility_margin(const real_t p_visibility_margin)
 	emit_signal("instancer_setting_changed");
 }
 
+void Terrain3DMeshAsset::set_lod_distances(const PackedFloat32Array &p_distances) {
+	_lod_distances = p_distances;
+	for (int i = 0; i < _lod_distances.size(); i++) {
+		_lod_distances[i] = CLAMP(_lod_distances[i], 0.f, 100000.f);
+	}
+	LOG(INFO, "Setting LOD distances: ", _lod_distances);
+	emit_signal("instancer_setting_changed");
+}
+
+// Returns the visibility range begin and end of a LOD. Distances not set split the visibility range
+// evenly, or are 100m apart if it is unlimited. The last LOD ends at the visibility range.
+Vector2 Terrain3DMeshAsset::get_lod_range(const int p_lod) const {
+	int lod = CLAMP(p_lod, 0, _lod_count - 1);
+	real_t range = (_visibility_range > 0.f) ? _visibility_range : 100.f * real_t(_lod_count);
+	Vector2 lod_range = V2_ZERO;
+	for (int i = 0; i <= lod; i++) {
+		lod_range.x = lod_range.y;
+		if (i == _lod_count - 1) {
+			lod_range.y = _visibility_range;
+			break;
+		}
+		real_t end = (i < _lod_distances.size()) ? _lod_distances[i] : range * real_t(i + 1) / real_t(_lod_count);
+		end = MAX(end, lod_range.x);
+		lod_range.y = (_visibility_range > 0.f) ? MIN(end, _visibility_range) : end;
+	}
+	return lod_range;
+}
+
 void Terrain3DMeshAsset::set_cast_shadows(const GeometryInstance3D::ShadowCastingSetting p_cast_shadows) {
 	_cast_shadows = p_cast_shadows;
 	LOG(INFO, "Setting shadow casting mode: ", _cast_shadows);
@@ -222,6 +265,10 @@ void Terrain3DMeshAsset::set_scene_file(const Ref<PackedScene> &p_scene_file) {
 		LOG(DEBUG, "Loaded scene with parent node: ", node);
 		TypedArray<Node> mesh_instances = node->find_children("*", "MeshInstance3D");
 		_meshes.clear();
+		// Meshes named with a LOD# suffix are sorted first and used as LODs. Otherwise, the
+		// first mesh is used alone.
+		PackedInt32Array lods;
+		int lod_meshes = 0;
 		for (int i = 0; i < mesh_instances.size(); i++) {
 			MeshInstance3D *mi = cast_to<MeshInstance3D>(mesh_instances[i]);
 			LOG(DEBUG, "Found mesh: ", mi->get_name());
@@ -239,8 +286,18 @@ void Terrain3DMeshAsset::set_scene_file(const Ref<PackedScene> &p_scene_file) {
 				}
 				mesh->surface_set_material(j, mat);
 			}
-			_meshes.push_back(mesh);
+			int lod = _get_lod_index(mi->get_name());
+			int key = (lod < 0) ? INT32_MAX : lod;
+			int pos = lods.size();
+			while (pos > 0 && lods[pos - 1] > key) {
+				pos--;
+			}
+			lods.insert(pos, key);
+			_meshes.insert(pos, mesh);
+			lod_meshes += (lod < 0) ? 0 : 1;
 		}
+		_lod_count = MAX(lod_meshes, 1);
+		LOG(DEBUG, "Found ", _lod_count, " LODs");
 		if (_meshes.size() > 0) {
 			Ref<Mesh> mesh = _meshes[0];
 			_density = CLAMP(10.f / mesh->get_aabb().get_volume(), 0.01f, 10.0f);
@@ -343,8 +400,12 @@ void Terrain3DMeshAsset::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_density"), &Terrain3DMeshAsset::get_density);
 	ClassDB::bind_method(D_METHOD("set_visibility_range", "distance"), &Terrain3DMeshAsset::set_visibility_range);
 	ClassDB::bind_method(D_METHOD("get_visibility_range"), &Terrain3DMeshAsset::get_visibility_range);
-	//ClassDB::bind_method(D_METHOD("set_visibility_margin", "distance"), &Terrain3DMeshAsset::set_visibility_margin);
-	//ClassDB::bind_method(D_METHOD("get_visibility_margin"), &Terrain3DMeshAsset::get_visibility_margin);
+	ClassDB::bind_method(D_METHOD("set_visibility_margin", "distance"), &Terrain3DMeshAsset::set_visibility_margin);
+	ClassDB::bind_method(D_METHOD("get_visibility_margin"), &Terrain3DMeshAsset::get_visibility_margin);
+	ClassDB::bind_method(D_METHOD("set_lod_distances", "distances"), &Terrain3DMeshAsset::set_lod_distances);
+	ClassDB::bind_method(D_METHOD("get_lod_distances"), &Terrain3DMeshAsset::get_lod_distances);
+	ClassDB::bind_method(D_METHOD("get_lod_count"), &Terrain3DMeshAsset::get_lod_count);
+	ClassDB::bind_method(D_METHOD("get_lod_range", "lod"), &Terrain3DMeshAsset::get_lod_range);
 	ClassDB::bind_method(D_METHOD("set_cast_shadows", "mode"), &Terrain3DMeshAsset::set_cast_shadows);
 	ClassDB::bind_method(D_METHOD("get_cast_shadows"), &Terrain3DMeshAsset::get_cast_shadows);
 	ClassDB::bind_method(D_METHOD("set_scene_file", "scene_file"), &Terrain3DMeshAsset::set_scene_file);
@@ -366,7 +427,8 @@ void Terrain3DMeshAsset::_bind_methods() {
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "height_offset", PROPERTY_HINT_RANGE, "-20.0,20.0,.005"), "set_height_offset", "get_height_offset");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "density", PROPERTY_HINT_RANGE, ".01,10.0,.005"), "set_density", "get_density");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "visibility_range", PROPERTY_HINT_RANGE, "0.,4096.0,.05,or_greater"), "set_visibility_range", "get_visibility_range");
-	//ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "visibility_margin", PROPERTY_HINT_RANGE, "0.,4096.0,.05,or_greater"), "set_visibility_margin", "get_visibility_margin");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "visibility_margin", PROPERTY_HINT_RANGE, "0.,4096.0,.05,or_greater"), "set_visibility_margin", "get_visibility_margin");
+	ADD_PROPERTY(PropertyInfo(Variant::PACKED_FLOAT32_ARRAY, "lod_distances", PROPERTY_HINT_NONE), "set_lod_distances", "get_lod_distances");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "cast_shadows", PROPERTY_HINT_ENUM, "Off,On,Double-Sided,Shadows Only"), "set_cast_shadows", "get_cast_shadows");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "scene_file", PROPERTY_HINT_RESOURCE_TYPE, "PackedScene"), "set_scene_file", "get_scene_file");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "material_override", PROPERTY_HINT_RESOURCE_TYPE, "BaseMaterial3D,ShaderMaterial"), "set_material_override", "get_material_override");
@@ -31,6 +31,7 @@ private:
 	real_t _height_offset = 0.f;
 	real_t _visibility_range = 100.f;
 	real_t _visibility_margin = 0.f;
+	PackedFloat32Array _lod_distances;
 	GeometryInstance3D::ShadowCastingSetting _cast_shadows = GeometryInstance3D::SHADOW_CASTING_SETTING_ON;
 	GenType _generated_type = TYPE_NONE;
 	int _generated_faces = 2;
@@ -40,7 +41,8 @@ private:
 	real_t _density = 10.f;
 
 	// Working data
-	TypedArray<Mesh> _meshes;
+	TypedArray<Mesh> _meshes; // Sorted by LOD, if the scene has LODs
+	int _lod_count = 1;
 	Ref<Texture2D> _thumbnail;
 
 	// No signal versions
@@ -48,6 +50,7 @@ private:
 	void _set_material_override(const Ref<Material> &p_material);
 	Ref<ArrayMesh> _get_generated_mesh() const;
 	Ref<Material> _get_material();
+	static int _get_lod_index(const String &p_name);
 
 public:
 	Terrain3DMeshAsset();
@@ -70,6 +73,10 @@ public:
 	real_t get_visibility_range() const { return _visibility_range; };
 	void set_visibility_margin(const real_t p_visibility_margin);
 	real_t get_visibility_margin() const { return _visibility_margin; };
+	void set_lod_distances(const PackedFloat32Array &p_distances);
+	PackedFloat32Array get_lod_distances() const { return _lod_distances; }
+	int get_lod_count() const { return _lod_count; }
+	Vector2 get_lod_range(const int p_lod) const;
 	void set_cast_shadows(const GeometryInstance3D::ShadowCastingSetting p_cast_shadows);
 	GeometryInstance3D::ShadowCastingSetting get_cast_shadows() const { return _cast_shadows; };
 
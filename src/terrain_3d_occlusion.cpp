@@ -0,0 +1,246 @@
+// Copyright © 2025 Cory Petkovsek, Roope Palmroos, and Contributors.
+
+#include "logger.h"
+#include "terrain_3d.h"
+#include "terrain_3d_data.h"
+#include "terrain_3d_occlusion.h"
+
+///////////////////////////
+// Private Functions
+///////////////////////////
+
+// Sizes the pyramid to cover the clipmap, and sets up the rings to trace the horizon through it
+void Terrain3DOcclusion::_update_settings() {
+	if (_directions.is_empty()) {
+		_directions.resize(SECTORS * 2);
+		for (int i = 0; i < SECTORS * 2; i++) {
+			real_t angle = Math_TAU * real_t(i) / real_t(SECTORS * 2);
+			_directions.write[i] = Vector2(Math::cos(angle), Math::sin(angle));
+		}
+	}
+
+	real_t cell_size = real_t(Terrain3DData::HEIGHT_MIP_CELL_SIZE) * _terrain->get_vertex_spacing();
+	real_t radius = real_t(_terrain->get_mesh_size() << _terrain->get_mesh_lods()) * _terrain->get_vertex_spacing();
+	const int half = GRID_SIZE / 2 - 1; // Cells from the camera that stay within a level's grid
+	int levels = 1;
+	while (levels < MAX_LEVELS && real_t(half) * cell_size * real_t(1 << (levels - 1)) < radius) {
+		levels++;
+	}
+	if (cell_size == _cell_size && levels == _levels && _terrain->get_mesh_size() == _mesh_size) {
+		return;
+	}
+	LOG(DEBUG, "Occlusion pyramid levels: ", levels, ", cell size: ", cell_size);
+	_cell_size = cell_size;
+	_levels = levels;
+	_mesh_size = _terrain->get_mesh_size();
+	_level_origins.resize(_levels);
+	_level_origins.fill(V2I_MAX);
+	_heights.resize(_levels * GRID_SIZE * GRID_SIZE);
+
+	// Rings step through each level at its cell size, out to the edge of its grid
+	_ring_distances.clear();
+	_ring_levels.clear();
+	real_t distance = 0.f;
+	for (int level = 0; level < _levels; level++) {
+		real_t level_cell_size = _cell_size * real_t(1 << level);
+		while (distance + level_cell_size <= real_t(half) * level_cell_size) {
+			distance += level_cell_size;
+			_ring_distances.push_back(distance);
+			_ring_levels.push_back(level);
+		}
+	}
+	_horizon.clear();
+}
+
+// Fills a pyramid level with the lowest terrain height under each cell
+void Terrain3DOcclusion::_update_level(const int p_level, const Vector2i &p_origin) {
+	_level_origins.write[p_level] = p_origin;
+	_update_cells(p_level, Rect2i(V2I_ZERO, Vector2i(GRID_SIZE, GRID_SIZE)));
+}
+
+// Returns how far past a cell of a pyramid level its lowest height is searched. The terrain is drawn
+// lower than the height maps where coarse clipmap LODs or the streaming summary skip over the lowest
+// pixels, as they only sample some of them. So each cell takes the lowest height of the pixels that
+// can shape the triangles over it: those within a quad of the coarsest LOD that can be drawn there,
+// or within a summary texel, beyond the resident regions. The margin grows away from the center.
+real_t Terrain3DOcclusion::_get_cell_margin(const int p_level, const Vector2i &p_cell) const {
+	const real_t spacing = _terrain->get_vertex_spacing();
+	// The camera is somewhere in the center cell. A clipmap LOD reaches 2 * mesh_size quads from it,
+	// so quads at a distance are under distance / mesh_size, doubled as vertices morph to the next LOD.
+	Vector2i offset = (p_cell - Vector2i(GRID_SIZE / 2, GRID_SIZE / 2)).abs();
+	real_t distance = real_t(MAX(offset.x, offset.y) + 1) * _cell_size * real_t(1 << p_level);
+	real_t margin = MAX(spacing, distance * 2.f / real_t(_mesh_size));
+	if (_terrain->get_data()->_is_streaming() &&
+			distance > real_t(_terrain->get_texture_streaming_radius() * int(_terrain->get_region_size())) * spacing) {
+		margin += real_t(Terrain3DData::REGION_MAP_SIZE) * spacing;
+	}
+	return margin;
+}
+
+// Recalculates the cells of a pyramid level in the given grid rect
+void Terrain3DOcclusion::_update_cells(const int p_level, const Rect2i &p_cells) {
+	const Terrain3DData *data = _terrain->get_data();
+	const Vector2i origin = _level_origins[p_level];
+	const real_t cell_size = _cell_size * real_t(1 << p_level);
+	real_t *heights = _heights.ptrw() + p_level * GRID_SIZE * GRID_SIZE;
+	for (int z = p_cells.position.y; z < p_cells.get_end().y; z++) {
+		for (int x = p_cells.position.x; x < p_cells.get_end().x; x++) {
+			Rect2 area = Rect2(Vector2(origin + Vector2i(x, z)) * cell_size, Vector2(cell_size, cell_size));
+			area = area.grow(_get_cell_margin(p_level, Vector2i(x, z)));
+			bool gaps = false;
+			Vector2 range = data->_get_area_height_range(area, &gaps);
+			heights[z * GRID_SIZE + x] = gaps ? -FLT_MAX : range.x;
+		}
+	}
+}
+
+real_t Terrain3DOcclusion::_get_cell_height(const int p_level, const Vector2 &p_position) const {
+	Vector2i cell = Vector2i((p_position / (_cell_size * real_t(1 << p_level))).floor()) - _level_origins[p_level];
+	if (cell.x < 0 || cell.y < 0 || cell.x >= GRID_SIZE || cell.y >= GRID_SIZE) {
+		return -FLT_MAX;
+	}
+	return _heights[(p_level * GRID_SIZE + cell.y) * GRID_SIZE + cell.x];
+}
+
+// Traces the horizon outwards in each sector. A ring is sampled on both edges and the center of the
+// sector, which are less than a cell apart, and the lowest is used, so the whole arc is at least as
+// high as the occluder.
+void Terrain3DOcclusion::_update_horizon() {
+	const int rings = _ring_distances.size();
+	_horizon.resize(SECTORS * rings);
+	real_t *horizon = _horizon.ptrw();
+	const real_t *distances = _ring_distances.ptr();
+	const int32_t *levels = _ring_levels.ptr();
+	const Vector2 *directions = _directions.ptr();
+	Vector2 cam_pos = Vector2(_camera_position.x, _camera_position.z);
+	for (int s = 0; s < SECTORS; s++) {
+		const Vector2 &edge0 = directions[s * 2];
+		const Vector2 &center = directions[s * 2 + 1];
+		const Vector2 &edge1 = directions[(s * 2 + 2) % (SECTORS * 2)];
+		real_t highest = -FLT_MAX;
+		for (int k = 0; k < rings; k++) {
+			real_t d = distances[k];
+			real_t h = MIN(_get_cell_height(levels[k], cam_pos + center * d),
+					MIN(_get_cell_height(levels[k], cam_pos + edge0 * d), _get_cell_height(levels[k], cam_pos + edge1 * d)));
+			if (h > -FLT_MAX) {
+				highest = MAX(highest, (h - _camera_position.y) / d);
+			}
+			horizon[s * rings + k] = highest;
+		}
+	}
+}
+
+///////////////////////////
+// Public Functions
+///////////////////////////
+
+bool Terrain3DOcclusion::needs_update(const Vector3 &p_cam_pos) const {
+	return _horizon.is_empty() || _camera_position.distance_to(p_cam_pos) > MOVE_THRESHOLD;
+}
+
+// Moves the pyramid levels whose grid cell changed, then traces the horizon from the camera
+void Terrain3DOcclusion::update(const Vector3 &p_cam_pos) {
+	if (_terrain == nullptr || _terrain->get_data() == nullptr) {
+		return;
+	}
+	_update_settings();
+	Vector2 cam_pos = Vector2(p_cam_pos.x, p_cam_pos.z);
+	for (int level = 0; level < _levels; level++) {
+		Vector2i origin = Vector2i((cam_pos / (_cell_size * real_t(1 << level))).floor()) - Vector2i(GRID_SIZE / 2, GRID_SIZE / 2);
+		if (origin != _level_origins[level]) {
+			_update_level(level, origin);
+		}
+	}
+	_camera_position = p_cam_pos;
+	_update_horizon();
+}
+
+// Returns true if the terrain hides all of the AABB from the camera. The test is conservative:
+// it uses the nearest distance and highest point of the AABB against the horizon of the terrain
+// strictly closer than that distance.
+bool Terrain3DOcclusion::is_occluded(const AABB &p_aabb) const {
+	const int rings = _ring_distances.size();
+	if (_horizon.is_empty() || rings == 0) {
+		return false;
+	}
+	Vector2 cam_pos = Vector2(_camera_position.x, _camera_position.z);
+	Rect2 rect = Rect2(p_aabb.position.x, p_aabb.position.z, p_aabb.size.x, p_aabb.size.z);
+	real_t d_min = cam_pos.distance_to(cam_pos.clamp(rect.position, rect.get_end()));
+	const real_t *distances = _ring_distances.ptr();
+	if (d_min <= distances[0]) {
+		return false;
+	}
+
+	// Highest elevation of the AABB, at its nearest point if above the camera, else its farthest
+	Vector2 corners[4] = { rect.position, Vector2(rect.get_end().x, rect.position.y),
+		Vector2(rect.position.x, rect.get_end().y), rect.get_end() };
+	real_t d_max = 0.f;
+	for (const Vector2 &corner : corners) {
+		d_max = MAX(d_max, cam_pos.distance_to(corner));
+	}
+	real_t top = p_aabb.position.y + p_aabb.size.y - _camera_position.y;
+	real_t tangent = top / (top > 0.f ? d_min : d_max);
+
+	// Last ring closer than the AABB
+	int ring = 0;
+	while (ring + 1 < rings && distances[ring + 1] < d_min) {
+		ring++;
+	}
+
+	// Sectors spanned by the AABB, from the corner angles around its center. The camera is outside
+	// of the AABB, so the span is under half a turn.
+	Vector2 center_dir = rect.get_center() - cam_pos;
+	real_t base = Math::atan2(center_dir.y, center_dir.x);
+	real_t lo = 0.f;
+	real_t hi = 0.f;
+	for (const Vector2 &corner : corners) {
+		Vector2 dir = corner - cam_pos;
+		real_t angle = Math::wrapf(Math::atan2(dir.y, dir.x) - base, -Math_PI, Math_PI);
+		lo = MIN(lo, angle);
+		hi = MAX(hi, angle);
+	}
+	int s_start = int(Math::floor((base + lo) / Math_TAU * real_t(SECTORS)));
+	int s_end = int(Math::floor((base + hi) / Math_TAU * real_t(SECTORS)));
+	const real_t *horizon = _horizon.ptr();
+	for (int s = s_start; s <= s_end; s++) {
+		int sector = ((s % SECTORS) + SECTORS) % SECTORS;
+		if (horizon[sector * rings + ring] <= tangent) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Recalculates the pyramid cells whose heights can include an area where the heights changed. Cells
+// sample past themselves by their margin, so the area is grown by the widest margin of each level,
+// that of its corner cells. The horizon is traced again on the next update().
+void Terrain3DOcclusion::update_area(const Rect2 &p_area) {
+	if (_terrain == nullptr || _terrain->get_data() == nullptr) {
+		return;
+	}
+	bool changed = false;
+	for (int level = 0; level < _levels; level++) {
+		if (_level_origins[level] == V2I_MAX) {
+			continue;
+		}
+		real_t cell_size = _cell_size * real_t(1 << level);
+		Rect2 area = p_area.grow(_get_cell_margin(level, V2I_ZERO));
+		Vector2i start = Vector2i((area.position / cell_size).floor()) - _level_origins[level];
+		Vector2i end = Vector2i((area.get_end() / cell_size).ceil()) - _level_origins[level];
+		Rect2i cells = Rect2i(start, end - start).intersection(Rect2i(V2I_ZERO, Vector2i(GRID_SIZE, GRID_SIZE)));
+		if (cells.has_area()) {
+			_update_cells(level, cells);
+			changed = true;
+		}
+	}
+	if (changed) {
+		_horizon.clear();
+	}
+}
+
+// Forces the pyramid and horizon to be rebuilt, eg after the heights changed
+void Terrain3DOcclusion::clear() {
+	_level_origins.fill(V2I_MAX);
+	_horizon.clear();
+	_camera_position = V3_MAX;
+}
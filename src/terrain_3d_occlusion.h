@@ -0,0 +1,66 @@
+// Copyright © 2025 Cory Petkovsek, Roope Palmroos, and Contributors.
+
+#ifndef TERRAIN3D_OCCLUSION_CLASS_H
+#define TERRAIN3D_OCCLUSION_CLASS_H
+
+#include <godot_cpp/templates/vector.hpp>
+
+#include "constants.h"
+
+class Terrain3D;
+
+using namespace godot;
+
+// CPU horizon occlusion test for objects behind the terrain, such as clipmap meshes and instancer
+// cells in valleys. A coarse height pyramid is kept around the camera: nested grids of the lowest
+// terrain height per cell, each with cells twice the size of the previous. From it, the horizon is
+// traced in a fan of sectors around the camera, storing the highest elevation of the terrain closer
+// than each of a series of ring distances. An AABB is occluded if, in every sector it spans, its
+// highest point is below the horizon in front of it.
+class Terrain3DOcclusion {
+	CLASS_NAME_STATIC("Terrain3DOcclusion");
+
+public: // Constants
+	static inline const int GRID_SIZE = 32; // Cells per side of each pyramid level
+	static inline const int MAX_LEVELS = 12;
+	static inline const int SECTORS = 256; // Azimuth sectors of the horizon
+	static inline const real_t MOVE_THRESHOLD = 0.2f; // Camera movement that triggers an update
+
+private:
+	Terrain3D *_terrain = nullptr;
+
+	// Height pyramid, level by level, GRID_SIZE^2 cells each. Cells hold the lowest terrain height,
+	// or -FLT_MAX if they aren't fully covered by regions or have holes, as they can't occlude.
+	real_t _cell_size = 0.f; // Of level 0, in meters
+	int _levels = 0;
+	int _mesh_size = 0; // Of the clipmap, which sets the margin of each cell, see _get_cell_margin()
+	Vector<Vector2i> _level_origins; // Top left cell of each level
+	PackedRealArray _heights;
+
+	// Horizon, by sector then ring. The tangent of the highest terrain elevation seen from the camera
+	// at or closer than each ring distance.
+	Vector3 _camera_position = V3_MAX;
+	PackedRealArray _ring_distances;
+	PackedInt32Array _ring_levels; // Pyramid level sampled by each ring
+	PackedRealArray _horizon;
+	Vector<Vector2> _directions; // Unit vectors of the sector edges and centers, SECTORS * 2
+
+	void _update_settings();
+	void _update_level(const int p_level, const Vector2i &p_origin);
+	real_t _get_cell_margin(const int p_level, const Vector2i &p_cell) const;
+	void _update_cells(const int p_level, const Rect2i &p_cells);
+	real_t _get_cell_height(const int p_level, const Vector2 &p_position) const;
+	void _update_horizon();
+
+public:
+	Terrain3DOcclusion() {}
+	void initialize(Terrain3D *p_terrain) { _terrain = p_terrain; }
+
+	bool needs_update(const Vector3 &p_cam_pos) const;
+	void update(const Vector3 &p_cam_pos);
+	void update_area(const Rect2 &p_area);
+	bool is_occluded(const AABB &p_aabb) const;
+	void clear();
+};
+
+#endif // TERRAIN3D_OCCLUSION_CLASS_H
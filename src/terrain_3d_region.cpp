@@ -80,6 +80,8 @@ void Terrain3DRegion::set_height_map(const Ref<Image> &p_map) {
 		set_region_size((p_map.is_valid()) ? p_map->get_width() : 0);
 	}
 	_height_map = sanitize_map(TYPE_HEIGHT, p_map);
+	_height_mips.clear();
+	_hole_mips.clear();
 	calc_height_range();
 }
 
@@ -89,6 +91,8 @@ void Terrain3DRegion::set_control_map(const Ref<Image> &p_map) {
 		set_region_size((p_map.is_valid()) ? p_map->get_width() : 0);
 	}
 	_control_map = sanitize_map(TYPE_CONTROL, p_map);
+	_height_mips.clear(); // Holes are excluded from the height pyramid
+	_hole_mips.clear();
 }
 
 void Terrain3DRegion::set_color_map(const Ref<Image> &p_map) {
@@ -111,6 +115,8 @@ void Terrain3DRegion::sanitize_maps() {
 	_height_map = sanitize_map(TYPE_HEIGHT, _height_map);
 	_control_map = sanitize_map(TYPE_CONTROL, _control_map);
 	_color_map = sanitize_map(TYPE_COLOR, _color_map);
+	_height_mips.clear();
+	_hole_mips.clear();
 }
 
 Ref<Image> Terrain3DRegion::sanitize_map(const MapType p_map_type, const Ref<Image> &p_map) const {
@@ -193,6 +199,162 @@ void Terrain3DRegion::calc_height_range() {
 	}
 }
 
+/**
+ * Loads instances from the Dictionary format stored on disk:
+ * Meshes{int} -> Cells{v2i} -> [ PackedFloat32Array, PackedColorArray, modified:bool ]
+ * Regions saved before version 0.94 store an Array of Transform3Ds instead of the packed transforms.
+ * They are converted here and the region is marked modified, so it's saved in the new format.
+ */
+void Terrain3DRegion::set_instances(const Dictionary &p_instances) {
+	_instances.clear();
+	bool converted = false;
+	Array mesh_ids = p_instances.keys();
+	for (int m = 0; m < mesh_ids.size(); m++) {
+		int mesh_id = mesh_ids[m];
+		Dictionary cell_inst_dict = p_instances[mesh_id];
+		InstanceCells &cells = _instances[mesh_id];
+		Array cell_locations = cell_inst_dict.keys();
+		for (int c = 0; c < cell_locations.size(); c++) {
+			Vector2i cell_loc = cell_locations[c];
+			Array triple = cell_inst_dict[cell_loc];
+			if (triple.size() < 3) {
+				LOG(WARN, "Malformed instance data in region ", _location, " mesh ", mesh_id, " cell ", cell_loc);
+				continue;
+			}
+			InstanceCell cell;
+			cell.colors = triple[1];
+			cell.modified = triple[2];
+			if (triple[0].get_type() == Variant::ARRAY) {
+				Array xforms = triple[0];
+				cell.xforms.resize(xforms.size() * XFORM_FLOATS);
+				float *dst = cell.xforms.ptrw();
+				for (int i = 0; i < xforms.size(); i++) {
+					pack_xform(xforms[i], dst + i * XFORM_FLOATS);
+				}
+				converted = true;
+			} else {
+				cell.xforms = triple[0];
+			}
+			if (cell.xforms.size() != cell.colors.size() * XFORM_FLOATS) {
+				LOG(WARN, "Region ", _location, " mesh ", mesh_id, " cell ", cell_loc, " has ",
+						cell.xforms.size() / XFORM_FLOATS, " transforms but ", cell.colors.size(), " colors");
+				cell.colors.resize(cell.xforms.size() / XFORM_FLOATS);
+				cell.xforms.resize(cell.colors.size() * XFORM_FLOATS);
+			}
+			if (cell.get_count() > 0) {
+				cells[cell_loc] = cell;
+			}
+		}
+		if (cells.empty()) {
+			_instances.erase(mesh_id);
+		}
+	}
+	if (converted) {
+		LOG(INFO, "Converted instances of region ", _location, " to packed transforms");
+		_modified = true;
+	}
+}
+
+// Builds the Dictionary format. Packed arrays are shared with the region until either is written.
+Dictionary Terrain3DRegion::get_instances() const {
+	Dictionary mesh_inst_dict;
+	for (const auto &mesh_it : _instances) {
+		Dictionary cell_inst_dict;
+		for (const auto &cell_it : mesh_it.second) {
+			Array triple;
+			triple.push_back(cell_it.second.xforms);
+			triple.push_back(cell_it.second.colors);
+			triple.push_back(cell_it.second.modified);
+			cell_inst_dict[cell_it.first] = triple;
+		}
+		mesh_inst_dict[mesh_it.first] = cell_inst_dict;
+	}
+	return mesh_inst_dict;
+}
+
+PackedInt32Array Terrain3DRegion::get_instance_mesh_ids() const {
+	PackedInt32Array mesh_ids;
+	for (const auto &mesh_it : _instances) {
+		mesh_ids.push_back(mesh_it.first);
+	}
+	return mesh_ids;
+}
+
+TypedArray<Vector2i> Terrain3DRegion::get_instance_cells(const int p_mesh_id) const {
+	TypedArray<Vector2i> cell_locations;
+	auto mesh_it = _instances.find(p_mesh_id);
+	if (mesh_it != _instances.end()) {
+		for (const auto &cell_it : mesh_it->second) {
+			cell_locations.push_back(cell_it.first);
+		}
+	}
+	return cell_locations;
+}
+
+/**
+ * Returns the transforms of a cell, 12 floats per instance in region space, in the layout of
+ * MultiMesh.buffer. The array shares the region's memory until either is modified.
+ */
+PackedFloat32Array Terrain3DRegion::get_instance_transforms(const int p_mesh_id, const Vector2i &p_cell) const {
+	auto mesh_it = _instances.find(p_mesh_id);
+	if (mesh_it != _instances.end()) {
+		auto cell_it = mesh_it->second.find(p_cell);
+		if (cell_it != mesh_it->second.end()) {
+			return cell_it->second.xforms;
+		}
+	}
+	return PackedFloat32Array();
+}
+
+PackedColorArray Terrain3DRegion::get_instance_colors(const int p_mesh_id, const Vector2i &p_cell) const {
+	auto mesh_it = _instances.find(p_mesh_id);
+	if (mesh_it != _instances.end()) {
+		auto cell_it = mesh_it->second.find(p_cell);
+		if (cell_it != mesh_it->second.end()) {
+			return cell_it->second.colors;
+		}
+	}
+	return PackedColorArray();
+}
+
+// Replaces the instances of a cell, or erases it if empty. Call Terrain3DInstancer::force_update_mmis() after
+void Terrain3DRegion::set_instance_cell(const int p_mesh_id, const Vector2i &p_cell, const PackedFloat32Array &p_xforms,
+		const PackedColorArray &p_colors) {
+	if (p_xforms.size() != p_colors.size() * XFORM_FLOATS) {
+		LOG(ERROR, "Expected ", XFORM_FLOATS, " floats per color, got ", p_xforms.size(), " floats, ", p_colors.size(), " colors");
+		return;
+	}
+	_modified = true;
+	if (p_colors.is_empty()) {
+		auto mesh_it = _instances.find(p_mesh_id);
+		if (mesh_it != _instances.end()) {
+			mesh_it->second.erase(p_cell);
+			if (mesh_it->second.empty()) {
+				_instances.erase(mesh_it);
+			}
+		}
+		return;
+	}
+	InstanceCell &cell = _instances[p_mesh_id][p_cell];
+	cell.xforms = p_xforms;
+	cell.colors = p_colors;
+	cell.set_modified();
+}
+
+// Returns the number of instances of a mesh, or of all meshes if -1
+int Terrain3DRegion::get_instance_count(const int p_mesh_id) const {
+	int count = 0;
+	for (const auto &mesh_it : _instances) {
+		if (p_mesh_id >= 0 && mesh_it.first != p_mesh_id) {
+			continue;
+		}
+		for (const auto &cell_it : mesh_it.second) {
+			count += cell_it.second.get_count();
+		}
+	}
+	return count;
+}
+
 Error Terrain3DRegion::save(const String &p_path, const bool p_16_bit) {
 	// Initiate save to external file. The scene will save itself.
 	if (_location.x == INT32_MAX) {
@@ -234,6 +396,27 @@ Error Terrain3DRegion::save(const String &p_path, const bool p_16_bit) {
 	return err;
 }
 
+void Terrain3DRegion::set_edited(const bool p_edited) {
+	_edited = p_edited;
+	if (!p_edited) {
+		clear_dirty_rects();
+	}
+}
+
+Rect2i Terrain3DRegion::get_dirty_rect(const MapType p_map_type) const {
+	if (p_map_type < 0 || p_map_type >= TYPE_MAX) {
+		return Rect2i();
+	}
+	return _dirty_rects[p_map_type];
+}
+
+void Terrain3DRegion::clear_dirty_rects() {
+	for (int i = 0; i < TYPE_MAX; i++) {
+		_dirty_rects[i] = Rect2i();
+	}
+	_dirty_rects_tracked = false;
+}
+
 void Terrain3DRegion::set_location(const Vector2i &p_location) {
 	// In the future anywhere they want to put the location might be fine, but because of region_map
 	// We have a limitation of 16x16 and eventually 45x45.
@@ -262,7 +445,9 @@ void Terrain3DRegion::set_data(const Dictionary &p_data) {
 	SET_IF_HAS(_height_map, "height_map");
 	SET_IF_HAS(_control_map, "control_map");
 	SET_IF_HAS(_color_map, "color_map");
-	SET_IF_HAS(_instances, "instances");
+	if (p_data.has("instances")) {
+		set_instances(p_data["instances"]);
+	}
 }
 
 Dictionary Terrain3DRegion::get_data() const {
@@ -278,7 +463,7 @@ Dictionary Terrain3DRegion::get_data() const {
 	dict["height_map"] = _height_map;
 	dict["control_map"] = _control_map;
 	dict["color_map"] = _color_map;
-	dict["instances"] = _instances;
+	dict["instances"] = get_instances();
 	return dict;
 }
 
@@ -301,7 +486,7 @@ Ref<Terrain3DRegion> Terrain3DRegion::duplicate(const bool p_deep) {
 		dict["height_map"] = _height_map->duplicate();
 		dict["control_map"] = _control_map->duplicate();
 		dict["color_map"] = _color_map->duplicate();
-		dict["instances"] = _instances.duplicate(true);
+		dict["instances"] = get_instances(); // Packed arrays copy on write
 		region->set_data(dict);
 	}
 	return region;
@@ -346,6 +531,12 @@ void Terrain3DRegion::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("set_instances", "instances"), &Terrain3DRegion::set_instances);
 	ClassDB::bind_method(D_METHOD("get_instances"), &Terrain3DRegion::get_instances);
+	ClassDB::bind_method(D_METHOD("get_instance_mesh_ids"), &Terrain3DRegion::get_instance_mesh_ids);
+	ClassDB::bind_method(D_METHOD("get_instance_cells", "mesh_id"), &Terrain3DRegion::get_instance_cells);
+	ClassDB::bind_method(D_METHOD("get_instance_transforms", "mesh_id", "cell"), &Terrain3DRegion::get_instance_transforms);
+	ClassDB::bind_method(D_METHOD("get_instance_colors", "mesh_id", "cell"), &Terrain3DRegion::get_instance_colors);
+	ClassDB::bind_method(D_METHOD("set_instance_cell", "mesh_id", "cell", "transforms", "colors"), &Terrain3DRegion::set_instance_cell);
+	ClassDB::bind_method(D_METHOD("get_instance_count", "mesh_id"), &Terrain3DRegion::get_instance_count, DEFVAL(-1));
 
 	ClassDB::bind_method(D_METHOD("save", "path", "16-bit"), &Terrain3DRegion::save, DEFVAL(""), DEFVAL(false));
 
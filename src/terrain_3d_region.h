@@ -3,14 +3,20 @@
 #ifndef TERRAIN3D_REGION_CLASS_H
 #define TERRAIN3D_REGION_CLASS_H
 
+#include <map>
+#include <unordered_map>
+
 #include "constants.h"
 #include "terrain_3d_util.h"
 
 using namespace godot;
 
+class Terrain3DData;
+
 class Terrain3DRegion : public Resource {
 	GDCLASS(Terrain3DRegion, Resource);
 	CLASS_NAME();
+	friend class Terrain3DData;
 
 public: // Constants
 	enum MapType {
@@ -41,6 +47,30 @@ public: // Constants
 		COLOR_NAN, // TYPE_MAX, unused just in case someone indexes the array
 	};
 
+	static inline const int XFORM_FLOATS = 12; // Per instance transform, in the MultiMesh buffer layout
+
+	// Instances of one mesh in one cell, packed as MultiMesh buffers rather than Variants
+	struct InstanceCell {
+		PackedFloat32Array xforms; // XFORM_FLOATS per instance, basis rows with the origin appended
+		PackedColorArray colors; // One per instance
+		bool modified = true; // Since its MMI was last built
+		int modified_from = 0; // First instance changed since, those before are unchanged
+		int get_count() const { return colors.size(); }
+		// Marks instances from p_from onward as changed, so only they need to be written to the MMI
+		void set_modified(const int p_from = 0) {
+			modified_from = modified ? MIN(modified_from, p_from) : p_from;
+			modified = true;
+		}
+		// Overwrites instance p_to with p_from, to compact the arrays when removing instances
+		void copy_instance(const int p_from, const int p_to) {
+			float *dst = xforms.ptrw();
+			memcpy(dst + p_to * XFORM_FLOATS, dst + p_from * XFORM_FLOATS, sizeof(float) * XFORM_FLOATS);
+			colors.set(p_to, colors[p_from]);
+		}
+	};
+	typedef std::unordered_map<Vector2i, InstanceCell, Vector2iHash> InstanceCells;
+	typedef std::map<int, InstanceCells> InstanceMeshes;
+
 private:
 	// Saved data
 	real_t _version = 0.8f; // Set to first version to ensure we always upgrades this
@@ -51,7 +81,7 @@ private:
 	Ref<Image> _control_map;
 	Ref<Image> _color_map;
 	// Instancer
-	Dictionary _instances; // Meshes{int} -> Cells{v2i} -> [ Transform3D, Color, Modified ]
+	InstanceMeshes _instances; // Meshes{int} -> Cells{v2i} -> InstanceCell
 	real_t _vertex_spacing = 1.f; // Vertex Spacing value that transforms are currently scaled.
 
 	// Working data not saved to disk
@@ -59,6 +89,15 @@ private:
 	bool _edited = false; // Marked for undo/redo storage
 	bool _modified = false; // Marked for saving
 	Vector2i _location = V2I_MAX;
+	// Min/max height pyramid for raycasts, [level][cell] -> Vector2(min, max). Maintained by Terrain3DData
+	// unless Terrain3D.height_pyramids is off. With _hole_mips, 0.75 bytes per pixel
+	Vector<PackedVector2Array> _height_mips;
+	// Cells of _height_mips with any quad not drawn, as it has a hole or missing corner, [level][cell] -> 0/1
+	Vector<PackedByteArray> _hole_mips;
+	// Pixels changed since the texture arrays were last updated, per map type, so only those are
+	// uploaded. Edited regions without any tracked are uploaded whole. Cleared by Terrain3DData
+	Rect2i _dirty_rects[TYPE_MAX];
+	bool _dirty_rects_tracked = false;
 
 public:
 	Terrain3DRegion() {}
@@ -72,6 +111,7 @@ public:
 	// Maps
 	void set_map(const MapType p_map_type, const Ref<Image> &p_image);
 	Ref<Image> get_map(const MapType p_map_type) const;
+	Image *get_map_ptr(const MapType p_map_type) const;
 	void set_maps(const TypedArray<Image> &p_maps);
 	TypedArray<Image> get_maps() const;
 	void set_height_map(const Ref<Image> &p_map);
@@ -91,8 +131,19 @@ public:
 	void calc_height_range();
 
 	// Instancer
-	void set_instances(const Dictionary &p_instances) { _instances = p_instances; }
-	Dictionary get_instances() const { return _instances; }
+	void set_instances(const Dictionary &p_instances);
+	Dictionary get_instances() const;
+	InstanceMeshes &get_instance_meshes() { return _instances; }
+	const InstanceMeshes &get_instance_meshes() const { return _instances; }
+	PackedInt32Array get_instance_mesh_ids() const;
+	TypedArray<Vector2i> get_instance_cells(const int p_mesh_id) const;
+	PackedFloat32Array get_instance_transforms(const int p_mesh_id, const Vector2i &p_cell) const;
+	PackedColorArray get_instance_colors(const int p_mesh_id, const Vector2i &p_cell) const;
+	void set_instance_cell(const int p_mesh_id, const Vector2i &p_cell, const PackedFloat32Array &p_xforms,
+			const PackedColorArray &p_colors);
+	int get_instance_count(const int p_mesh_id = -1) const;
+	static void pack_xform(const Transform3D &p_xform, float *r_dst);
+	static Transform3D unpack_xform(const float *p_src);
 	void set_vertex_spacing(const real_t p_vertex_spacing) { _vertex_spacing = CLAMP(p_vertex_spacing, 0.25f, 100.f); }
 	real_t get_vertex_spacing() const { return _vertex_spacing; }
 
@@ -102,8 +153,11 @@ public:
 	// Working Data
 	void set_deleted(const bool p_deleted) { _deleted = p_deleted; }
 	bool is_deleted() const { return _deleted; }
-	void set_edited(const bool p_edited) { _edited = p_edited; }
+	void set_edited(const bool p_edited);
 	bool is_edited() const { return _edited; }
+	void add_dirty_rect(const MapType p_map_type, const Rect2i &p_rect);
+	Rect2i get_dirty_rect(const MapType p_map_type) const;
+	void clear_dirty_rects();
 	void set_modified(const bool p_modified) { _modified = p_modified; }
 	bool is_modified() const { return _modified; }
 	void set_location(const Vector2i &p_location);
@@ -130,6 +184,20 @@ constexpr inline const Color *COLOR = Terrain3DRegion::COLOR;
 
 // Inline functions
 
+// Raw pointer for internal hot paths that shouldn't pay for Ref counting. May be nullptr.
+inline Image *Terrain3DRegion::get_map_ptr(const MapType p_map_type) const {
+	switch (p_map_type) {
+		case TYPE_HEIGHT:
+			return _height_map.ptr();
+		case TYPE_CONTROL:
+			return _control_map.ptr();
+		case TYPE_COLOR:
+			return _color_map.ptr();
+		default:
+			return nullptr;
+	}
+}
+
 inline void Terrain3DRegion::update_height(const real_t p_height) {
 	if (p_height < _height_range.x) {
 		_height_range.x = p_height;
@@ -151,4 +219,29 @@ inline void Terrain3DRegion::update_heights(const Vector2 &p_low_high) {
 	}
 }
 
+// Writes a transform in the MultiMesh buffer layout
+inline void Terrain3DRegion::pack_xform(const Transform3D &p_xform, float *r_dst) {
+	for (int i = 0; i < 3; i++) {
+		r_dst[i * 4 + 0] = p_xform.basis.rows[i].x;
+		r_dst[i * 4 + 1] = p_xform.basis.rows[i].y;
+		r_dst[i * 4 + 2] = p_xform.basis.rows[i].z;
+		r_dst[i * 4 + 3] = p_xform.origin[i];
+	}
+}
+
+inline Transform3D Terrain3DRegion::unpack_xform(const float *p_src) {
+	return Transform3D(p_src[0], p_src[1], p_src[2], p_src[4], p_src[5], p_src[6], p_src[8], p_src[9], p_src[10],
+			p_src[3], p_src[7], p_src[11]);
+}
+
+// Called per pixel by the editor
+inline void Terrain3DRegion::add_dirty_rect(const MapType p_map_type, const Rect2i &p_rect) {
+	if (p_map_type < 0 || p_map_type >= TYPE_MAX) {
+		return;
+	}
+	Rect2i &rect = _dirty_rects[p_map_type];
+	rect = rect.has_area() ? rect.merge(p_rect) : p_rect;
+	_dirty_rects_tracked = true;
+}
+
 #endif // TERRAIN3D_REGION_CLASS_H
@@ -272,6 +272,82 @@ Ref<Image> Terrain3DUtil::get_filled_image(const Vector2i &p_size, const Color &
 	return img;
 }
 
+/**
+ * Regenerates only the mipmap texels covering a changed rectangle of the base level, up the chain.
+ * The cost scales with the rectangle, not the image, eg for a brush stroke on a color map.
+ * Texels are a 2x2 box filter of the level below, rounded as Image::generate_mipmaps() does for
+ * 8-bit formats, so the result is identical to regenerating all of them. Other formats, or images
+ * without mipmaps, fall back to generate_mipmaps().
+ * Parameters:
+ *	p_image - image with mipmaps, modified in place
+ *	p_rect - changed pixels of the base level
+ */
+void Terrain3DUtil::update_mipmaps(const Ref<Image> &p_image, const Rect2i &p_rect) {
+	if (p_image.is_null() || p_image->is_empty()) {
+		return;
+	}
+	int channels = 0;
+	switch (p_image->get_format()) {
+		case Image::FORMAT_L8:
+		case Image::FORMAT_R8:
+			channels = 1;
+			break;
+		case Image::FORMAT_LA8:
+		case Image::FORMAT_RG8:
+			channels = 2;
+			break;
+		case Image::FORMAT_RGB8:
+			channels = 3;
+			break;
+		case Image::FORMAT_RGBA8:
+			channels = 4;
+			break;
+		default:
+			break;
+	}
+	if (channels == 0 || !p_image->has_mipmaps()) {
+		p_image->generate_mipmaps();
+		return;
+	}
+	int width = p_image->get_width();
+	int height = p_image->get_height();
+	Rect2i rect = p_rect.intersection(Rect2i(V2I_ZERO, Vector2i(width, height)));
+	if (!rect.has_area()) {
+		return;
+	}
+
+	uint8_t *data = p_image->ptrw();
+	int64_t src_offset = 0;
+	for (int level = 1; level <= p_image->get_mipmap_count(); level++) {
+		int dst_width = MAX(width >> 1, 1);
+		int dst_height = MAX(height >> 1, 1);
+		int64_t dst_offset = p_image->get_mipmap_offset(level);
+		// Each texel averages a 2x2 block, repeating the last row or column of 1 pixel wide levels
+		int right_step = (width == 1) ? 0 : channels;
+		int down_step = (height == 1) ? 0 : width * channels;
+		Vector2i start = rect.position / 2;
+		Vector2i end = (rect.get_end() + Vector2i(1, 1)) / 2;
+		end = Vector2i(MIN(end.x, dst_width), MIN(end.y, dst_height));
+		for (int y = start.y; y < end.y; y++) {
+			const uint8_t *src_up = data + src_offset + int64_t(y) * 2 * down_step;
+			const uint8_t *src_down = src_up + down_step;
+			uint8_t *dst = data + dst_offset + int64_t(y) * dst_width * channels;
+			for (int x = start.x; x < end.x; x++) {
+				int src_x = x * 2 * right_step;
+				for (int c = 0; c < channels; c++) {
+					uint32_t sum = uint32_t(src_up[src_x + c]) + uint32_t(src_up[src_x + right_step + c]) +
+							uint32_t(src_down[src_x + c]) + uint32_t(src_down[src_x + right_step + c]);
+					dst[x * channels + c] = uint8_t((sum + 2) >> 2);
+				}
+			}
+		}
+		rect = Rect2i(start, end - start);
+		width = dst_width;
+		height = dst_height;
+		src_offset = dst_offset;
+	}
+}
+
 /**
  * Loads a file from disk and returns an Image
  * Parameters:
@@ -456,6 +532,7 @@ void Terrain3DUtil::_bind_methods() {
 	ClassDB::bind_static_method("Terrain3DUtil", D_METHOD("get_min_max", "image"), &Terrain3DUtil::get_min_max);
 	ClassDB::bind_static_method("Terrain3DUtil", D_METHOD("get_thumbnail", "image", "size"), &Terrain3DUtil::get_thumbnail, DEFVAL(Vector2i(256, 256)));
 	ClassDB::bind_static_method("Terrain3DUtil", D_METHOD("get_filled_image", "size", "color", "create_mipmaps", "format"), &Terrain3DUtil::get_filled_image);
+	ClassDB::bind_static_method("Terrain3DUtil", D_METHOD("update_mipmaps", "image", "rect"), &Terrain3DUtil::update_mipmaps);
 	ClassDB::bind_static_method("Terrain3DUtil", D_METHOD("load_image", "file_name", "cache_mode", "r16_height_range", "r16_size"), &Terrain3DUtil::load_image, DEFVAL(ResourceLoader::CACHE_MODE_IGNORE), DEFVAL(Vector2(0, 255)), DEFVAL(V2I_ZERO));
 	ClassDB::bind_static_method("Terrain3DUtil", D_METHOD("pack_image", "src_rgb", "src_a", "invert_green", "invert_alpha", "alpha_channel"), &Terrain3DUtil::pack_image, DEFVAL(false), DEFVAL(false), DEFVAL(0));
 	ClassDB::bind_static_method("Terrain3DUtil", D_METHOD("luminance_to_height", "src_rgb"), &Terrain3DUtil::luminance_to_height, DEFVAL(false));
@@ -41,6 +41,7 @@ public:
 			const Color &p_color = COLOR_BLACK,
 			const bool p_create_mipmaps = true,
 			const Image::Format p_format = Image::FORMAT_MAX);
+	static void update_mipmaps(const Ref<Image> &p_image, const Rect2i &p_rect);
 	static Ref<Image> load_image(const String &p_file_name, const int p_cache_mode = ResourceLoader::CACHE_MODE_IGNORE,
 			const Vector2 &p_r16_height_range = Vector2(0.f, 255.f), const Vector2i &p_r16_size = V2I_ZERO);
 	static Ref<Image> pack_image(const Ref<Image> &p_src_rgb,
@@ -129,6 +130,29 @@ inline Rect2 aabb2rect(const AABB &p_aabb) {
 	return rect;
 }
 
+// Clips the ray distances [r_t0, r_t1] to the span where the ray is over the rect on XZ.
+// Returns false if the ray misses the rect within that span.
+inline bool clip_ray_to_rect(const Vector3 &p_origin, const Vector3 &p_dir, const Rect2 &p_rect, real_t &r_t0, real_t &r_t1) {
+	const real_t origin[2] = { p_origin.x, p_origin.z };
+	const real_t dir[2] = { p_dir.x, p_dir.z };
+	const Vector2 end = p_rect.get_end();
+	const real_t min[2] = { p_rect.position.x, p_rect.position.y };
+	const real_t max[2] = { end.x, end.y };
+	for (int i = 0; i < 2; i++) {
+		if (dir[i] == 0.f) {
+			if (origin[i] < min[i] || origin[i] > max[i]) {
+				return false;
+			}
+			continue;
+		}
+		real_t t_a = (min[i] - origin[i]) / dir[i];
+		real_t t_b = (max[i] - origin[i]) / dir[i];
+		r_t0 = MAX(r_t0, MIN(t_a, t_b));
+		r_t1 = MIN(r_t1, MAX(t_a, t_b));
+	}
+	return r_t0 <= r_t1;
+}
+
 ///////////////////////////
 // Controlmap Handling
 ///////////////////////////